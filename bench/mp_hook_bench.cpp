@@ -0,0 +1,379 @@
+// mp_hook_bench: costo por operacion de los hooks de new/delete.
+//
+// Cada hilo mantiene un anillo de bloques vivos y en cada operacion libera
+// el mas viejo y asigna uno nuevo (un delete + un new). Se mide con:
+//   - malloc:    malloc/free directo, sin pasar por el hook (referencia)
+//   - stopped/<modo>: mp::stop() en ese modo. En off es una rama por hook;
+//                counters sigue contando; full conserva --retained bloques
+//                registrados, asi que cada delete consulta al tracker
+//   - off/counters/sampled/full: modos de seguimiento en marcha (politica
+//                Dynamic); con una politica estatica, solo la fijada en CMake
+//   - full/stack<N>: full capturando pilas de hasta N frames (--stack-depths).
+//                La carga corre bajo kStackPadding frames para que la
+//                captura llegue siempre a N.
+//   - full/ts-<fuente>: full con cada reloj de registro (--timestamps):
+//                steady, tsc, coarse o none. "full" usa el de CMake.
+//   - full/obs<N>: full con N observadores vacios (--observers), para ver
+//                lo que cuesta recorrer la lista y medir cada llamada.
+// El resultado es ns por operacion (mediana y peor de las repeticiones).
+//
+// Despues se mide la memoria por bloque vivo de cada modo que registra
+// (--mem-blocks bloques asignados en el hilo principal, delta de
+// mallinfo2): incluye la cabecera de malloc, la tabla del tracker o el
+// encabezado de la politica Header.
+
+#include "CallbacksRegistration.hpp"
+#include "Observers.hpp"
+#include "ProfilerAPI.hpp"
+#include "Stacks.hpp"
+#include "Timestamp.hpp"
+#include "TrackingMode.hpp"
+#include "TrackingPolicies.hpp"
+
+#include "ToolStats.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <malloc.h>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mp::tools;
+
+namespace {
+
+struct Options {
+    std::vector<std::uint32_t> threads{1, 4};
+    std::uint64_t ops = 200000;         // operaciones por hilo y repeticion
+    std::uint32_t reps = 3;
+    std::size_t   ring = 1024;          // bloques vivos por hilo
+    std::size_t   retained = 10000;     // registrados antes del stop (stopped/full)
+    std::vector<std::uint32_t> stackDepths{8, 16, 32};
+    std::vector<std::string>   timestamps{"steady", "tsc", "coarse", "none"};
+    std::vector<std::uint32_t> observers{1, 4};
+    std::size_t   memBlocks = 100000;   // bloques vivos para medir memoria (0 = no medir)
+    bool json = false;
+};
+
+void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]\n";
+    std::cout << "\nOptions:\n";
+    std::cout << "  --threads <A,B,..>  Allocating thread counts (default: 1,4)\n";
+    std::cout << "  --ops <N>           new+delete pairs per thread and repetition (default: 200000)\n";
+    std::cout << "  --reps <N>          Repetitions per configuration (default: 3)\n";
+    std::cout << "  --ring <N>          Live blocks kept per thread (default: 1024)\n";
+    std::cout << "  --retained <N>      Tracked blocks left alive while stopped in full mode (default: 10000)\n";
+    std::cout << "  --stack-depths <A,..> Stack capture depths measured in full mode (default: 8,16,32)\n";
+    std::cout << "  --timestamps <A,..> Record clocks measured in full mode (default: steady,tsc,coarse,none)\n";
+    std::cout << "  --observers <A,..>  Empty allocation observers measured in full mode (default: 1,4)\n";
+    std::cout << "  --mem-blocks <N>    Live blocks used to measure memory per block, 0 to skip (default: 100000)\n";
+    std::cout << "  --json              Print results as JSON lines\n";
+    std::cout << "  --help              Show this help message\n";
+}
+
+std::vector<std::string> parseNames(const std::string& s) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(item);
+    }
+    return out;
+}
+
+std::vector<std::uint32_t> parseList(const std::string& s) {
+    std::vector<std::uint32_t> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(static_cast<std::uint32_t>(std::atoi(item.c_str())));
+    }
+    return out;
+}
+
+bool parseArgs(int argc, char* argv[], Options& o) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto val = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (a == "--help") return false;
+        else if (a == "--json")     o.json = true;
+        else if (a == "--threads")  o.threads = parseList(val());
+        else if (a == "--ops")      o.ops = std::strtoull(val().c_str(), nullptr, 10);
+        else if (a == "--reps")     o.reps = static_cast<std::uint32_t>(std::atoi(val().c_str()));
+        else if (a == "--ring")     o.ring = static_cast<std::size_t>(std::atoi(val().c_str()));
+        else if (a == "--retained") o.retained = static_cast<std::size_t>(std::atoi(val().c_str()));
+        else if (a == "--stack-depths") o.stackDepths = parseList(val());
+        else if (a == "--timestamps") o.timestamps = parseNames(val());
+        else if (a == "--observers") o.observers = parseList(val());
+        else if (a == "--mem-blocks") o.memBlocks = std::strtoull(val().c_str(), nullptr, 10);
+        else {
+            std::cerr << "Error: unknown option " << a << "\n";
+            return false;
+        }
+    }
+    if (o.threads.empty() || o.ops == 0 || o.reps == 0 || o.ring == 0) {
+        std::cerr << "Error: threads, ops, reps and ring must be non-empty/positive\n";
+        return false;
+    }
+    return true;
+}
+
+std::uint64_t now_ns() {
+    using namespace std::chrono;
+    return static_cast<std::uint64_t>(
+        duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+// Tamaños de 16 a 1024 bytes, fijos por posicion del anillo
+inline std::size_t blockSize(std::size_t i) { return std::size_t(16) << (i % 7); }
+
+// --------------------------- carga ---------------------------
+
+// Un hilo: delete del bloque mas viejo + new en su lugar, ops veces.
+// Devuelve ns por operacion.
+template <bool kRawMalloc>
+double runThread(std::size_t ring, std::uint64_t ops, std::atomic<std::uint32_t>& ready,
+                 const std::atomic<bool>& go) {
+    std::vector<char*> blocks(ring, nullptr);
+    for (std::size_t i = 0; i < ring; ++i) {
+        blocks[i] = kRawMalloc ? static_cast<char*>(std::malloc(blockSize(i))) : new char[blockSize(i)];
+    }
+    ready.fetch_add(1);
+    while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+
+    const std::uint64_t t0 = now_ns();
+    std::size_t i = 0;
+    for (std::uint64_t n = 0; n < ops; ++n) {
+        if (kRawMalloc) {
+            std::free(blocks[i]);
+            blocks[i] = static_cast<char*>(std::malloc(blockSize(i)));
+        } else {
+            delete[] blocks[i];
+            blocks[i] = new char[blockSize(i)];
+        }
+        blocks[i][0] = static_cast<char>(n); // que el compilador no elimine el par
+        if (++i == ring) i = 0;
+    }
+    const std::uint64_t t1 = now_ns();
+
+    for (char* p : blocks) {
+        if (kRawMalloc) std::free(p);
+        else delete[] p;
+    }
+    return static_cast<double>(t1 - t0) / static_cast<double>(ops);
+}
+
+// Frames de relleno bajo la carga de las configuraciones full/stack<N>
+constexpr int kStackPadding = mp::stacks::kMaxDepth + 8;
+
+// Corre runThread debajo de `frames` llamadas que el compilador no aplana
+template <bool kRawMalloc>
+__attribute__((noinline)) double nested(int frames, std::size_t ring, std::uint64_t ops,
+                                        std::atomic<std::uint32_t>& ready, const std::atomic<bool>& go) {
+    if (frames <= 0) return runThread<kRawMalloc>(ring, ops, ready, go);
+    const double r = nested<kRawMalloc>(frames - 1, ring, ops, ready, go);
+    asm volatile("" ::: "memory"); // evita la llamada de cola
+    return r;
+}
+
+// Una repeticion con `threads` hilos; devuelve el promedio de ns/op por hilo
+double runOnce(bool rawMalloc, std::uint32_t threads, const Options& o, int padding) {
+    std::atomic<std::uint32_t> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<double> per(threads, 0.0);
+    std::vector<std::thread> workers;
+    for (std::uint32_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            per[t] = rawMalloc ? nested<true>(padding, o.ring, o.ops, ready, go)
+                               : nested<false>(padding, o.ring, o.ops, ready, go);
+        });
+    }
+    while (ready.load() < threads) std::this_thread::yield();
+    go.store(true, std::memory_order_release);
+    for (auto& w : workers) w.join();
+
+    double sum = 0.0;
+    for (double v : per) sum += v;
+    return sum / static_cast<double>(threads);
+}
+
+struct Config {
+    std::string name;
+    bool rawMalloc;
+    bool enabled;
+    const char* mode;  // nullptr = no cambiar de modo
+    bool retain;       // dejar bloques registrados antes de medir
+    std::uint32_t stackDepth = 0;
+    const char* timestamp = nullptr; // nullptr = el reloj de CMake
+    std::uint32_t observers = 0;
+};
+
+// Bytes del heap por bloque vivo (menos el tamaño pedido) con n bloques
+// asignados en este hilo. mallinfo2 solo ve la arena principal.
+double memoryPerBlock(bool rawMalloc, std::size_t n) {
+    std::vector<char*> blocks;
+    blocks.reserve(n);
+    std::size_t payload = 0;
+    const std::size_t before = mallinfo2().uordblks;
+    for (std::size_t i = 0; i < n; ++i) {
+        blocks.push_back(rawMalloc ? static_cast<char*>(std::malloc(blockSize(i))) : new char[blockSize(i)]);
+        payload += blockSize(i);
+    }
+    const std::size_t after = mallinfo2().uordblks;
+    for (char* p : blocks) {
+        if (rawMalloc) std::free(p);
+        else delete[] p;
+    }
+    return (static_cast<double>(after) - static_cast<double>(before) - static_cast<double>(payload)) /
+           static_cast<double>(n);
+}
+
+// Observador que no hace nada: solo queda el costo del recorrido
+void noopAlloc(void*, void*, std::size_t, bool) {}
+void noopFree(void*, void*, std::size_t, bool) {}
+
+bool applyMode(const char* mode) {
+    if (!mode) return true;
+    std::string err;
+    if (!mp::set_tracking_mode(mode, &err)) {
+        std::cerr << "Error: MODE " << mode << ": " << err << "\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    mp::install_callbacks_with_memorytracker();
+    const mp::TimestampSource defaultClock = mp::timestamps::source();
+
+    std::vector<Config> configs;
+    configs.push_back({"malloc", true, true, nullptr, false});
+    if constexpr (mp::kDynamicPolicy) {
+        configs.push_back({"stopped/off", false, false, "off", false});
+        configs.push_back({"stopped/counters", false, false, "counters", false});
+        configs.push_back({"stopped/full", false, false, "full", true});
+        configs.push_back({"off", false, true, "off", false});
+        configs.push_back({"counters", false, true, "counters", false});
+        configs.push_back({"sampled", false, true, "sampled", false});
+        configs.push_back({"full", false, true, "full", false});
+    } else {
+        const std::string fixed = mp::current_tracking_mode();
+        configs.push_back({"stopped/" + fixed, false, false, nullptr, true});
+        configs.push_back({fixed, false, true, nullptr, false});
+    }
+    if (mp::kDynamicPolicy || std::string(mp::current_tracking_mode()) == "full") {
+        for (std::uint32_t d : opt.stackDepths) {
+            if (d == 0) continue;
+            configs.push_back({"full/stack" + std::to_string(d), false, true,
+                               mp::kDynamicPolicy ? "full" : nullptr, false, d});
+        }
+        for (const std::string& t : opt.timestamps) {
+            mp::TimestampSource src;
+            if (!mp::timestamp_source_from_name(t, src)) {
+                std::cerr << "Error: unknown timestamp source " << t << "\n";
+                return 1;
+            }
+            if (src == mp::TimestampSource::Tsc && !mp::timestamps::tsc_invariant()) {
+                std::cerr << "Skipping full/ts-tsc: invariant TSC not available\n";
+                continue;
+            }
+            configs.push_back({"full/ts-" + t, false, true,
+                               mp::kDynamicPolicy ? "full" : nullptr, false, 0,
+                               mp::timestamp_source_name(src)});
+        }
+        for (std::uint32_t n : opt.observers) {
+            if (n == 0 || n > mp::observers::kMaxObservers) continue;
+            configs.push_back({"full/obs" + std::to_string(n), false, true,
+                               mp::kDynamicPolicy ? "full" : nullptr, false, 0, nullptr, n});
+        }
+    }
+
+    if (!opt.json) {
+        std::printf("%-18s %7s %10s %10s %12s\n", "config", "threads", "p50 ns/op", "max ns/op", "vs malloc");
+    }
+
+    for (std::uint32_t threads : opt.threads) {
+        double malloc_ns = 0.0;
+        for (const Config& c : configs) {
+            mp::start();
+            if (!applyMode(c.mode)) return 1;
+
+            // Bloques registrados que siguen vivos durante la medicion
+            std::vector<char*> retained;
+            if (c.retain) {
+                retained.reserve(opt.retained);
+                for (std::size_t i = 0; i < opt.retained; ++i) retained.push_back(new char[blockSize(i)]);
+            }
+            if (!c.enabled) mp::stop();
+            mp::stacks::set_max_depth(c.stackDepth);
+            if (c.timestamp) {
+                mp::TimestampSource src = defaultClock;
+                mp::timestamp_source_from_name(c.timestamp, src);
+                mp::timestamps::set_source(src);
+            }
+            std::vector<std::uint32_t> observerIds;
+            for (std::uint32_t i = 0; i < c.observers; ++i) {
+                mp::AllocObserver o;
+                o.name    = "bench";
+                o.onAlloc = &noopAlloc;
+                o.onFree  = &noopFree;
+                observerIds.push_back(mp::observers::add(o));
+            }
+            const int padding = c.stackDepth ? kStackPadding : 0;
+
+            std::vector<double> reps;
+            for (std::uint32_t r = 0; r < opt.reps; ++r) reps.push_back(runOnce(c.rawMalloc, threads, opt, padding));
+            const SampleSummary s = summarize(reps);
+
+            mp::stacks::set_max_depth(0);
+            mp::timestamps::set_source(defaultClock);
+            for (std::uint32_t id : observerIds) mp::observers::remove(id);
+            mp::start();
+            for (char* p : retained) delete[] p;
+
+            if (c.rawMalloc) malloc_ns = s.p50;
+            const double ratio = malloc_ns > 0.0 ? s.p50 / malloc_ns : 0.0;
+            if (opt.json) {
+                std::cout << "{\"config\":\"" << c.name << "\",\"threads\":" << threads
+                          << ",\"ops_per_thread\":" << opt.ops
+                          << ",\"ns_per_op\":" << summary_json(s)
+                          << ",\"vs_malloc\":" << ratio << "}\n";
+            } else {
+                std::printf("%-18s %7u %10.1f %10.1f %11.2fx\n",
+                            c.name.c_str(), threads, s.p50, s.max, ratio);
+            }
+        }
+    }
+
+    if (opt.memBlocks == 0) return 0;
+    if (!opt.json) std::printf("\n%-18s %12s %16s\n", "config", "live blocks", "overhead B/blk");
+    for (const Config& c : configs) {
+        // Solo modos en marcha sin pilas, reloj alternativo ni observadores: esos no
+        // cambian lo que se guarda por bloque
+        if (!c.enabled || c.stackDepth || c.timestamp || c.observers) continue;
+        mp::start();
+        if (!applyMode(c.mode)) return 1;
+        const double perBlock = memoryPerBlock(c.rawMalloc, opt.memBlocks);
+        if (opt.json) {
+            std::cout << "{\"config\":\"" << c.name << "\",\"live_blocks\":" << opt.memBlocks
+                      << ",\"overhead_bytes_per_block\":" << perBlock << "}\n";
+        } else {
+            std::printf("%-18s %12zu %16.1f\n", c.name.c_str(), opt.memBlocks, perBlock);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,360 @@
+// mp_latency_bench: latencia extremo a extremo de la telemetria ante picos.
+//
+// En un mismo proceso corren:
+//   - hilos de carga que asignan/liberan bloques pequeños sin parar,
+//   - mp::SocketClient empujando SUMMARY cada N ms,
+//   - un receptor local (lado GUI) escuchando en el puerto del SocketClient.
+// El hilo principal inyecta picos de tamaño conocido con marca de tiempo y
+// mide cuanto tarda el primer SUMMARY que los refleja. Se repite para cada
+// combinacion de periodo de metricas y numero de hilos, y se compara el
+// throughput de asignacion con y sin el envio de metricas. Toda espera del
+// receptor tiene un limite de unos pocos periodos: un pico que no se ve a
+// tiempo cuenta como perdido, y sin cliente la combinacion no se cuelga.
+
+#include "CallbacksRegistration.hpp"
+#include "SocketClient.hpp"
+
+#include "JsonLite.hpp"
+#include "ToolStats.hpp"
+#include "ViewerSocket.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mp::tools;
+
+namespace {
+
+struct Options {
+    std::uint16_t port = 7777;
+    std::vector<std::uint32_t> intervals_ms{50, 100, 200, 500};
+    std::vector<std::uint32_t> threads{1, 2, 4};
+    std::uint32_t spikes = 20;            // picos por combinacion
+    std::size_t   spike_mb = 32;          // tamaño de cada pico
+    std::uint32_t throughput_ms = 1000;   // ventana para medir ops/s
+    bool json = false;
+};
+
+// Cuanto se espera un SUMMARY o la deteccion de un pico: kWaitIntervals
+// periodos de metricas, y nunca menos de kMinWaitMs (conexion inicial)
+constexpr std::uint32_t kWaitIntervals = 5;
+constexpr std::uint32_t kMinWaitMs     = 1000;
+
+std::chrono::milliseconds waitLimit(std::uint32_t interval_ms) {
+    return std::chrono::milliseconds(std::max(kWaitIntervals * interval_ms, kMinWaitMs));
+}
+
+void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]\n";
+    std::cout << "\nOptions:\n";
+    std::cout << "  --port <P>              Port for SocketClient and the local receiver (default: 7777)\n";
+    std::cout << "  --intervals <A,B,..>    SUMMARY periods to test in ms (default: 50,100,200,500)\n";
+    std::cout << "  --threads <A,B,..>      Background allocator thread counts (default: 1,2,4)\n";
+    std::cout << "  --spikes <N>            Spikes injected per combination (default: 20)\n";
+    std::cout << "  --spike-mb <MB>         Size of each spike (default: 32)\n";
+    std::cout << "  --throughput-ms <M>     Window used to measure allocation throughput (default: 1000)\n";
+    std::cout << "  --json                  Print results as JSON lines\n";
+    std::cout << "  --help                  Show this help message\n";
+}
+
+std::vector<std::uint32_t> parseList(const std::string& s) {
+    std::vector<std::uint32_t> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(static_cast<std::uint32_t>(std::atoi(item.c_str())));
+    }
+    return out;
+}
+
+bool parseArgs(int argc, char* argv[], Options& o) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto val = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (a == "--help") return false;
+        else if (a == "--json")          o.json = true;
+        else if (a == "--port")          o.port = static_cast<std::uint16_t>(std::atoi(val().c_str()));
+        else if (a == "--intervals")     o.intervals_ms = parseList(val());
+        else if (a == "--threads")       o.threads = parseList(val());
+        else if (a == "--spikes")        o.spikes = static_cast<std::uint32_t>(std::atoi(val().c_str()));
+        else if (a == "--spike-mb")      o.spike_mb = static_cast<std::size_t>(std::atoi(val().c_str()));
+        else if (a == "--throughput-ms") o.throughput_ms = static_cast<std::uint32_t>(std::atoi(val().c_str()));
+        else {
+            std::cerr << "Error: unknown option " << a << "\n";
+            return false;
+        }
+    }
+    if (o.intervals_ms.empty() || o.threads.empty() || o.spikes == 0 || o.spike_mb == 0) {
+        std::cerr << "Error: intervals, threads, spikes and spike-mb must be non-empty/positive\n";
+        return false;
+    }
+    return true;
+}
+
+// --------------------------- carga de fondo ---------------------------
+
+/**
+ * Hilos que asignan y liberan bloques de 16..4096 bytes manteniendo un
+ * conjunto vivo acotado (~256 bloques por hilo), para que el ruido en
+ * bytes_in_use sea muy inferior al tamaño del pico.
+ */
+class BackgroundLoad {
+public:
+    void start(std::uint32_t threads) {
+        stop_.store(false);
+        ops_.store(0);
+        for (std::uint32_t t = 0; t < threads; ++t) {
+            workers_.emplace_back([this, t] { run(t); });
+        }
+    }
+
+    void stop() {
+        stop_.store(true);
+        for (auto& w : workers_) w.join();
+        workers_.clear();
+    }
+
+    std::uint64_t ops() const { return ops_.load(std::memory_order_relaxed); }
+
+private:
+    void run(std::uint32_t seed) {
+        std::mt19937 rng(1234 + seed);
+        std::vector<char*> live(256, nullptr);
+        std::uint64_t local = 0;
+        while (!stop_.load(std::memory_order_relaxed)) {
+            for (int i = 0; i < 256; ++i) {
+                std::size_t slot = rng() & 255;
+                delete[] live[slot];
+                live[slot] = new char[16 + (rng() & 4095)];
+                local += 2;
+            }
+            ops_.fetch_add(local, std::memory_order_relaxed);
+            local = 0;
+        }
+        for (char* p : live) delete[] p;
+    }
+
+    std::atomic<bool> stop_{false};
+    std::atomic<std::uint64_t> ops_{0};
+    std::vector<std::thread> workers_;
+};
+
+// Throughput de la carga durante una ventana fija
+double measureOpsPerSec(BackgroundLoad& load, std::uint32_t window_ms) {
+    const std::uint64_t o0 = load.ops(), t0 = now_ns();
+    std::this_thread::sleep_for(std::chrono::milliseconds(window_ms));
+    const std::uint64_t o1 = load.ops(), t1 = now_ns();
+    return (o1 - o0) * 1e9 / static_cast<double>(t1 - t0);
+}
+
+// --------------------------- receptor ---------------------------
+
+/**
+ * Lado GUI: lee frames y publica el ultimo bytes_in_use de cada SUMMARY.
+ * Si hay un pico armado, registra cuando aparece el primero que lo supera.
+ */
+class Receiver {
+public:
+    bool listen(std::uint16_t port) { return sock_.listen("127.0.0.1", port); }
+
+    void start() {
+        stop_.store(false);
+        thread_ = std::thread([this] { run(); });
+    }
+
+    void stop() {
+        stop_.store(true);
+        if (thread_.joinable()) thread_.join();
+        sock_.closeConnection();
+    }
+
+    // Espera un SUMMARY posterior a after_ns y deja en bytes su
+    // bytes_in_use; false si no llega dentro de limit
+    bool waitSummary(std::uint64_t after_ns, std::chrono::milliseconds limit, std::uint64_t& bytes) {
+        std::unique_lock<std::mutex> lk(m_);
+        const bool got = cv_.wait_for(lk, limit, [&] { return last_recv_ns_ > after_ns || stop_.load(); });
+        bytes = last_bytes_;
+        return got && last_recv_ns_ > after_ns;
+    }
+
+    // Arma la deteccion antes de crear el pico (aun sin marca de tiempo)
+    void arm(std::uint64_t threshold) {
+        std::lock_guard<std::mutex> lk(m_);
+        threshold_ = threshold;
+        spike_ns_ = UINT64_MAX;
+        detected_ns_ = 0;
+    }
+
+    // Marca el fin del pico; cuenta tambien un SUMMARY llegado justo despues
+    void spikeDone(std::uint64_t spike_ns) {
+        std::lock_guard<std::mutex> lk(m_);
+        spike_ns_ = spike_ns;
+        if (last_recv_ns_ >= spike_ns && last_bytes_ >= threshold_) detected_ns_ = last_recv_ns_;
+    }
+
+    // Momento del SUMMARY que mostro el pico; 0 si no llego dentro de limit
+    std::uint64_t waitDetected(std::chrono::milliseconds limit) {
+        std::unique_lock<std::mutex> lk(m_);
+        cv_.wait_for(lk, limit, [&] { return detected_ns_ != 0 || stop_.load(); });
+        threshold_ = 0;
+        return detected_ns_;
+    }
+
+private:
+    void run() {
+        ReceivedFrame f;
+        while (!stop_.load()) {
+            if (!sock_.connected() && !sock_.accept(100)) continue;
+            if (sock_.readFrame(f, 50) <= 0) continue;
+            if (f.json.find("\"type\":\"SUMMARY\"") == std::string::npos) continue;
+
+            JsonValue doc;
+            if (!json_parse(f.json, doc)) continue;
+            const JsonValue* p = doc.get("payload");
+            if (!p) continue;
+            const std::uint64_t bytes = p->u64("bytes_in_use");
+
+            std::lock_guard<std::mutex> lk(m_);
+            last_bytes_ = bytes;
+            last_recv_ns_ = f.recv_ns;
+            if (threshold_ && !detected_ns_ && bytes >= threshold_ && f.recv_ns >= spike_ns_) {
+                detected_ns_ = f.recv_ns;
+            }
+            cv_.notify_all();
+        }
+        cv_.notify_all();
+    }
+
+    ViewerSocket sock_;
+    std::thread thread_;
+    std::atomic<bool> stop_{false};
+
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::uint64_t last_bytes_ = 0, last_recv_ns_ = 0;
+    std::uint64_t threshold_ = 0, spike_ns_ = 0, detected_ns_ = 0;
+};
+
+struct ComboResult {
+    std::uint32_t interval_ms;
+    std::uint32_t threads;
+    SampleSummary latency;
+    std::uint32_t missed;       // picos sin SUMMARY que los mostrara a tiempo
+    double ops_baseline;
+    double ops_with_metrics;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    mp::install_callbacks_with_memorytracker();
+
+    Receiver rx;
+    if (!rx.listen(opt.port)) {
+        std::cerr << "Error: cannot listen on port " << opt.port << "\n";
+        return 1;
+    }
+    rx.start();
+
+    const std::size_t spike_bytes = opt.spike_mb * 1024 * 1024;
+    const std::size_t kChunk = 1024 * 1024;
+    std::mt19937 jitter(42);
+    std::vector<ComboResult> results;
+
+    for (std::uint32_t threads : opt.threads) {
+        BackgroundLoad load;
+        load.start(threads);
+
+        // Throughput sin SocketClient: solo el costo del tracking
+        const double baseline = measureOpsPerSec(load, opt.throughput_ms);
+
+        for (std::uint32_t interval : opt.intervals_ms) {
+            mp::SocketClient client;
+            client.setMetricsIntervalMs(interval);
+            client.start("127.0.0.1", opt.port);
+
+            const std::chrono::milliseconds limit = waitLimit(interval);
+            std::uint64_t base = 0;
+            const bool connected = rx.waitSummary(now_ns(), limit, base);
+            if (!connected) {
+                std::cerr << "Warning: no SUMMARY within " << limit.count() << " ms (interval=" << interval
+                          << "ms threads=" << threads << "); counting every spike as missed\n";
+            }
+            const double with_metrics = measureOpsPerSec(load, opt.throughput_ms);
+
+            std::vector<double> lat_ms;
+            std::uint32_t missed = 0;
+            for (std::uint32_t s = 0; s < opt.spikes; ++s) {
+                // Desfase aleatorio respecto al ultimo SUMMARY, para muestrear
+                // todas las fases del periodo de metricas
+                if (!connected || !rx.waitSummary(now_ns(), limit, base)) {
+                    ++missed;
+                    continue;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(jitter() % (interval * 1000u)));
+                rx.arm(base + spike_bytes / 2);
+                std::vector<char*> spike;
+                spike.reserve(spike_bytes / kChunk);
+                for (std::size_t b = 0; b < spike_bytes; b += kChunk) {
+                    char* p = new char[kChunk];
+                    p[0] = 1; // tocar la pagina
+                    spike.push_back(p);
+                }
+                const std::uint64_t t_spike = now_ns();
+                rx.spikeDone(t_spike);
+                const std::uint64_t t_seen = rx.waitDetected(limit);
+                if (t_seen) lat_ms.push_back((t_seen - t_spike) / 1e6);
+                else ++missed;
+
+                for (char* p : spike) delete[] p;
+                std::uint64_t ignored = 0;
+                rx.waitSummary(now_ns(), limit, ignored); // que el pico desaparezca antes del siguiente
+            }
+
+            client.stop();
+            results.push_back(ComboResult{interval, threads, summarize(lat_ms), missed, baseline, with_metrics});
+
+            const ComboResult& r = results.back();
+            const double slowdown = r.ops_baseline > 0 ? (1.0 - r.ops_with_metrics / r.ops_baseline) * 100.0 : 0.0;
+            if (opt.json) {
+                std::cout << "{\"interval_ms\":" << interval << ",\"threads\":" << threads
+                          << ",\"spike_bytes\":" << spike_bytes
+                          << ",\"latency_ms\":" << summary_json(r.latency)
+                          << ",\"missed\":" << r.missed
+                          << ",\"ops_per_s_baseline\":" << r.ops_baseline
+                          << ",\"ops_per_s_with_metrics\":" << r.ops_with_metrics
+                          << ",\"slowdown_pct\":" << slowdown << "}" << std::endl;
+            } else {
+                char line[256];
+                std::snprintf(line, sizeof(line),
+                              "interval=%4ums threads=%2u  spike->SUMMARY p50=%7.2fms p90=%7.2fms p99=%7.2fms max=%7.2fms"
+                              " missed=%u/%u  alloc ops/s %.0f -> %.0f (%+.1f%%)\n",
+                              interval, threads, r.latency.p50, r.latency.p90, r.latency.p99, r.latency.max,
+                              r.missed, opt.spikes, r.ops_baseline, r.ops_with_metrics, -slowdown);
+                std::cout << line << std::flush;
+            }
+        }
+        load.stop();
+    }
+
+    rx.stop();
+    return 0;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mp {
+
+    // Cantidad de buckets del histograma de tamaños: bucket i cubre
+    // [2^i, 2^(i+1)) bytes; el ultimo acumula todo lo mayor
+    constexpr std::size_t kSizeHistogramBuckets = 32;
+
+    // Histograma de vida de los bloques liberados: bucket i cubre
+    // [10^(i-1), 10^i) microsegundos (el 0, menos de 1 us); el ultimo
+    // acumula 1 s o mas
+    constexpr std::size_t kLifetimeBuckets = 8;
+
+    // Uso vivo agrupado por callsite (file:line)
+    struct CallsiteUsage {
+        std::string   callsite;            // "file:line" o "?:0"
+        std::uint64_t live_bytes  = 0;
+        std::uint64_t live_count  = 0;
+        std::uint64_t total_allocs = 0;    // asignaciones historicas en ese callsite
+    };
+
+    // Uso vivo agrupado por hilo
+    struct ThreadUsage {
+        std::uint32_t thread_id   = 0;     // id denso (ThreadRegistry.hpp)
+        std::string   name;
+        std::uint64_t live_bytes  = 0;
+        std::uint64_t live_count  = 0;
+        std::uint64_t total_allocs = 0;
+    };
+
+    // DTO con los agregados que usa el mensaje STATS (mp_top).
+    // Se arma en O(#callsites + #hilos), sin recorrer los bloques vivos.
+    struct AggregateStats {
+        std::uint64_t t_ns         = 0;    // reloj monotono al armar el agregado
+        std::uint64_t bytes_in_use = 0;
+        std::uint64_t peak         = 0;
+        std::uint64_t live_count   = 0;
+        std::uint64_t total_allocs = 0;
+        std::uint64_t total_frees  = 0;
+        std::uint64_t total_bytes  = 0;    // bytes asignados historicos
+
+        std::uint64_t callsite_count = 0;  // callsites distintos con datos
+        std::vector<CallsiteUsage> top_callsites; // ordenados por live_bytes desc
+        std::vector<ThreadUsage>   threads;       // ordenados por live_bytes desc
+
+        // Bloques vivos por bucket de tamaño
+        std::uint64_t size_hist_count[kSizeHistogramBuckets] = {};
+        std::uint64_t size_hist_bytes[kSizeHistogramBuckets] = {};
+
+        // Frees de bloques registrados por tiempo de vida
+        std::uint64_t lifetime_hist[kLifetimeBuckets] = {};
+
+        // Buffer de asignaciones recientes (MemoryTracker): frees que
+        // cancelaron un bloque sin pasar por la tabla, y bloques que
+        // salieron del buffer hacia la tabla
+        std::uint64_t recent_hits     = 0;
+        std::uint64_t recent_promoted = 0;
+    };
+
+    // Indice del bucket del histograma para un tamaño
+    inline std::size_t size_histogram_bucket(std::size_t sz) noexcept {
+        if (sz <= 1) return 0;
+        const std::size_t b = 63u - static_cast<std::size_t>(__builtin_clzll(static_cast<unsigned long long>(sz)));
+        return b < kSizeHistogramBuckets ? b : kSizeHistogramBuckets - 1;
+    }
+
+    // Indice del bucket del histograma de vida para una duracion en ns
+    inline std::size_t lifetime_bucket(std::uint64_t ns) noexcept {
+        std::size_t b = 0;
+        for (std::uint64_t limit = 1000; b + 1 < kLifetimeBuckets && ns >= limit; limit *= 10) ++b;
+        return b;
+    }
+
+} // namespace mp
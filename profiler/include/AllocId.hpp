@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace mp {
+namespace alloc_ids {
+
+    // Ids de asignacion, fijados en el hook y guardados en el registro: el
+    // mismo bloque tiene el mismo id en todos los snapshots.
+    //
+    // Cada hilo reserva rangos de kBatch ids al contador global y los
+    // reparte sin atomicos, asi que los ids son unicos y crecientes por
+    // hilo, pero entre hilos solo quedan ordenados por rango. Para
+    // "asignado despues de X" esta fence(): descarta los rangos a medio
+    // usar, de modo que todo id >= su resultado es posterior a la llamada.
+
+    constexpr std::uint64_t kBatch = 1024;
+
+    inline std::atomic<std::uint64_t> g_next{1};   // 0 = sin id
+    inline std::atomic<std::uint32_t> g_epoch{0};  // lo sube fence()
+
+    struct Range {
+        std::uint64_t next  = 0;
+        std::uint64_t end   = 0;
+        std::uint32_t epoch = 0;
+    };
+    inline thread_local Range t_range;
+
+    // Id para la asignacion que se esta registrando
+    inline std::uint64_t next() noexcept {
+        Range& r = t_range;
+        const std::uint32_t e = g_epoch.load(std::memory_order_acquire);
+        if (r.next == r.end || r.epoch != e) {
+            r.next  = g_next.fetch_add(kBatch, std::memory_order_relaxed);
+            r.end   = r.next + kBatch;
+            r.epoch = e;
+        }
+        return r.next++;
+    }
+
+    // Marca de agua: los ids >= el valor devuelto son de asignaciones
+    // posteriores (salvo las que corrian en paralelo con la llamada)
+    inline std::uint64_t fence() noexcept {
+        g_epoch.fetch_add(1, std::memory_order_acq_rel);
+        return g_next.load(std::memory_order_acquire);
+    }
+
+} // namespace alloc_ids
+} // namespace mp
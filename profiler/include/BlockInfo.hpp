@@ -6,10 +6,16 @@
 namespace mp {
 
     // DTO público que usa Serializer.{csv,json}
+    //
+    // Los backends del profiler (MemoryTracker, Header) llenan solo type_id
+    // y dejan type_name vacio: el nombre sale de types::name(type_id)
+    // (TypeRegistry.hpp), que no copia un string por bloque. type_name queda
+    // para backends propios que no pasan por el registro; el serializador
+    // lo usa cuando type_id es 0.
     struct BlockInfo {
         void*         ptr        = nullptr;
         std::size_t   size       = 0;
-        std::uint64_t alloc_id   = 0;
+        std::uint64_t alloc_id   = 0;      // fijado al asignar: igual en todos los snapshots
         std::uint32_t thread_id  = 0;
         std::uint64_t t_ns       = 0;
         std::string   callsite;            // "file:line[:func]"
@@ -17,7 +23,10 @@ namespace mp {
         // Campos adicionales para la GUI
         std::string   file;                // archivo fuente
         int           line       = 0;      // línea de código
-        std::string   type_name;           // nombre del tipo
+        std::string   type_name;           // nombre del tipo (vacio si viene en type_id)
+        std::uint32_t type_id    = 0;      // id en TypeRegistry (0 = desconocido)
+        std::uintptr_t pc        = 0;      // direccion de retorno de new (0 = sin capturar)
+        std::uint32_t stack_id   = 0;      // pila completa (Stacks.hpp), 0 = sin capturar
     };
 
 } // namespace mp
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace mp {
+
+    class MemoryTracker;
+
+namespace boot {
+
+    // Registro de arranque (politica Dynamic).
+    //
+    // Hasta que install_callbacks_with_memorytracker() publica una tabla, los
+    // hooks no tienen a quien avisar: todo lo de la inicializacion estatica y
+    // la carga de bibliotecas se perdia, y sus frees posteriores se ignoraban.
+    // Mientras no hay tabla, los hooks anotan aqui eventos crudos (alloc con
+    // tamaño, hilo, PC, hora e id; free con el puntero) en un buffer estatico
+    // de MP_BOOT_EVENTS entradas, sin asignar memoria. Al instalar, los
+    // eventos se aplican en orden a MemoryTracker: los bloques que siguen
+    // vivos quedan con sus datos originales y los totales incluyen el
+    // arranque.
+    //
+    // Lleno el buffer, los eventos se descartan y se cuentan en "dropped"; un
+    // bloque cuyo free se descarto queda vivo en el tracker. Si alguien
+    // publica su propia tabla, el buffer se abandona.
+    //
+    // Entre publicar la tabla y la ultima pasada, un free puede llegar al
+    // tracker antes que el alloc anotado de su bloque. Esos frees (los que
+    // el tracker no conoce) se siguen anotando en el buffer, y la ultima
+    // pasada los aplica despues del alloc; si la pasada ya termino, se
+    // vuelven a buscar en el tracker.
+
+#ifndef MP_BOOT_EVENTS
+#define MP_BOOT_EVENTS 16384
+#endif
+    constexpr std::size_t kCapacity = MP_BOOT_EVENTS;
+
+    // Los llama DynamicCallbacks con la tabla vacia (fuera de in_hook)
+    void recordAlloc(void* p, std::size_t sz, bool isArray) noexcept;
+    void recordFree(void* p) noexcept;
+
+    // Aplica al tracker los eventos desde `from` hasta los anotados ahora;
+    // devuelve el siguiente indice. Lo usa la instalacion en dos pasadas:
+    // antes de publicar la tabla y, pasado el periodo de gracia, el resto.
+    std::size_t replayInto(MemoryTracker& t, std::size_t from);
+
+    // Deja de anotar (los hooks que aun vean la tabla vacia descartan)
+    void close() noexcept;
+
+    // Ventana de instalacion. La instalacion la abre antes de publicar la
+    // tabla y finishInto (ultima pasada, luego close) la cierra. El hook de
+    // free lee latePending() ANTES de buscar en el tracker y, si no
+    // encontro el bloque, llama a lateFree (devuelve true si ahora si).
+    void openLateFrees() noexcept;
+    void finishInto(MemoryTracker& t, std::size_t from);
+    bool lateFree(MemoryTracker& t, void* p) noexcept;
+
+    namespace detail {
+        inline std::atomic<bool> g_late_pending{false};
+    }
+    inline bool latePending() noexcept {
+        return detail::g_late_pending.load(std::memory_order_acquire);
+    }
+
+    // Costo del arranque, para el SUMMARY
+    struct Stats {
+        std::uint64_t allocs     = 0;
+        std::uint64_t frees      = 0;
+        std::uint64_t bytes      = 0;   // asignados durante el arranque
+        std::uint64_t live_bytes = 0;   // de esos, vivos al instalar
+        std::uint64_t live_count = 0;
+        std::uint64_t dropped    = 0;   // no entraron en el buffer
+        std::uint64_t span_ns    = 0;   // del primer al ultimo evento
+    };
+    Stats stats() noexcept;
+    bool recorded() noexcept;           // hubo algun evento
+
+    // {"allocs":..,"frees":..,"bytes":..,"live_bytes":..,"live_count":..,
+    //  "dropped":..,"span_ns":..}
+    std::string stats_json();
+
+} // namespace boot
+} // namespace mp
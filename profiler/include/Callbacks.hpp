@@ -3,6 +3,7 @@
 #include <vector>
 #include <cstdint>
 #include "BlockInfo.hpp"
+#include "AggregateStats.hpp"
 
 namespace mp {
 
@@ -16,14 +17,45 @@ namespace mp {
         std::function<std::size_t()> allocCount;
 
         std::function<std::uint64_t()>          snapshot;
+        // Bloques vivos; los del profiler traen type_id, no type_name (ver BlockInfo)
         std::function<std::vector<BlockInfo>()> liveBlocks;
 
+        // Agregados para STATS; el argumento es el tamaño del top de callsites
+        std::function<AggregateStats(std::size_t)> aggregate;
+
+        // Ruta rapida opcional: si estan, el hook los llama directo en lugar de
+        // onAlloc/onFree, tambien con in_hook activo (ellos lo manejan)
+        void (*rawAlloc)(void*, std::size_t, bool) = nullptr;
+        void (*rawFree)(void*, bool)               = nullptr;
+
+        // Hooks con el profiler detenido (mp::stop). nullptr = descartar si
+        // hay rawAlloc/rawFree; si no, se llama a onAlloc/onFree como siempre
+        void (*rawAllocStopped)(void*, std::size_t, bool) = nullptr;
+        void (*rawFreeStopped)(void*, bool)               = nullptr;
+
+        // Lo asigna register_callbacks: crece con cada tabla publicada
         std::uint32_t version = 1;
     };
 
+    // Publica una copia inmutable de c como tabla activa (version nueva).
+    // La tabla anterior se libera cuando ya no la usa ningun lector.
     void register_callbacks(const Callbacks& c);
 
-    // Siempre devuelve callbacks válidos (no-op si no han registrado)
+    // Tabla activa. La referencia solo es valida mientras el hilo tenga
+    // abierto un epoch::ReadGuard (los hooks y ProfilerAPI lo abren).
+    // Siempre devuelve callbacks válidos (no-op si no han registrado).
     const Callbacks& get_callbacks();
 
-} // namespace mp
\ No newline at end of file
+    // Tabla activa o nullptr si nadie registro; misma regla del ReadGuard.
+    // Es lo que usa el hook: una carga atomica, sin call_once.
+    const Callbacks* active_callbacks() noexcept;
+
+    // Que pide la tabla activa con el profiler detenido (bits kStopped*).
+    // Sin ReadGuard: el hook lo consulta antes de cargar la tabla.
+    enum : std::uint8_t { kStoppedAllocs = 1, kStoppedFrees = 2 };
+    std::uint8_t callbacks_stopped_hooks() noexcept;
+
+    // Version de la tabla activa (0 si nadie registro)
+    std::uint32_t callbacks_version() noexcept;
+
+} // namespace mp
@@ -1,6 +1,13 @@
 #pragma once
+#include "Callbacks.hpp"
 
 namespace mp {
     // Instala los callbacks del profiler usando MemoryTracker
     void install_callbacks_with_memorytracker();
-}
\ No newline at end of file
+
+    // Tabla de callbacks sobre MemoryTracker, sin publicarla (base de los modos)
+    Callbacks make_memorytracker_callbacks();
+
+    // Tabla de consultas sobre HeaderTracker (politica Header); el hook no la usa
+    Callbacks make_header_callbacks();
+}
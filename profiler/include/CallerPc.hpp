@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace mp {
+
+    // TLS: direccion de retorno de la ultima llamada a operator new del hilo.
+    // La escribe el hook (si se compilo con MP_CALLER_PC) y la lee
+    // MemoryTracker al registrar el bloque.
+    inline thread_local const void* g_caller_pc = nullptr;
+
+namespace pcs {
+
+    // Tabla de PCs de quien llamo a new, para atribuir asignaciones sin
+    // MP_NEW_FT ni ScopedCallsite.
+    //
+    // Cada PC distinto recibe un id denso de 32 bits (1, 2, 3... en orden
+    // de llegada); el registro del tracker solo guarda el id. La insercion
+    // es sin lock (sondeo lineal con CAS) porque corre en cada asignacion
+    // registrada. Si el sondeo no encuentra lugar en kMaxProbes slots el
+    // PC queda sin atribucion (id 0) y se cuenta en misses(). El nombre del
+    // PC (dladdr + __cxa_demangle) se resuelve recien al serializar un
+    // snapshot o STATS, y queda cacheado.
+
+    constexpr std::uint32_t kMaxPcs = 1u << 16;   // llena: id 0 (sin atribucion)
+
+    // Id del PC (0 si pc es nullptr o no hubo lugar en la tabla)
+    std::uint32_t intern(const void* pc) noexcept;
+
+    // PC de un id (0 si el id es 0 o desconocido)
+    std::uintptr_t address(std::uint32_t id) noexcept;
+
+    // "funcion+0x1a (modulo)", o "modulo+0x1234" si el simbolo no es
+    // visible para dladdr (static, o ejecutable sin -rdynamic). Archivo y
+    // linea requieren DWARF: quedan para la simbolizacion fuera de linea.
+    std::string symbolize(std::uint32_t id);
+
+    // Con false, symbolize devuelve el PC en hex ("0x...") sin llamar a
+    // dladdr, y la traduccion queda para mp_symbolize. El valor inicial
+    // viene de MP_ONLINE_SYMBOLIZATION en CMake.
+    void set_online_symbolization(bool on) noexcept;
+    bool online_symbolization() noexcept;
+
+    // Cantidad de PCs distintos registrados (el id mas alto)
+    std::uint32_t count() noexcept;
+
+    // Llamadas a intern() que devolvieron 0 por falta de lugar: asignaciones
+    // que quedaron sin atribucion por PC
+    std::uint64_t misses() noexcept;
+
+} // namespace pcs
+} // namespace mp
@@ -1,5 +1,10 @@
 #pragma once
+#include <array>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
 
 namespace mp {
 
@@ -13,6 +18,80 @@ namespace mp {
     // TLS: cada hilo mantiene su callsite actual.
     inline thread_local CallsiteInfo g_callsite;
 
+    // === Descriptores de callsite en tiempo de compilacion ===
+    //
+    // Un descriptor estatico por expansion de macro (MP_NEW_FT, MP_MAKE_TRACKED)
+    // con inicializacion constante: no hay guard de static ni typeid en
+    // tiempo de ejecucion. La primera vez que se usa recibe un id denso de
+    // 32 bits y desde ahi el hilo solo guarda ese id en g_callsite_id; el
+    // hook lo traduce a file/line/tipo.
+
+    struct CallsiteDescriptor {
+        const char* file;
+        int         line;
+        const char* type_name;   // demangleado en compilacion (type_name<T>())
+        std::size_t type_size;   // sizeof(T)
+        std::atomic<std::uint32_t> id{0};   // 0 = todavia sin registrar
+
+        constexpr CallsiteDescriptor(const char* f, int l, const char* t, std::size_t sz) noexcept
+            : file(f), line(l), type_name(t), type_size(sz) {}
+    };
+
+    constexpr std::uint32_t kMaxCallsiteIds = 1u << 14; // lleno: id 0 (sin atribucion)
+
+    // Asigna el id (una vez por descriptor, con lock)
+    std::uint32_t register_callsite(CallsiteDescriptor& d) noexcept;
+
+    inline std::uint32_t callsite_id(CallsiteDescriptor& d) noexcept {
+        const std::uint32_t id = d.id.load(std::memory_order_acquire);
+        return id ? id : register_callsite(d);
+    }
+
+    // Descriptor de un id (nullptr si es 0 o desconocido)
+    const CallsiteDescriptor* callsite_descriptor(std::uint32_t id) noexcept;
+
+    // TLS: id del descriptor para la proxima asignacion (0 = usar g_callsite)
+    inline thread_local std::uint32_t g_callsite_id = 0;
+
+    inline void setCallsiteId(std::uint32_t id) noexcept { g_callsite_id = id; }
+
+    namespace detail {
+        template <class T>
+        constexpr std::string_view pretty_name() noexcept {
+        #if defined(__clang__) || defined(__GNUC__)
+            return __PRETTY_FUNCTION__;
+        #else
+            return "";
+        #endif
+        }
+
+        // GCC: "... pretty_name() [with T = Foo; ...]", clang: "... [T = Foo]"
+        template <class T>
+        constexpr std::string_view type_name_view() noexcept {
+            constexpr std::string_view p = pretty_name<T>();
+            constexpr std::size_t b = p.find("T = ");
+            if constexpr (b == std::string_view::npos) {
+                return "?";
+            } else {
+                constexpr std::size_t e = p.find_first_of(";]", b + 4);
+                return p.substr(b + 4, (e == std::string_view::npos ? p.size() : e) - (b + 4));
+            }
+        }
+
+        template <class T, std::size_t... I>
+        constexpr std::array<char, sizeof...(I) + 1> type_name_array(std::index_sequence<I...>) noexcept {
+            return {{type_name_view<T>()[I]..., '\0'}};
+        }
+
+        template <class T>
+        inline constexpr auto type_name_storage =
+            type_name_array<T>(std::make_index_sequence<type_name_view<T>().size()>{});
+    } // namespace detail
+
+    // Nombre legible del tipo, armado en compilacion (sin __cxa_demangle)
+    template <class T>
+    constexpr const char* type_name() noexcept { return detail::type_name_storage<T>.data(); }
+
     // Setters simples (pedidos en el enunciado)
     inline void setCallsite(const char* file, int line) noexcept {
         g_callsite.file = file;
@@ -22,9 +101,31 @@ namespace mp {
         g_callsite.type_name = tn;
     }
 
-    // Get/clear utilitarios
-    inline CallsiteInfo currentCallsite() noexcept { return g_callsite; }
-    inline void clearCallsite() noexcept { g_callsite = {}; }
+    // Get/clear utilitarios. Un id de descriptor tiene prioridad.
+    inline CallsiteInfo currentCallsite() noexcept {
+        if (g_callsite_id) {
+            if (const CallsiteDescriptor* d = callsite_descriptor(g_callsite_id)) {
+                return CallsiteInfo{d->file, d->line, d->type_name};
+            }
+        }
+        return g_callsite;
+    }
+    // Id de un callsite dado por file/line/tipo. Si coincide con el
+    // descriptor de g_callsite_id se usa ese; si no (setCallsite,
+    // ScopedCallsite) se crea un descriptor por (file, line, tipo), que no
+    // se libera. 0 sin file ni tipo. La primera vez asigna: llamar con
+    // in_hook puesto.
+    std::uint32_t callsite_id_of(const CallsiteInfo& cs);
+
+    // Id del callsite de la proxima asignacion del hilo (ver callsite_id_of)
+    inline std::uint32_t current_callsite_id() {
+        return g_callsite_id ? g_callsite_id : callsite_id_of(g_callsite);
+    }
+
+    inline void clearCallsite() noexcept {
+        g_callsite = {};
+        g_callsite_id = 0;
+    }
 
     // RAII para setear (y restaurar) el callsite durante la vida de un scope.
     class ScopedCallsite {
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace mp {
+
+    // Codecs disponibles para comprimir frames grandes del socket
+    enum class Codec : std::uint8_t {
+        None = 0,
+        MpLz,   // LZ77 rapido propio (formato de bloque estilo LZ4), siempre disponible
+        Zlib,   // solo si se compilo con MP_HAVE_ZLIB
+    };
+
+    // Nombre en el protocolo ("none", "mplz", "zlib")
+    const char* codec_name(Codec c) noexcept;
+
+    // Interpreta un nombre del protocolo; false si no existe o no esta compilado
+    bool codec_from_name(const std::string& name, Codec& out) noexcept;
+
+    // Lista JSON de codecs soportados por este build: ["mplz","zlib"]
+    std::string available_codecs_json();
+
+    // Comprime [data, data+n) y reemplaza el contenido de out. false si falla.
+    bool compress_frame(Codec c, const char* data, std::size_t n, std::string& out);
+
+    // Descomprime un bloque cuyo tamaño original es raw_size. false si el bloque
+    // esta corrupto o no produce exactamente raw_size bytes.
+    bool decompress_frame(Codec c, const char* data, std::size_t n,
+                          std::size_t raw_size, std::string& out);
+
+    // Totales acumulados de la compresion de frames (para el SUMMARY)
+    struct CompressionStats {
+        std::uint64_t frames           = 0; // frames comprimidos
+        std::uint64_t raw_bytes        = 0; // bytes antes de comprimir
+        std::uint64_t compressed_bytes = 0; // bytes enviados por el socket
+        std::uint64_t cpu_ns           = 0; // CPU del hilo dentro del codec (thread_cpu_ns)
+    };
+
+    // Tiempo de CPU del hilo actual en ns (CLOCK_THREAD_CPUTIME_ID): no
+    // cuenta el tiempo en que el hilo estuvo desalojado
+    std::uint64_t thread_cpu_ns() noexcept;
+
+    // ns: diferencia de thread_cpu_ns() alrededor de compress_frame
+    void record_compression(std::size_t raw, std::size_t compressed, std::uint64_t ns) noexcept;
+    CompressionStats compression_stats() noexcept;
+
+} // namespace mp
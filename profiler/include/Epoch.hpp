@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+
+namespace mp {
+namespace epoch {
+
+    // Reclamacion por epocas para datos publicados con un puntero atomico
+    // (tabla de callbacks, lista de observadores...).
+    //
+    // Lector: abre un ReadGuard, carga el puntero y lo usa solo mientras el
+    // guard vive. Escritor: publica el nuevo objeto, luego llama retire() con
+    // el anterior; se libera cuando ningun lector que pudo verlo sigue activo.
+    //
+    // Cada hilo ocupa un slot con la epoca global vista al entrar (0 = fuera).
+    // Los guards se pueden anidar; solo el externo toca el slot.
+
+    class ReadGuard {
+    public:
+        ReadGuard() noexcept;
+        ~ReadGuard();
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+    };
+
+    // Encola p para liberarlo con deleter cuando termine el periodo de gracia.
+    // Intenta reclamar en el momento; lo que no se pueda queda para despues.
+    void retire(void* p, void (*deleter)(void*));
+
+    // Libera lo retirado cuyo periodo de gracia ya termino.
+    // Devuelve cuantos objetos siguen pendientes.
+    std::uint64_t try_reclaim();
+
+    // Espera (cediendo el CPU) a que salgan todos los lectores que entraron
+    // antes de la llamada. No frena a los lectores nuevos.
+    // No se debe llamar dentro de un ReadGuard.
+    void synchronize();
+
+} // namespace epoch
+} // namespace mp
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "AggregateStats.hpp"
+#include "BlockInfo.hpp"
+
+namespace mp {
+namespace header {
+
+    // Seguimiento con la metadata delante de cada bloque
+    // (MP_TRACKING_POLICY=Header).
+    //
+    // El hook pide kHeaderBytes de mas a malloc y devuelve base + kHeaderBytes;
+    // el encabezado queda justo antes del puntero del usuario. Los bloques
+    // vivos forman una lista doble intrusiva por hilo (el que asigno), asi
+    // que free desenlaza en O(1) tomando solo el spinlock de esa lista, sin
+    // tabla global. Todo bloque que sale del hook lleva encabezado, tambien
+    // los internos del profiler y los de mp::stop(); esos no entran a las
+    // listas (kTracked apagado).
+    //
+    // El campo magic mezcla una constante con la direccion del encabezado:
+    // un puntero ajeno (sin encabezado) no coincide y se libera tal cual, y
+    // al liberar se borra, asi que un segundo delete tampoco coincide.
+
+    struct alignas(16) BlockHeader {
+        BlockHeader*  prev;
+        BlockHeader*  next;
+        std::uint64_t size;        // bytes pedidos
+        std::uint64_t timestamp;   // crudo de timestamps::now()
+        std::uint64_t alloc_id;    // AllocId.hpp
+        std::uint32_t thread_id;   // lista donde esta enlazado (ThreadRegistry.hpp)
+        std::uint32_t callsite;    // id de descriptor (Callsite.hpp), 0 = sin atribucion
+        std::uint32_t pc_id;       // CallerPc.hpp
+        std::uint32_t offset;      // user - base (mas que kHeaderBytes si hubo alineacion)
+        std::uint64_t magic;       // kMagic ^ direccion, con los flags en los 4 bits bajos
+    };
+
+    constexpr std::size_t   kHeaderBytes = sizeof(BlockHeader);
+    static_assert(kHeaderBytes == 64, "el encabezado debe ocupar 64 bytes");
+    static_assert(kHeaderBytes % alignof(std::max_align_t) == 0,
+                  "el puntero del usuario debe quedar alineado como el de malloc");
+
+    enum : std::uint64_t { kTracked = 1, kArray = 2, kFlagMask = 0xF };
+
+    inline BlockHeader* header_of(void* user) noexcept {
+        return reinterpret_cast<BlockHeader*>(static_cast<char*>(user) - kHeaderBytes);
+    }
+
+    // Asigna sz bytes con encabezado; align = 0 para la alineacion de malloc.
+    // Devuelve el puntero del usuario (nullptr si falla).
+    void* allocate(std::size_t sz, std::size_t align) noexcept;
+
+    // Completa el encabezado de un bloque recien asignado. tracked = false
+    // para bloques internos o con el profiler detenido.
+    void onAlloc(void* user, std::size_t sz, bool isArray, bool tracked) noexcept;
+
+    // Desenlaza (si estaba enlazado) y devuelve el bloque a malloc. Un
+    // puntero sin encabezado valido se pasa a free tal cual.
+    void release(void* user) noexcept;
+
+    // === Consultas (ProfilerAPI via Callbacks) ===
+    std::vector<BlockInfo> liveBlocks();
+    AggregateStats aggregateStats(std::size_t topCallsites);
+    std::size_t bytesInUse() noexcept;
+    std::size_t peakBytes() noexcept;   // subido en cada alloc (ver .cpp)
+    std::size_t allocCount() noexcept;
+
+    // Frees de punteros sin encabezado valido
+    std::uint64_t foreignFrees() noexcept;
+
+} // namespace header
+} // namespace mp
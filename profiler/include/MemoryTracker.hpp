@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <atomic>
 #include <mutex>
 #include <unordered_map>
 #include <vector>
@@ -9,6 +10,10 @@
 #include <thread>
 
 #include "OperatorOverrides.hpp" // Para usar el guard reentrante en APIs que asignen internamente
+#include "AggregateStats.hpp"
+#include "Callsite.hpp"
+#include "SpinLock.hpp"
+#include "ThreadRegistry.hpp"
 
 namespace mp {
 
@@ -16,12 +21,14 @@ namespace mp {
     struct AllocationRecord {
         void*        ptr;
         std::size_t  size;
-        const char*  type_name;      // puede ser nullptr
-        std::uint64_t timestamp_ns;
-        std::uint32_t thread_id;
-        const char*  file;           // puede ser nullptr
-        int          line;           // puede ser 0
+        std::uint64_t alloc_id;      // fijado al asignar (AllocId.hpp)
+        std::uint64_t timestamp;     // crudo de timestamps::now(); a ns con timestamps::Converter
+        std::uint32_t thread_id;     // id denso del registro de hilos (ThreadRegistry.hpp)
+        std::uint32_t callsite_id;   // file/line/tipo con callsite_descriptor (Callsite.hpp), 0 = sin callsite
         bool         is_array;
+        std::uint32_t section;       // seccion mas interna al asignar (Sections.hpp)
+        std::uint32_t pc_id;         // PC de quien llamo a new (CallerPc.hpp), 0 = sin capturar
+        std::uint32_t stack_id;      // pila completa (Stacks.hpp), 0 = sin capturar
     };
 
     class MemoryTracker {
@@ -29,23 +36,57 @@ namespace mp {
         static MemoryTracker& instance();
 
         // Registros
-        void onAlloc(void* p, std::size_t sz, const char* type,
-                     const char* file, int line, bool isArray);
+        // callsite: id de current_callsite_id() (0 = sin callsite)
+        void onAlloc(void* p, std::size_t sz, std::uint32_t callsite, bool isArray);
 
-        void onFree(void* p, bool isArray) noexcept;
+        // Registra un bloque con el registro ya armado (replay del
+        // arranque, BootRecorder.hpp)
+        void onAllocRecord(const AllocationRecord& rec);
+
+        // Devuelve true si el puntero estaba registrado
+        bool onFree(void* p, bool isArray) noexcept;
 
         // Snapshot de bloques vivos
         std::vector<AllocationRecord> snapshotLive() const;
 
+        // Agregados por callsite, hilo y tamaño (sin copiar bloques vivos)
+        AggregateStats aggregateStats(std::size_t topCallsites) const;
+
         // Métricas
         std::size_t activeBytes() const;
         std::size_t peakBytes() const;
         std::size_t totalAllocs() const;
         std::size_t activeAllocs() const;
 
-        // Por ahora no-op (dejado para pruebas futuras)
+        // true si hay algun registro vivo, en la tabla o en un buffer de
+        // recientes (no se registran bloques de 0 bytes); sin lock (para
+        // los hooks)
+        bool hasLive() const noexcept {
+            return in_use_.load(std::memory_order_relaxed) != 0;
+        }
+
+        // Borra tabla, metricas y agregados
         void resetForTesting();
 
+        // Lo que tenia el tracker al vaciarlo con drain()
+        struct Handoff {
+            std::uint64_t live_usable_bytes = 0; // suma de malloc_usable_size de los vivos
+            std::uint64_t live_count   = 0;
+            std::uint64_t total_allocs = 0;
+            std::uint64_t total_frees  = 0;
+            std::uint64_t total_bytes  = 0;
+            std::uint64_t peak         = 0;
+        };
+
+        // Vacia el tracker de forma atomica respecto a onAlloc/onFree
+        // (cambio de modo full -> counters). Con usableSize == nullptr se
+        // suma el tamaño pedido de cada registro.
+        Handoff drain(std::size_t (*usableSize)(void*));
+
+        // Bytes vivos que lleva otro modo de seguimiento; se suman al
+        // calcular el pico. nullptr para quitarla.
+        void setBaseline(std::size_t (*bytesFn)());
+
         // No copiable/movable
         MemoryTracker(const MemoryTracker&) = delete;
         MemoryTracker& operator=(const MemoryTracker&) = delete;
@@ -53,24 +94,159 @@ namespace mp {
         MemoryTracker& operator=(MemoryTracker&&) = delete;
 
     private:
+        // Callsite de los agregados: el descriptor si tiene archivo; si no,
+        // el PC de quien llamo a new. El nombre se arma al consultar.
+        struct SiteKey {
+            std::uint32_t callsite;
+            std::uint32_t pc_id;
+            bool operator==(const SiteKey& o) const noexcept {
+                return callsite == o.callsite && pc_id == o.pc_id;
+            }
+        };
+        struct SiteKeyHash {
+            std::size_t operator()(const SiteKey& k) const noexcept {
+                const std::uint64_t v = (std::uint64_t(k.callsite) << 32) | k.pc_id;
+                return static_cast<std::size_t>((v * 0x9E3779B97F4A7C15ull) >> 16);
+            }
+        };
+        static SiteKey siteOf(const AllocationRecord& r) noexcept {
+            const CallsiteDescriptor* d = callsite_descriptor(r.callsite_id);
+            return (d && d->file) ? SiteKey{r.callsite_id, 0} : SiteKey{0, r.pc_id};
+        }
+
+        // Buffer de asignaciones recientes, uno por hilo (id denso).
+        //
+        // onAlloc deja el registro en el buffer del hilo, sin tomar mu_; un
+        // free del mismo hilo que lo encuentra ahi lo cancela y solo toca
+        // contadores (hilo, seccion, totales del buffer) y el histograma de
+        // vida. Un registro pasa a la tabla cuando el hilo hace kRecentSlots
+        // asignaciones mas (su slot se reusa) o cuando una consulta vacia los
+        // buffers (flushRecent), asi que snapshots y metricas son exactos.
+        // El pico sale de in_use_, que cuenta tambien los bloques del
+        // buffer, y se sube en onAlloc.
+        //
+        // Un free que no esta en el buffer propio revisa los de otros hilos
+        // antes que la tabla. Para no tomar cada buffer, cada uno publica un
+        // filtro de direcciones (un bit por hash, kFilterBits): un bit en 0
+        // asegura que el puntero no esta. El dueño lo rehace cada
+        // kRecentSlots asignaciones con lo que queda en el anillo.
+        //
+        // Los cancelados suman al total_allocs de su callsite en una tabla
+        // chica por buffer (kSiteTally entradas, directa por hash) que pasa
+        // a by_site_ al vaciar el buffer, o antes si dos sitios chocan.
+        static constexpr std::size_t kRecentSlots = 32;
+        static constexpr std::size_t kFilterWords = 8;
+        static constexpr std::size_t kFilterBits  = kFilterWords * 64;
+        static constexpr std::size_t kSiteTally   = 16;
+
+        struct SiteTally {
+            SiteKey       site{0, 0};
+            std::uint64_t count = 0;       // 0 = entrada libre
+        };
+
+        // Lock: el dueño en cada op; flush y frees cruzados de otros
+        struct alignas(64) RecentBuffer : SpinLock {
+            std::uint32_t     next = 0;           // proximo slot (anillo)
+            void*             ptrs[kRecentSlots] = {};   // nullptr = libre
+            AllocationRecord  recs[kRecentSlots];
+            // Cancelados (con el lock tomado; se leen al consultar)
+            std::uint64_t     hits        = 0;
+            std::uint64_t     hit_bytes   = 0;
+            std::uint64_t     lifetime[kLifetimeBuckets] = {};
+            SiteTally         sites[kSiteTally];
+            // Filtro de direcciones: lo escribe el dueño (o quien vacia el
+            // buffer) con el lock tomado; se lee sin lock
+            alignas(64) std::atomic<std::uint64_t> filter[kFilterWords] = {};
+        };
+
+        static std::size_t filterBit(const void* p) noexcept {
+            const auto h = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(p) >> 4);
+            return static_cast<std::size_t>((h * 0x9E3779B97F4A7C15ull) >> 55); // 0..511
+        }
+        static bool mayHold(const RecentBuffer& b, const void* p) noexcept {
+            const std::size_t bit = filterBit(p);
+            return (b.filter[bit / 64].load(std::memory_order_acquire) >> (bit % 64)) & 1u;
+        }
+        // Rehace el filtro con los punteros del anillo (con b tomado)
+        static void rebuildFilterLocked(RecentBuffer& b) noexcept;
+
         MemoryTracker() = default;
         ~MemoryTracker() = default;
 
         // Helpers
         static std::uint64_t nowNs();
-        static std::uint32_t thisThreadId();
+
+        // Buffer del hilo (se crea la primera vez; nullptr sin id de hilo)
+        RecentBuffer* recentFor(std::uint32_t thread_id);
+        // Busca p en un buffer y lo cancela (con b tomado)
+        bool cancelRecentLocked(RecentBuffer& b, void* p, std::uint64_t now) noexcept;
+        // Pasa todos los buffers a la tabla (orden de locks: buffer, mu_) y
+        // devuelve lo cancelado en ellos, que se suma a los totales
+        struct RecentSums {
+            std::uint64_t hits  = 0;
+            std::uint64_t bytes = 0;
+            std::uint64_t lifetime[kLifetimeBuckets] = {};
+        };
+        RecentSums flushRecent() const;
+        void promoteRecentLocked(RecentBuffer& b, RecentSums& sums);
+        // Pasa las cuentas por callsite del buffer a by_site_ (con b y mu_ tomados)
+        void mergeSiteTallyLocked(SiteTally& t);
+        // Drain y reset: todos los buffers tomados a la vez (devuelve cuantos
+        // ids cubre) y, con eso y mu_, su contenido descartado
+        std::uint32_t lockRecent() noexcept;
+        void unlockRecent(std::uint32_t n) noexcept;
+        void dropRecentLocked(std::uint32_t n) noexcept;
+        // Quita p de la tabla si esta (toma mu_)
+        bool eraseFromTable(void* p, std::uint64_t now) noexcept;
+
+        // Requieren mu_ tomado. counted: hilo y seccion ya sumaron el bloque
+        // (viene de un buffer de recientes)
+        void insertLocked(const AllocationRecord& rec, bool counted);
+        void forgetLocked(const AllocationRecord& r) noexcept;
+        void clearLocked() noexcept;
+
+        // Suma sz a in_use_ y sube el pico (con el buffer del hilo o mu_
+        // tomado, para que drain no lo vea a medias)
+        void raisePeak(std::size_t sz) noexcept;
 
         mutable std::mutex mu_; // Protección para multithreading
 
         // MAPA PRINCIPAL: ptr → información completa
         std::unordered_map<void*, AllocationRecord> live_;
 
+        // AGREGADOS INCREMENTALES (se actualizan en onAlloc/onFree)
+        struct UsageCounters {
+            std::uint64_t live_bytes   = 0;
+            std::uint64_t live_count   = 0;
+            std::uint64_t total_allocs = 0;
+        };
+        std::unordered_map<SiteKey, UsageCounters, SiteKeyHash> by_site_;
+        // (por hilo: en el registro de hilos, indexado por id denso)
+        std::uint64_t hist_count_[kSizeHistogramBuckets] = {};
+        std::uint64_t hist_bytes_[kSizeHistogramBuckets] = {};
+
         // MÉTRICAS ACUMULADAS
         std::size_t total_allocs_  = 0; // Total de new ejecutados
         std::size_t active_allocs_ = 0; // new sin delete correspondiente
-        std::size_t total_bytes_   = 0; // (por ahora no se expone, pero se mantiene)
-        std::size_t active_bytes_  = 0; // Bytes en uso AHORA
-        std::size_t peak_bytes_    = 0; // Máximo histórico
+        std::size_t total_frees_   = 0; // delete de bloques registrados
+        std::size_t total_bytes_   = 0; // Bytes asignados historicos
+        std::size_t active_bytes_  = 0; // Bytes en uso AHORA (en la tabla)
+
+        // Bytes en uso contando los bloques de los buffers, y su maximo
+        // historico (con la base de setBaseline). Sin mu_: los hooks los
+        // tocan con el buffer del hilo tomado.
+        std::atomic<std::size_t> in_use_{0};
+        std::atomic<std::size_t> peak_bytes_{0};
+
+        std::atomic<std::size_t (*)()> baseline_fn_{nullptr}; // ver setBaseline
+
+        std::uint64_t lifetime_hist_[kLifetimeBuckets] = {}; // frees via tabla
+        std::uint64_t recent_promoted_ = 0;      // registros que llegaron desde un buffer
+
+        // Buffers por id de hilo; se crean al primer uso y no se liberan
+        // (un id reciclado hereda el buffer)
+        std::atomic<RecentBuffer*> recent_[threads::kMaxThreads] = {};
+        std::atomic<bool>          recent_used_{false};
     };
 
 } // namespace mp
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace mp {
+namespace mmaps {
+
+    // Regiones mmap anonimas vistas por libmp_preload.so (Preload.cpp).
+    //
+    // Van aparte de los contadores del heap: las politicas miden bloques de
+    // malloc (malloc_usable_size, tabla del tracker) y una region mapeada no
+    // es uno. Los mapeos de archivos no cuentan; tampoco los que hace libc
+    // por dentro (malloc grande, pilas de hilos), que no pasan por el simbolo
+    // mmap. Sin la .so todo queda en 0 y el SUMMARY no los muestra.
+
+    inline std::atomic<std::uint64_t> g_bytes{0};    // mapeados ahora
+    inline std::atomic<std::uint64_t> g_peak{0};
+    inline std::atomic<std::uint64_t> g_maps{0};     // llamadas a mmap contadas
+    inline std::atomic<std::uint64_t> g_unmaps{0};   // munmap que tocaron una region contada
+    inline std::atomic<std::uint64_t> g_regions{0};  // regiones vivas
+
+    inline void onMap(std::uint64_t len) noexcept {
+        const std::uint64_t now = g_bytes.fetch_add(len, std::memory_order_relaxed) + len;
+        std::uint64_t prev = g_peak.load(std::memory_order_relaxed);
+        while (now > prev && !g_peak.compare_exchange_weak(prev, now, std::memory_order_relaxed)) {}
+        g_maps.fetch_add(1, std::memory_order_relaxed);
+        g_regions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // len = bytes que se desmapearon; regions = regiones que desaparecieron
+    // (un munmap parcial puede partir una en dos: regions negativo)
+    inline void onUnmap(std::uint64_t len, std::int64_t regions) noexcept {
+        g_bytes.fetch_sub(len, std::memory_order_relaxed);
+        g_unmaps.fetch_add(1, std::memory_order_relaxed);
+        g_regions.fetch_sub(static_cast<std::uint64_t>(regions), std::memory_order_relaxed);
+    }
+
+    inline bool active() noexcept { return g_maps.load(std::memory_order_relaxed) != 0; }
+
+    // {"bytes":..,"peak":..,"maps":..,"unmaps":..,"regions":..}
+    inline std::string json() {
+        return "{\"bytes\":"   + std::to_string(g_bytes.load(std::memory_order_relaxed)) +
+               ",\"peak\":"    + std::to_string(g_peak.load(std::memory_order_relaxed)) +
+               ",\"maps\":"    + std::to_string(g_maps.load(std::memory_order_relaxed)) +
+               ",\"unmaps\":"  + std::to_string(g_unmaps.load(std::memory_order_relaxed)) +
+               ",\"regions\":" + std::to_string(g_regions.load(std::memory_order_relaxed)) + "}";
+    }
+
+} // namespace mmaps
+} // namespace mp
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mp {
+
+    // Un mapeo ejecutable de /proc/self/maps, con el build id del ELF que
+    // lo cubre. Alcanza para que mp_symbolize traduzca un PC crudo fuera
+    // del proceso: pc - start + offset es el offset dentro de path.
+    struct ModuleMapping {
+        std::uintptr_t start  = 0;
+        std::uintptr_t end    = 0;
+        std::uint64_t  offset = 0;      // offset en el archivo
+        std::string    path;
+        std::string    build_id;        // hex de NT_GNU_BUILD_ID ("" si no tiene)
+    };
+
+namespace modules {
+
+    // Mapeos ejecutables con archivo, en el orden de /proc/self/maps.
+    // Lee el archivo con stdio y los build ids de memoria
+    // (dl_iterate_phdr): no abre los ELF ni simboliza nada.
+    std::vector<ModuleMapping> snapshot();
+
+} // namespace modules
+} // namespace mp
@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mp {
+
+    // Observador de asignaciones (observers::add). Las funciones reciben
+    // ctx tal cual; corren dentro del hook, con in_hook activo: lo que
+    // asignen no se registra ni se les vuelve a notificar.
+    struct AllocObserver {
+        const char* name = "";   // literal; aparece en OBSERVERS
+        void (*onAlloc)(void* ctx, void* p, std::size_t sz, bool isArray) = nullptr;
+        // sz: el del sized delete, 0 si no se conoce
+        void (*onFree)(void* ctx, void* p, std::size_t sz, bool isArray) = nullptr;
+        void* ctx = nullptr;
+
+        // Filtros de asignaciones (los frees llegan todos: el tamaño no
+        // siempre se conoce y el observador sabe que bloques vio)
+        std::size_t   min_size     = 0;
+        std::size_t   max_size     = SIZE_MAX;
+        std::uint32_t sample_every = 1;   // 1 de cada N que pasan el filtro, por hilo
+    };
+
+    // Contadores de un observador (mensaje OBSERVERS)
+    struct ObserverUsage {
+        std::uint32_t id = 0;
+        std::string   name;
+        std::uint64_t allocs  = 0;   // llamadas a onAlloc
+        std::uint64_t frees   = 0;   // llamadas a onFree
+        std::uint64_t skipped = 0;   // asignaciones descartadas por el filtro
+        std::uint64_t ns      = 0;   // tiempo dentro del observador
+    };
+
+namespace observers {
+
+    // Lista de observadores que el hook notifica ademas de la politica.
+    //
+    // mp::Callbacks tiene un solo onAlloc/onFree (el backend); aqui se
+    // cuelgan los demas consumidores (muestreadores, trazas, presupuestos).
+    // La lista es inmutable y se publica con un puntero atomico: el hook la
+    // recorre dentro de un epoch::ReadGuard, sin locks, y add/remove
+    // publican una copia nueva y retiran la anterior. El tiempo de cada
+    // llamada se mide con el reloj de los registros (Timestamp.hpp); con
+    // la fuente "none" queda en 0.
+
+    constexpr std::uint32_t kMaxObservers = 16;
+
+    inline std::atomic<bool> g_any{false};
+
+    // true si hay algun observador; el hook lo consulta antes de notificar
+    inline bool any() noexcept { return g_any.load(std::memory_order_relaxed); }
+
+    // Agrega un observador; devuelve su id (>= 1), o 0 si la lista esta
+    // llena o no trae ninguna funcion
+    std::uint32_t add(const AllocObserver& o);
+
+    // Quita el observador. Al volver ningun hook sigue dentro de sus
+    // funciones, asi que ctx se puede liberar. No se debe llamar desde un
+    // observador (espera con epoch::synchronize).
+    bool remove(std::uint32_t id);
+
+    // Los llama el hook (profiler en marcha para las asignaciones; los
+    // frees tambien con el profiler detenido)
+    void notifyAlloc(void* p, std::size_t sz, bool isArray) noexcept;
+    void notifyFree(void* p, std::size_t sz, bool isArray) noexcept;
+
+    // Observadores activos con sus contadores, por id
+    std::vector<ObserverUsage> snapshot();
+
+} // namespace observers
+} // namespace mp
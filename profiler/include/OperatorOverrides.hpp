@@ -1,8 +1,28 @@
-#pragma once
-#include <cstddef>
-
-// Declaracion de las sobrecargas globales de new/delete
-void* operator new(std::size_t sz);
-void  operator delete(void* p) noexcept;
-void* operator new[](std::size_t sz);
-void  operator delete[](void* p) noexcept;
\ No newline at end of file
+#pragma once
+#include <cstddef>
+#include <new>
+
+// Declaracion de las sobrecargas globales de new/delete (todas las formas
+// reemplazables de C++17; las de colocacion no se reemplazan)
+void* operator new(std::size_t sz);
+void  operator delete(void* p) noexcept;
+void* operator new[](std::size_t sz);
+void  operator delete[](void* p) noexcept;
+void  operator delete(void* p, std::size_t sz) noexcept;
+void  operator delete[](void* p, std::size_t sz) noexcept;
+
+void* operator new(std::size_t sz, const std::nothrow_t&) noexcept;
+void* operator new[](std::size_t sz, const std::nothrow_t&) noexcept;
+void  operator delete(void* p, const std::nothrow_t&) noexcept;
+void  operator delete[](void* p, const std::nothrow_t&) noexcept;
+
+void* operator new(std::size_t sz, std::align_val_t al);
+void* operator new[](std::size_t sz, std::align_val_t al);
+void* operator new(std::size_t sz, std::align_val_t al, const std::nothrow_t&) noexcept;
+void* operator new[](std::size_t sz, std::align_val_t al, const std::nothrow_t&) noexcept;
+void  operator delete(void* p, std::align_val_t al) noexcept;
+void  operator delete[](void* p, std::align_val_t al) noexcept;
+void  operator delete(void* p, std::size_t sz, std::align_val_t al) noexcept;
+void  operator delete[](void* p, std::size_t sz, std::align_val_t al) noexcept;
+void  operator delete(void* p, std::align_val_t al, const std::nothrow_t&) noexcept;
+void  operator delete[](void* p, std::align_val_t al, const std::nothrow_t&) noexcept;
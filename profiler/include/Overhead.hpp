@@ -0,0 +1,164 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "Timestamp.hpp" // MP_HAVE_RDTSC
+
+#ifndef MP_SELF_PROFILE
+#define MP_SELF_PROFILE 0
+#endif
+
+#ifndef MP_SELF_PROFILE_SAMPLE
+#define MP_SELF_PROFILE_SAMPLE 64
+#endif
+
+namespace mp {
+
+    // Que se mide del propio profiler
+    enum class OverheadMetric : std::uint8_t {
+        HookAlloc,   // hook de new, sin el malloc
+        HookFree,    // hook de delete, sin el free
+        LockWait,    // esperando MemoryTracker::mu_
+        LockHold,    // con mu_ tomado
+        Snapshot,    // MemoryTracker::snapshotLive completo
+    };
+    constexpr std::size_t kOverheadMetrics = 5;
+    constexpr std::size_t kOverheadBuckets = 32; // bucket i: [2^i, 2^(i+1)) ticks
+
+    const char* overhead_metric_name(OverheadMetric m) noexcept;
+
+    struct OverheadCounters {
+        std::uint64_t count       = 0;
+        std::uint64_t total_ticks = 0;
+        std::uint64_t max_ticks   = 0;
+    };
+
+    // Contenido del mensaje PROFILER_OVERHEAD
+    struct OverheadSnapshot {
+        bool          enabled      = false;   // compilado con MP_SELF_PROFILE
+        std::uint32_t sample_every = 0;
+        bool          cycles       = false;   // ticks de rdtsc; si no, ns
+        double        ns_per_tick  = 1.0;
+        OverheadCounters total[kOverheadMetrics];
+        std::uint64_t    hist[kOverheadMetrics][kOverheadBuckets] = {};
+
+        struct Thread {
+            std::uint32_t    thread_id = 0;
+            OverheadCounters metrics[kOverheadMetrics];
+        };
+        std::vector<Thread> threads;   // solo los hilos con alguna medicion
+    };
+
+namespace overhead {
+
+    // Autoinstrumentacion del profiler (-DMP_SELF_PROFILE=ON).
+    //
+    // Los hooks de new/delete toman una muestra cada MP_SELF_PROFILE_SAMPLE
+    // llamadas por hilo y miden el trabajo del profiler en ticks de rdtsc
+    // (ns del reloj steady sin rdtsc). Dentro de un hook muestreado, y
+    // fuera de los hooks (consultas), tambien se mide la espera y la
+    // tenencia de MemoryTracker::mu_; snapshotLive se mide siempre. Cada
+    // hilo acumula en su propio histograma (id de ThreadRegistry) y la
+    // conversion a ns se hace al armar el snapshot.
+    //
+    // Sin MP_SELF_PROFILE los timers son estructuras vacias y TimedLock es
+    // std::lock_guard: no queda ni una instruccion en los hooks.
+
+    constexpr bool kEnabled = MP_SELF_PROFILE != 0;
+
+    // Histogramas por hilo sumados (enabled = false si no se compilo)
+    OverheadSnapshot snapshot();
+
+#if MP_SELF_PROFILE
+    inline std::uint64_t ticks() noexcept {
+#if MP_HAVE_RDTSC
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // 0 = fuera de un hook, 1 = en un hook sin muestrear, 2 = en uno muestreado
+    inline thread_local std::uint8_t  t_state = 0;
+    // Cuenta regresiva de new y de delete por separado: con una sola, un
+    // programa que alterna new/delete muestrearia siempre el mismo
+    inline thread_local std::uint32_t t_until_sample[2] = {1, 1};
+
+    void record(OverheadMetric m, std::uint64_t ticks) noexcept;
+
+    // Mide el hook si le toca la muestra; los hooks anidados (asignaciones
+    // del propio profiler) cuentan dentro del externo
+    class HookTimer {
+    public:
+        explicit HookTimer(OverheadMetric m) noexcept : m_(m) {
+            if (t_state) return;
+            owner_ = true;
+            std::uint32_t& until = t_until_sample[m == OverheadMetric::HookFree];
+            if (--until) { t_state = 1; return; }
+            until = MP_SELF_PROFILE_SAMPLE;
+            t_state = 2;
+            t0_ = ticks();
+        }
+        ~HookTimer() {
+            if (!owner_) return;
+            if (t_state == 2) record(m_, ticks() - t0_);
+            t_state = 0;
+        }
+        HookTimer(const HookTimer&) = delete;
+        HookTimer& operator=(const HookTimer&) = delete;
+
+    private:
+        OverheadMetric m_;
+        bool           owner_ = false;
+        std::uint64_t  t0_    = 0;
+    };
+
+    // lock_guard que registra espera y tenencia (salvo en hooks sin muestrear)
+    class TimedLock {
+    public:
+        explicit TimedLock(std::mutex& mu) noexcept : mu_(mu), timed_(t_state != 1) {
+            if (!timed_) { mu_.lock(); return; }
+            const std::uint64_t t0 = ticks();
+            mu_.lock();
+            locked_ = ticks();
+            record(OverheadMetric::LockWait, locked_ - t0);
+        }
+        ~TimedLock() {
+            const std::uint64_t held = timed_ ? ticks() - locked_ : 0;
+            mu_.unlock();
+            if (timed_) record(OverheadMetric::LockHold, held);
+        }
+        TimedLock(const TimedLock&) = delete;
+        TimedLock& operator=(const TimedLock&) = delete;
+
+    private:
+        std::mutex&   mu_;
+        bool          timed_;
+        std::uint64_t locked_ = 0;
+    };
+
+    // Mide el scope completo, sin muestreo
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(OverheadMetric m) noexcept : m_(m), t0_(ticks()) {}
+        ~ScopedTimer() { record(m_, ticks() - t0_); }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        OverheadMetric m_;
+        std::uint64_t  t0_;
+    };
+#else
+    struct HookTimer   { explicit HookTimer(OverheadMetric) noexcept {} };
+    struct ScopedTimer { explicit ScopedTimer(OverheadMetric) noexcept {} };
+    using TimedLock = std::lock_guard<std::mutex>;
+#endif
+
+} // namespace overhead
+} // namespace mp
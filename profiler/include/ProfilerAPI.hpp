@@ -1,27 +1,62 @@
 #pragma once
 #include <string>
+#include <cstddef>
 #include <cstdint>
 
 namespace mp {
 
+    // Con stop() no se registran bloques nuevos: en modo off/full el hook
+    // cuesta una rama. Los frees de bloques registrados antes se siguen
+    // descontando, y los contadores (counters/sampled) siguen exactos.
     void start();
     void stop();
     bool is_enabled();
 
+    // Modo de seguimiento en caliente ("off", "counters", "sampled", "full").
+    // Solo con MP_TRACKING_POLICY=Dynamic; si no, devuelve false y err.
+    bool set_tracking_mode(const std::string& mode, std::string* err = nullptr);
+    std::string current_tracking_mode();
+
+    // Reloj de los registros ("tsc", "steady", "coarse", "none"; ver
+    // Timestamp.hpp). Los bloques ya registrados siguen convirtiendose bien.
+    bool set_timestamp_source(const std::string& source, std::string* err = nullptr);
+    std::string current_timestamp_source();
+
     using SnapshotId = std::uint64_t;
     SnapshotId snapshot();
 
     // Reportes "puros"
-    std::string summary_json();       // JSON: bytes_in_use, peak, alloc_count
+    std::string summary_json();       // JSON: bytes_in_use, peak, alloc_count, compression
     std::string live_allocs_csv();    // CSV: para tests o exportar
+    std::string stats_json(std::size_t top_callsites = 10); // JSON: agregados (ver make_stats_json)
+    std::string sections_json();      // JSON: arbol de ScopedSection (ver make_sections_json)
+    std::string threads_json();       // JSON: registro de hilos (ver make_threads_json)
+    std::string observers_json();     // JSON: observadores y su tiempo (ver make_observers_json)
+    std::string overhead_json();      // JSON: costo del propio profiler (ver make_overhead_json)
 
     // Mensajes para GUI (todo JSON)
     std::string summary_message_json();      // {"type":"SUMMARY","payload":{...}}
     std::string live_allocs_message_json();  // {"type":"LIVE_ALLOCS","payload":{"blocks":[...]}}
+    // Igual; con type_table los tipos van por id en "types" (comando TYPES)
+    // y con since_id solo los bloques con alloc_id >= since_id
+    std::string live_allocs_message_json(bool type_table, std::uint64_t since_id = 0);
+    std::string stats_message_json(std::size_t top_callsites = 10); // {"type":"STATS","payload":{...}}
+    std::string sections_message_json();     // {"type":"SECTIONS","payload":{...}}
+    std::string threads_message_json();      // {"type":"THREADS","payload":{...}}
+    std::string observers_message_json();    // {"type":"OBSERVERS","payload":{...}}
+    std::string overhead_message_json();     // {"type":"PROFILER_OVERHEAD","payload":{...}}
+
+    // Nombre del hilo actual en THREADS y STATS (si no, el de
+    // pthread_getname_np). Se trunca a 31 caracteres.
+    void set_thread_name(const char* name);
 
+    // Atribuye a `name` (literal) lo que este hilo asigne mientras vive el
+    // objeto; las secciones se anidan (ver Sections.hpp)
     struct ScopedSection {
         explicit ScopedSection(const char* name);
         ~ScopedSection();
+        ScopedSection(const ScopedSection&) = delete;
+        ScopedSection& operator=(const ScopedSection&) = delete;
     };
 
     // ---- Compatibilidad con demo / SocketClient ----
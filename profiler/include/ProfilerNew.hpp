@@ -1,12 +1,27 @@
 // src/Library/include/ProfilerNew.hpp
 #pragma once
 #include "Callsite.hpp"
+#include <memory>
 #include <typeinfo>
+#include <utility>
+
+// Descriptor estatico de este punto del codigo para el tipo T (uno por
+// expansion). Inicializacion constante: no genera guard de static.
+#define MP_CALLSITE_DESCRIPTOR(T) \
+    ([]() noexcept -> ::mp::CallsiteDescriptor& { \
+        static ::mp::CallsiteDescriptor d{__FILE__, __LINE__, ::mp::type_name<T>(), sizeof(T)}; \
+        return d; \
+    }())
+
+// Marca la proxima asignacion del hilo con este callsite: un store en TLS
+// (mas el registro del id la primera vez). El hook de new lo descarta al
+// salir, registre o no el bloque.
+#define MP_TAG_CALLSITE(T) ::mp::setCallsiteId(::mp::callsite_id(MP_CALLSITE_DESCRIPTOR(T)))
 
 // Macro para crear un objeto con registro del callsite y tipo
 // Uso: MP_NEW_FT(MiClase, args...)
 // Esto registra el archivo, linea y nombre de tipo, luego hace new
-#define MP_NEW_FT(T, ...) ( mp::ScopedCallsite(__FILE__, __LINE__, typeid(T).name()), new T(__VA_ARGS__) )
+#define MP_NEW_FT(T, ...) ( MP_TAG_CALLSITE(T), new T(__VA_ARGS__) )
 
 // Macros para fijar manualmente el callsite y el nombre de tipo
 #define MP_SET_CALLSITE()   ::mp::setCallsite(__FILE__, __LINE__)
@@ -15,4 +30,21 @@
 // Macro para crear un arreglo con registro del callsite y tipo
 // Uso: MP_NEW_ARRAY_FT(T, count)
 // Esto registra el archivo, línea y nombre de tipo, luego hace new[]
-#define MP_NEW_ARRAY_FT(T, count) ( mp::ScopedCallsite(__FILE__, __LINE__, typeid(T).name()), new T[count] )
+#define MP_NEW_ARRAY_FT(T, count) ( MP_TAG_CALLSITE(T), new T[count] )
+
+// Igual que mp::make_tracked<T>, pero atribuido a esta linea
+// Uso: auto p = MP_MAKE_TRACKED(MiClase, args...);
+#define MP_MAKE_TRACKED(T, ...) ( MP_TAG_CALLSITE(T), std::unique_ptr<T>(new T(__VA_ARGS__)) )
+
+namespace mp {
+
+    // make_unique que atribuye el bloque al tipo T (un descriptor por tipo,
+    // sin archivo ni linea; para eso esta MP_MAKE_TRACKED)
+    template <class T, class... Args>
+    std::unique_ptr<T> make_tracked(Args&&... args) {
+        static CallsiteDescriptor d{nullptr, 0, type_name<T>(), sizeof(T)};
+        setCallsiteId(callsite_id(d));
+        return std::unique_ptr<T>(new T(std::forward<Args>(args)...));
+    }
+
+} // namespace mp
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mp {
+
+    // Contadores de una seccion
+    struct SectionCounters {
+        std::uint64_t live_bytes   = 0;
+        std::uint64_t live_count   = 0;
+        std::uint64_t total_allocs = 0;
+        std::uint64_t total_bytes  = 0;   // bytes asignados historicos
+    };
+
+    // Una seccion del arbol de ScopedSection. exclusive = bloques cuya
+    // seccion mas interna fue esta; inclusive = esta mas sus descendientes.
+    struct SectionUsage {
+        std::uint32_t   id     = 0;
+        std::uint32_t   parent = 0;      // la raiz es su propio padre
+        std::string     name;
+        SectionCounters exclusive;
+        SectionCounters inclusive;
+    };
+
+namespace sections {
+
+    // Secciones jerarquicas para atribuir memoria (mp::ScopedSection).
+    //
+    // Cada hilo tiene una pila de secciones; un nodo del arbol se identifica
+    // por (padre, nombre), asi que "worker/AllocStorm" y "main/AllocStorm"
+    // son nodos distintos. MemoryTracker guarda en cada registro la seccion
+    // mas interna al asignar y la descuenta al liberar, en el hilo que sea.
+    // Solo se atribuye lo que el tracker registra (modo full, o las muestras
+    // en sampled).
+
+    constexpr std::uint32_t kRoot        = 0;     // fuera de toda seccion
+    constexpr std::uint32_t kMaxSections = 4096;  // lleno: se atribuye al padre
+    constexpr std::uint32_t kMaxDepth    = 64;    // mas profundo: se queda en el nivel 64
+
+    // Entra a la seccion hija `name` de la actual. name debe vivir todo el
+    // programa (literal); el hilo cachea el id por direccion.
+    void enter(const char* name);
+    void leave() noexcept;
+
+    // Seccion mas interna del hilo (kRoot si no hay ninguna)
+    std::uint32_t current() noexcept;
+
+    // Los llama MemoryTracker con su lock tomado
+    void onAlloc(std::uint32_t id, std::size_t sz) noexcept;
+    void onFree(std::uint32_t id, std::size_t sz) noexcept;
+    void clearLive() noexcept;   // el tracker se vacio; los historicos quedan
+
+    // Todas las secciones indexadas por id (el padre siempre tiene id menor),
+    // con inclusive calculado. La primera es la raiz "(root)".
+    std::vector<SectionUsage> snapshot();
+
+} // namespace sections
+} // namespace mp
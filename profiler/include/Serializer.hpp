@@ -3,6 +3,13 @@
 #include <vector>
 #include <cstdint>
 #include "BlockInfo.hpp"
+#include "Compression.hpp"
+#include "AggregateStats.hpp"
+#include "Modules.hpp"
+#include "Observers.hpp"
+#include "Overhead.hpp"
+#include "Sections.hpp"
+#include "ThreadRegistry.hpp"
 namespace mp {
 
     // JSON plano: {"bytes_in_use":X,"peak":Y,"alloc_count":Z}
@@ -10,15 +17,83 @@ namespace mp {
                                   std::size_t peak,
                                   std::size_t alloc_count);
 
+    // Igual que el anterior, con campos extra ya serializados ("k":v,"k2":v2)
+    // agregados al final del objeto. extra_fields puede ser vacio.
+    std::string make_summary_json(std::size_t bytes_in_use,
+                                  std::size_t peak,
+                                  std::size_t alloc_count,
+                                  const std::string& extra_fields);
+
+    // Objeto JSON con las estadisticas de compresion de frames:
+    // {"frames":N,"raw_bytes":R,"compressed_bytes":C,"ratio":C/R,"cpu_ns":T,"ns_per_kb":X}
+    std::string make_compression_json(const CompressionStats& stats);
+
+    // JSON del mensaje STATS:
+    // {"t_ns":..,"bytes_in_use":..,"peak":..,"live_count":..,"total_allocs":..,
+    //  "total_frees":..,"total_bytes":..,"callsite_count":..,
+    //  "top_callsites":[{"callsite":..,"live_bytes":..,"live_count":..,"total_allocs":..}],
+    //  "threads":[{"thread_id":..,"name":..,"live_bytes":..,"live_count":..,"total_allocs":..}],
+    //  "size_histogram":[{"min":..,"count":..,"bytes":..}]}   (solo buckets no vacios)
+    std::string make_stats_json(const AggregateStats& stats);
+
+    // JSON del mensaje SECTIONS: arbol anidado desde la raiz
+    // {"t_ns":..,"section_count":N,"root":{"id":0,"name":"(root)",
+    //  "exclusive":{"live_bytes":..,"live_count":..,"total_allocs":..,"total_bytes":..},
+    //  "inclusive":{...},"children":[{...}]}}
+    // sections viene de sections::snapshot() (indexado por id)
+    std::string make_sections_json(const std::vector<SectionUsage>& sections, std::uint64_t t_ns);
+
+    // JSON del mensaje THREADS:
+    // {"t_ns":..,"thread_count":N,"threads":[{"id":..,"os_tid":..,"name":..,"alive":true,
+    //  "live_bytes":..,"peak_bytes":..,"live_count":..,"total_allocs":..,"total_frees":..,
+    //  "total_bytes":..}],"exited":{"threads":..,"peak_bytes":..,"total_allocs":..,
+    //  "total_frees":..,"total_bytes":..}}
+    std::string make_threads_json(const ThreadsSnapshot& threads, std::uint64_t t_ns);
+
+    // JSON del mensaje OBSERVERS:
+    // {"t_ns":..,"observer_count":N,"observers":[{"id":..,"name":..,"allocs":..,
+    //  "frees":..,"skipped":..,"ns":..,"ns_per_call":..}]}
+    std::string make_observers_json(const std::vector<ObserverUsage>& observers, std::uint64_t t_ns);
+
+    // JSON del mensaje PROFILER_OVERHEAD (tiempos en ns, histogramas en ticks):
+    // {"t_ns":..,"enabled":true,"sample_every":N,"unit":"cycles"|"ns","ns_per_tick":..,
+    //  "metrics":{"hook_alloc":{"count":..,"total_ns":..,"avg_ns":..,"max_ns":..,
+    //  "histogram":[{"min_ticks":..,"count":..}]},"hook_free":..,"lock_wait":..,
+    //  "lock_hold":..,"snapshot_live":..},
+    //  "threads":[{"thread_id":..,"hook_alloc":{"count":..,"total_ns":..,"max_ns":..},...}]}
+    // Sin MP_SELF_PROFILE: {"t_ns":..,"enabled":false}
+    std::string make_overhead_json(const OverheadSnapshot& overhead, std::uint64_t t_ns);
+
+    // Objeto "overhead" del SUMMARY: solo "metrics", sin histogramas
+    std::string make_overhead_summary_json(const OverheadSnapshot& overhead);
+
     // CSV plano (encabezado estable)
     // ptr,size,alloc_id,thread_id,t_ns,callsite
     std::string make_live_allocs_csv(const std::vector<BlockInfo>& blocks);
 
-    // JSON: {"blocks":[{...}, ...]}
+    // JSON: {"blocks":[{...}, ...],"stacks":[...]}
     std::string make_live_allocs_json(const std::vector<BlockInfo>& blocks);
 
+    // Igual, con los mapeos ejecutables del proceso para simbolizar fuera
+    // de linea: {...,"modules":[{"start","end","offset","path","build_id"}]}.
+    // Con type_table los bloques llevan "type_id" en vez de "type_name" y
+    // cada tipo usado aparece una vez en "types":[{"id","name"}].
+    // next_alloc_id (si no es 0) es la marca de alloc_ids::fence() tomada
+    // antes de copiar los bloques: pedir SNAPSHOT SINCE con ella trae solo
+    // lo asignado despues.
+    std::string make_live_allocs_json(const std::vector<BlockInfo>& blocks,
+                                      const std::vector<ModuleMapping>& modules,
+                                      bool type_table = false,
+                                      std::uint64_t next_alloc_id = 0);
+
     // Envoltura para GUI: {"type":"TYPE","payload":{...}}
     // payload_object_json DEBE ser un objeto JSON (sin comillas externas)
     std::string make_message_json(const char* type, const std::string& payload_object_json);
 
+    // Agrega sesion y numero de secuencia a un mensaje ya armado:
+    // {"session":"S","seq":N,"type":"TYPE","payload":{...}}
+    std::string make_sequenced_message_json(const std::string& message_json,
+                                            const std::string& session,
+                                            std::uint64_t seq);
+
 } // namespace mp
\ No newline at end of file
@@ -12,6 +12,33 @@ namespace mp {
      *   - Salida: frames JSON separados por salto de linea (metrics, snapshot)
      *   - Entrada: lineas de texto; si la linea == "SNAPSHOT", se envia snapshot JSON
      *
+     * Sesiones:
+     *   - Cada proceso tiene un id de sesion; los frames de datos llevan
+     *     "session" y un "seq" monotono, y se guardan en un replay buffer acotado
+     *   - Al conectar se envia {"type":"HELLO"} con la sesion y el ultimo seq
+     *   - "RESUME <session> <seq>" reenvia solo los frames con seq mayor; si la
+     *     sesion no coincide o el hueco ya no esta en el buffer se responde
+     *     RESYNC seguido de un snapshot completo
+     *
+     * Agregados:
+     *   - "STATS [top_n]" responde {"type":"STATS"} con metricas, los top_n
+     *     callsites por bytes vivos, uso por hilo e histograma de tamaños;
+     *     no copia los bloques vivos, asi que se puede pedir seguido
+     *   - "SECTIONS" responde {"type":"SECTIONS"} con el arbol de
+     *     mp::ScopedSection (bytes y conteos exclusivos e inclusivos)
+     *
+     * Modo de seguimiento:
+     *   - "MODE <off|counters|sampled|full>" cambia el backend en caliente
+     *     (ver mp::set_tracking_mode); responde {"type":"MODE"} con el modo
+     *     nuevo, el anterior y la version de la tabla, o ERROR
+     *
+     * Compresion:
+     *   - HELLO anuncia "codecs"; "COMPRESS <codec> [min_bytes]" la activa para
+     *     la conexion actual ("COMPRESS none" la apaga)
+     *   - Un frame de datos >= min_bytes se envia como una linea
+     *     {"type":"COMPRESSED","payload":{"codec":..,"raw":N,"size":M}} seguida
+     *     de M bytes binarios que descomprimen al frame original (con su '\n')
+     *
      * Hilos:
      *   - start() crea un hilo en segundo plano; stop() lo une al hilo principal
      */
@@ -41,6 +68,17 @@ namespace mp {
          */
         bool isRunning() const noexcept;
 
+        /**
+         * @brief Cambia el periodo del SUMMARY automatico (por defecto 200 ms).
+         *        Se puede llamar con el hilo corriendo; aplica desde el proximo envio.
+         */
+        void setMetricsIntervalMs(std::uint32_t ms);
+
+        /**
+         * @brief Id de la sesion que se anuncia en HELLO y en cada frame
+         */
+        std::string sessionId() const;
+
     private:
         class Impl; // implementacion interna (pimpl idiom)
         Impl* impl_; // puntero a la implementacion real
@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <thread>
+
+#include "Timestamp.hpp" // MP_HAVE_RDTSC (x86: _mm_pause de x86intrin.h)
+
+namespace mp {
+
+    // Pausa corta dentro de una espera activa
+    inline void cpu_relax() noexcept {
+#if MP_HAVE_RDTSC
+        _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        __asm__ __volatile__("yield");
+#endif
+    }
+
+    // Spinlock de los buffers por hilo (MemoryTracker, HeaderTracker). Casi
+    // siempre lo toma solo el dueño; si otro hilo lo retiene mucho (flush,
+    // hilo desalojado), tras kSpinsBeforeYield pausas se cede la CPU.
+    struct SpinLock {
+        static constexpr unsigned kSpinsBeforeYield = 64;
+
+        std::atomic<bool> locked{false};
+
+        void lock() noexcept {
+            while (locked.exchange(true, std::memory_order_acquire)) {
+                unsigned spins = 0;
+                while (locked.load(std::memory_order_relaxed)) {
+                    if (++spins < kSpinsBeforeYield) {
+                        cpu_relax();
+                    } else {
+                        std::this_thread::yield(); // sched_yield: no asigna
+                        spins = 0;
+                    }
+                }
+            }
+        }
+        void unlock() noexcept { locked.store(false, std::memory_order_release); }
+    };
+
+} // namespace mp
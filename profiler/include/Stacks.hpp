@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace mp {
+namespace stacks {
+
+    // Pilas completas de asignacion, deduplicadas.
+    //
+    // Con profundidad > 0, MemoryTracker captura la pila de cada bloque que
+    // registra (todos en full, las muestras en sampled) y guarda solo su id
+    // de 32 bits. La captura recorre frame pointers si el profiler se
+    // compilo con MP_FRAME_POINTERS, y si no usa _Unwind_Backtrace. Los
+    // frames del propio profiler se descartan: la pila empieza en quien
+    // llamo a operator new (g_caller_pc) cuando se conoce.
+    //
+    // La tabla es sin lock: cada pila distinta ocupa un slot, buscado por
+    // el hash de sus frames, y sus frames se copian una vez a un pool fijo.
+
+    constexpr std::uint32_t kMaxDepth  = 64;        // tope de set_max_depth
+    constexpr std::uint32_t kMaxStacks = 1u << 16;  // llena: id 0
+    constexpr std::uint32_t kPoolFrames = 1u << 20; // frames entre todas las pilas
+
+    // Profundidad maxima capturada (0 = sin captura). El valor inicial
+    // viene de MP_STACK_DEPTH en CMake.
+    void set_max_depth(std::uint32_t depth) noexcept;
+    std::uint32_t max_depth() noexcept;
+
+    // Captura la pila actual y devuelve su id (0 si la captura esta
+    // apagada, la pila quedo vacia o la tabla se lleno)
+    std::uint32_t capture(const void* caller) noexcept;
+
+    // Id de una pila ya capturada (frames[0] es el mas interno)
+    std::uint32_t intern(const std::uintptr_t* frames, std::uint32_t depth) noexcept;
+
+    // Frames de un id (vacio si el id es 0 o desconocido)
+    std::vector<std::uintptr_t> frames(std::uint32_t id);
+
+    // Cantidad de pilas distintas registradas
+    std::uint32_t count() noexcept;
+
+} // namespace stacks
+} // namespace mp
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mp {
+
+    // Contadores de un hilo (lo que asigno, lo libere quien lo libere)
+    struct ThreadCounters {
+        std::uint64_t live_bytes   = 0;
+        std::uint64_t peak_bytes   = 0;   // maximo de live_bytes
+        std::uint64_t live_count   = 0;
+        std::uint64_t total_allocs = 0;
+        std::uint64_t total_frees  = 0;
+        std::uint64_t total_bytes  = 0;   // bytes asignados historicos
+    };
+
+    // Un hilo del registro
+    struct ThreadInfo {
+        std::uint32_t  id     = 0;
+        std::uint64_t  os_tid = 0;        // gettid()
+        std::string    name;              // set_thread_name, o el del sistema
+        bool           alive  = true;
+        ThreadCounters counters;
+    };
+
+    // Contenido del mensaje THREADS
+    struct ThreadsSnapshot {
+        std::vector<ThreadInfo> threads;  // por id
+        std::uint64_t  exited_threads = 0; // terminados sin bloques vivos (slot reciclado)
+        ThreadCounters exited;            // sus totales acumulados
+    };
+
+namespace threads {
+
+    // Registro de hilos con ids densos.
+    //
+    // Un hilo recibe su id en la primera asignacion registrada (o al
+    // nombrarse) y lo cachea en TLS; 0 queda para "sin registrar" (tabla
+    // llena). Al terminar el hilo, un destructor de pthread_key lee su
+    // nombre final y, si no le quedan bloques vivos, vuelca sus totales en
+    // "exited" y libera el slot para otro hilo. Si le quedan, el slot sigue
+    // hasta el proximo reinicio (sus frees aun lo descuentan).
+
+    constexpr std::uint32_t kUnknown    = 0;
+    constexpr std::uint32_t kMaxThreads = 4096;   // llena: id 0
+    constexpr std::size_t   kMaxName    = 32;     // con el '\0'
+
+    inline thread_local std::uint32_t t_id = 0;
+
+    std::uint32_t register_current() noexcept;
+
+    // Id del hilo actual (lo registra la primera vez)
+    inline std::uint32_t current() noexcept {
+        const std::uint32_t id = t_id;
+        return id ? id : register_current();
+    }
+
+    // Slots usados hasta ahora (ids < slots_used()); no baja al reciclar
+    std::uint32_t slots_used() noexcept;
+
+    // Nombre del hilo actual (se trunca a kMaxName - 1)
+    void set_name(const char* name) noexcept;
+
+    // Los llama el tracker: onAlloc en el hilo dueño (el pico no es
+    // atomico), onFree en cualquiera
+    void onAlloc(std::uint32_t id, std::size_t sz) noexcept;
+    void onFree(std::uint32_t id, std::size_t sz) noexcept;
+    void clearLive() noexcept;   // el tracker se vacio; los historicos quedan
+
+    // Hilos registrados (vivos o terminados con bloques vivos)
+    ThreadsSnapshot snapshot();
+
+    // Suma de todos los hilos, incluidos los terminados (sin nombres ni
+    // /proc; peak_bytes es el mayor pico de un hilo)
+    ThreadCounters totals() noexcept;
+
+} // namespace threads
+} // namespace mp
@@ -0,0 +1,100 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MP_HAVE_RDTSC 1
+#else
+#define MP_HAVE_RDTSC 0
+#endif
+
+#ifndef MP_TIMESTAMP_SOURCE
+#define MP_TIMESTAMP_SOURCE 1   // TimestampSource::Tsc
+#endif
+
+namespace mp {
+
+    // Reloj de los registros de asignacion:
+    //   steady:  steady_clock::now() (llamada al vDSO)
+    //   tsc:     rdtsc, convertido a ns del reloj steady al serializar;
+    //            solo con TSC invariante, si no queda steady
+    //   coarse:  CLOCK_MONOTONIC_COARSE (resolucion de un tick del kernel)
+    //   none:    sin tiempo (t_ns = 0)
+    enum class TimestampSource : std::uint8_t { Steady, Tsc, Coarse, None };
+
+    const char* timestamp_source_name(TimestampSource s) noexcept;
+
+    // Acepta "steady", "tsc", "coarse" y "none"
+    bool timestamp_source_from_name(const std::string& name, TimestampSource& out) noexcept;
+
+namespace timestamps {
+
+    // El hook guarda un valor crudo y la conversion a ns se hace recien al
+    // armar un snapshot. Los crudos de rdtsc llevan kTscTag, asi que cambiar
+    // de fuente en caliente no rompe los registros anteriores.
+    constexpr std::uint64_t kTscTag = std::uint64_t(1) << 63;
+
+    inline std::atomic<std::uint8_t> g_source{MP_TIMESTAMP_SOURCE};
+
+    // Valor crudo para el registro que se esta armando
+    inline std::uint64_t now() noexcept {
+        switch (static_cast<TimestampSource>(g_source.load(std::memory_order_relaxed))) {
+#if MP_HAVE_RDTSC
+        case TimestampSource::Tsc:
+            return __rdtsc() | kTscTag;
+#endif
+        case TimestampSource::Coarse: {
+            timespec ts;
+            clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+            return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ull +
+                   static_cast<std::uint64_t>(ts.tv_nsec);
+        }
+        case TimestampSource::None:
+            return 0;
+        default:
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+    }
+
+    // ns entre dos crudos de la misma fuente (0 si alguno es 0 o cambio la
+    // fuente). Para rdtsc usa una frecuencia calibrada contra el ancla de
+    // carga, que se fija cuando pasaron 10 ms; antes se estima en cada llamada.
+    std::uint64_t elapsed_ns(std::uint64_t from, std::uint64_t to) noexcept;
+
+    // true si hay rdtsc y el CPU declara TSC invariante (cpuid 0x80000007)
+    bool tsc_invariant() noexcept;
+
+    // Fuente vigente
+    TimestampSource source() noexcept;
+
+    // Cambia la fuente. Tsc sin TSC invariante devuelve false (con err).
+    bool set_source(TimestampSource s, std::string* err = nullptr);
+
+    /**
+     * @brief Convierte crudos a ns del reloj steady.
+     *
+     * Se arma una vez por snapshot: la frecuencia del TSC sale de comparar
+     * el par (tsc, steady) tomado al elegir la fuente con uno tomado aqui,
+     * asi que la calibracion mejora mientras mas corre el proceso. Si han
+     * pasado menos de 10 ms espera lo que falte.
+     */
+    class Converter {
+    public:
+        Converter() noexcept;
+        std::uint64_t operator()(std::uint64_t raw) const noexcept;
+        // ns por tick de rdtsc (0 sin rdtsc)
+        double ns_per_tick() const noexcept { return ns_per_tick_; }
+
+    private:
+        std::uint64_t tsc0_ = 0;
+        std::uint64_t ns0_  = 0;
+        double        ns_per_tick_ = 0.0;
+    };
+
+} // namespace timestamps
+} // namespace mp
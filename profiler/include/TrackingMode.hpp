@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace mp {
+
+    // Modos de seguimiento que se pueden elegir en caliente con la politica
+    // Dynamic. Custom = alguien publico su propia tabla con register_callbacks.
+    // Header solo existe como politica de compilacion (MP_TRACKING_POLICY=Header):
+    // cambia como asigna el hook, no se puede activar en caliente.
+    enum class TrackingMode : std::uint8_t { Off, Counters, Sampled, Full, Custom, Header };
+
+    const char* tracking_mode_name(TrackingMode m) noexcept;
+
+    // Acepta "off", "counters", "sampled" y "full"
+    bool tracking_mode_from_name(const std::string& name, TrackingMode& out) noexcept;
+
+    // ["off","counters","sampled","full"] si se puede cambiar, o solo el modo fijo
+    std::string tracking_modes_json();
+
+    // Modo vigente (con politicas estaticas, el que fijo CMake)
+    TrackingMode tracking_mode() noexcept;
+
+    /**
+     * @brief Cambia el modo de seguimiento sin detener a los demas hilos.
+     *
+     * Publica una tabla de callbacks nueva; los hooks en curso terminan con
+     * la anterior, que se libera al final del periodo de gracia. Los
+     * contadores se migran:
+     *   - full -> counters/sampled: los bloques vivos del tracker pasan a los
+     *     contadores (en bytes utilizables) y el tracker se vacia
+     *   - counters/sampled -> full: el tracker arranca vacio y lo que llevan
+     *     los contadores queda como base que baja con cada free de un bloque
+     *     anterior al cambio
+     *   - off congela todo; al salir de off los frees ocurridos mientras
+     *     estaba apagado no se descuentan
+     *
+     * Solo un cambio a la vez; quien llama espera el periodo de gracia,
+     * no los demas hilos.
+     * @return false (con err) si la politica es estatica o el modo es Custom o Header
+     */
+    bool set_tracking_mode(TrackingMode m, std::string* err = nullptr);
+
+} // namespace mp
@@ -0,0 +1,397 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <malloc.h> // malloc_usable_size
+#include <type_traits>
+
+#include "BootRecorder.hpp"
+#include "Callbacks.hpp"
+#include "Callsite.hpp"
+#include "Epoch.hpp"
+#include "HeaderTracker.hpp"
+#include "MemoryTracker.hpp"
+#include "ReentryGuard.hpp"
+#include "ThreadRegistry.hpp"
+
+// Politicas de seguimiento para los hooks de new/delete.
+//
+// Los operadores globales son una plantilla sobre la politica activa, que se
+// elige al configurar con CMake (-DMP_TRACKING_POLICY=...):
+//   Dynamic  -> DynamicCallbacks: registro de Callbacks (std::function), por defecto
+//   None     -> NoTracking: el hook queda en malloc/free
+//   Counters -> CountersOnly: contadores atomicos, sin tabla de bloques
+//   Full     -> FullTracking: MemoryTracker directo, sin call_once ni std::function
+//   Sampled  -> Sampled: contadores exactos + MemoryTracker para 1 muestra
+//               cada MP_SAMPLE_BYTES bytes asignados por hilo
+//   Header   -> HeaderPrefix: metadata delante de cada bloque y listas por
+//               hilo (HeaderTracker.hpp), sin tabla global
+//
+// Cada politica expone:
+//   static void onAlloc(void* p, std::size_t sz, bool isArray);
+//   static void onFree(void* p, bool isArray) noexcept;
+//   static void onAllocStopped(void* p, std::size_t sz, bool isArray) noexcept;
+//   static void onFreeStopped(void* p, bool isArray) noexcept;
+//   static constexpr bool kHasCounters;  // true si ProfilerAPI debe leer Counters
+//   static constexpr bool kHeaderPrefix; // true si el hook asigna con header::allocate
+//
+// Las variantes *Stopped corren con el profiler detenido (mp::stop). Se
+// salta todo el trabajo por bloque (tracker, muestreo, callsite) pero los
+// frees de bloques registrados antes del stop se siguen descontando. Los
+// contadores no pueden distinguir bloques, asi que siguen contando: si no,
+// un bloque asignado durante el stop se restaria al liberarse despues.
+
+#ifndef MP_SAMPLE_BYTES
+#define MP_SAMPLE_BYTES (64 * 1024)
+#endif
+
+namespace mp {
+namespace policy {
+
+    // Interruptor de mp::start()/mp::stop(); lo lee cada hook
+    struct Enabled {
+        static inline std::atomic<bool> on{true};
+        static bool get() noexcept { return on.load(std::memory_order_relaxed); }
+    };
+
+    // Contadores del proceso. Se miden en bytes utilizables
+    // (malloc_usable_size) para que alloc y free resten exactamente lo mismo.
+    // Cuentan toda asignacion, incluida la del propio profiler, porque no
+    // hay tabla para distinguir en free lo que se conto en alloc.
+    //
+    // Cada hilo suma en su shard (id de ThreadRegistry), una linea de cache
+    // que solo el escribe: el hook no toca lineas compartidas. Los bytes en
+    // uso del shard pasan al total global cuando su saldo supera
+    // kFlushBytes. Cada alloc sube el pico con el global mas el saldo del
+    // propio shard; lo que falta son los saldos positivos aun sin volcar de
+    // los demas hilos, menos de kFlushBytes por hilo. Un shard no se vacia al terminar
+    // su hilo: el id reciclado sigue sumando sobre el, y un free en otro
+    // hilo resta en el shard de ese hilo (el saldo puede ser negativo).
+    // Contadores de un hilo (ver Counters)
+    struct alignas(64) CounterShard {
+        std::atomic<std::int64_t>  pending{0};     // bytes aun no volcados a in_use
+        std::atomic<std::uint64_t> allocs{0};
+        std::atomic<std::uint64_t> frees{0};
+        std::atomic<std::uint64_t> total_bytes{0};
+    };
+
+    struct Counters {
+        static constexpr std::int64_t kFlushBytes = 32 * 1024;
+
+        using Shard = CounterShard;
+        static inline Shard shards[threads::kMaxThreads];
+
+        // Globales: lo volcado por los shards y lo migrado por TrackingMode
+        static inline std::atomic<std::int64_t>  in_use{0};
+        static inline std::atomic<std::int64_t>  peak{0};
+        static inline std::atomic<std::uint64_t> allocs{0};
+        static inline std::atomic<std::uint64_t> frees{0};
+        static inline std::atomic<std::uint64_t> total_bytes{0};
+
+        static void raisePeak(std::int64_t now) noexcept {
+            std::int64_t prev = peak.load(std::memory_order_relaxed);
+            while (now > prev && !peak.compare_exchange_weak(prev, now, std::memory_order_relaxed)) {}
+        }
+
+        // Vuelca el saldo de un shard; exchange porque el shard 0 lo
+        // comparten los hilos sin id
+        static void flush(Shard& s) noexcept {
+            const std::int64_t v = s.pending.exchange(0, std::memory_order_relaxed);
+            const std::int64_t now = in_use.fetch_add(v, std::memory_order_relaxed) + v;
+            if (v > 0) raisePeak(now);
+        }
+
+        static void add(std::size_t usable) noexcept {
+            Shard& s = shards[threads::current()];
+            const auto sz = static_cast<std::int64_t>(usable);
+            s.allocs.fetch_add(1, std::memory_order_relaxed);
+            s.total_bytes.fetch_add(usable, std::memory_order_relaxed);
+            const std::int64_t pending = s.pending.fetch_add(sz, std::memory_order_relaxed) + sz;
+            if (pending >= kFlushBytes) flush(s);
+            else if (pending > 0) raisePeak(in_use.load(std::memory_order_relaxed) + pending);
+        }
+
+        static void sub(std::size_t usable) noexcept {
+            Shard& s = shards[threads::current()];
+            const auto sz = static_cast<std::int64_t>(usable);
+            s.frees.fetch_add(1, std::memory_order_relaxed);
+            if (s.pending.fetch_sub(sz, std::memory_order_relaxed) - sz <= -kFlushBytes) flush(s);
+        }
+
+        // Resta directo del global: el free de un bloque de la base que
+        // heredo el modo full (ver TrackingMode), fuera de los shards
+        static void subShared(std::size_t usable) noexcept {
+            in_use.fetch_sub(static_cast<std::int64_t>(usable), std::memory_order_relaxed);
+            frees.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Vuelca todos los shards (cambio de modo)
+        static void flushAll() noexcept {
+            const std::uint32_t n = threads::slots_used();
+            for (std::uint32_t i = 0; i < n; ++i) flush(shards[i]);
+        }
+
+        // Suma de globales y shards en un momento (sin congelar a los hilos)
+        struct Totals {
+            std::int64_t  in_use = 0;
+            std::uint64_t allocs = 0;
+            std::uint64_t frees = 0;
+            std::uint64_t total_bytes = 0;
+        };
+        static Totals totals() noexcept {
+            Totals t;
+            t.in_use      = in_use.load(std::memory_order_relaxed);
+            t.allocs      = allocs.load(std::memory_order_relaxed);
+            t.frees       = frees.load(std::memory_order_relaxed);
+            t.total_bytes = total_bytes.load(std::memory_order_relaxed);
+            const std::uint32_t n = threads::slots_used();
+            for (std::uint32_t i = 0; i < n; ++i) {
+                const Shard& s = shards[i];
+                t.in_use      += s.pending.load(std::memory_order_relaxed);
+                t.allocs      += s.allocs.load(std::memory_order_relaxed);
+                t.frees       += s.frees.load(std::memory_order_relaxed);
+                t.total_bytes += s.total_bytes.load(std::memory_order_relaxed);
+            }
+            return t;
+        }
+
+        static std::size_t bytesInUse() noexcept {
+            const std::int64_t v = totals().in_use;
+            return v > 0 ? static_cast<std::size_t>(v) : 0;
+        }
+        // Lo que se lee tambien cuenta para el pico
+        static std::size_t peakBytes() noexcept {
+            raisePeak(totals().in_use);
+            return static_cast<std::size_t>(peak.load(std::memory_order_relaxed));
+        }
+        static std::size_t allocCount() noexcept {
+            return static_cast<std::size_t>(totals().allocs);
+        }
+
+        // Sobrescribe los totales de un agregado del tracker
+        static void fillTotals(AggregateStats& s) noexcept {
+            const Totals t = totals();
+            raisePeak(t.in_use);
+            s.bytes_in_use = t.in_use > 0 ? static_cast<std::uint64_t>(t.in_use) : 0;
+            s.peak         = static_cast<std::uint64_t>(peak.load(std::memory_order_relaxed));
+            s.total_allocs = t.allocs;
+            s.total_frees  = t.frees;
+            s.total_bytes  = t.total_bytes;
+            s.live_count   = t.allocs >= t.frees ? t.allocs - t.frees : 0;
+        }
+    };
+
+    // Sin seguimiento: el hook es solo malloc/free
+    struct NoTracking {
+        static constexpr bool kHasCounters = false;
+        static constexpr bool kHeaderPrefix = false;
+        static void onAlloc(void*, std::size_t, bool) noexcept {}
+        static void onFree(void*, bool) noexcept {}
+        static void onAllocStopped(void*, std::size_t, bool) noexcept {}
+        static void onFreeStopped(void*, bool) noexcept {}
+    };
+
+    // Solo contadores: sin lock, sin tabla y sin callsite. El free no usa el
+    // tamaño del sized delete: glibc puede dar el chunk entero sin partirlo
+    // (malloc(564) deja 584 utilizables), asi que solo malloc_usable_size
+    // resta lo mismo que sumo el alloc.
+    struct CountersOnly {
+        static constexpr bool kHasCounters = true;
+        static constexpr bool kHeaderPrefix = false;
+        static void onAlloc(void* p, std::size_t, bool) noexcept {
+            Counters::add(malloc_usable_size(p));
+        }
+        static void onFree(void* p, bool) noexcept {
+            Counters::sub(malloc_usable_size(p));
+        }
+        static void onAllocStopped(void* p, std::size_t sz, bool isArray) noexcept { onAlloc(p, sz, isArray); }
+        static void onFreeStopped(void* p, bool isArray) noexcept { onFree(p, isArray); }
+    };
+
+    // Seguimiento completo llamando directo a MemoryTracker
+    struct FullTracking {
+        static constexpr bool kHasCounters = false;
+        static constexpr bool kHeaderPrefix = false;
+        static void onAlloc(void* p, std::size_t sz, bool isArray) {
+            if (in_hook) return;
+            in_hook = true;
+            MemoryTracker::instance().onAlloc(p, sz, current_callsite_id(), isArray);
+            clearCallsite();
+            in_hook = false;
+        }
+        static void onFree(void* p, bool isArray) noexcept {
+            if (in_hook) return;
+            in_hook = true;
+            MemoryTracker::instance().onFree(p, isArray);
+            in_hook = false;
+        }
+        static void onAllocStopped(void*, std::size_t, bool) noexcept {}
+        // Con el tracker vacio ni siquiera se toma su lock
+        static void onFreeStopped(void* p, bool isArray) noexcept {
+            if (MemoryTracker::instance().hasLive()) onFree(p, isArray);
+        }
+    };
+
+    // Muestreo por bytes: cada hilo registra en MemoryTracker la asignacion
+    // que cruza cada MP_SAMPLE_BYTES bytes. Los totales siguen exactos via
+    // Counters. En free, un filtro de Bloom con contadores descarta sin lock
+    // los punteros que seguro no fueron muestreados.
+    struct Sampled {
+        static constexpr bool kHasCounters = true;
+        static constexpr bool kHeaderPrefix = false;
+        static constexpr std::int64_t kSampleBytes = MP_SAMPLE_BYTES;
+        static constexpr std::size_t  kFilterSlots = std::size_t(1) << 16;
+
+        static inline thread_local std::int64_t until_sample = kSampleBytes;
+        static inline std::atomic<std::uint8_t> filter[kFilterSlots] = {};
+
+        static std::size_t slot(const void* p, unsigned k) noexcept {
+            std::uint64_t h = reinterpret_cast<std::uintptr_t>(p) >> 4;
+            h *= k ? 0xC2B2AE3D27D4EB4Full : 0x9E3779B97F4A7C15ull;
+            return static_cast<std::size_t>(h >> 48) & (kFilterSlots - 1);
+        }
+        // 255 queda fijo: un contador saturado ya no se puede decrementar
+        static void bump(std::size_t i, int delta) noexcept {
+            std::uint8_t v = filter[i].load(std::memory_order_relaxed);
+            while (v != 255 && !(delta < 0 && v == 0) &&
+                   !filter[i].compare_exchange_weak(v, static_cast<std::uint8_t>(v + delta),
+                                                    std::memory_order_relaxed)) {}
+        }
+        static void clearFilter() noexcept {
+            for (auto& f : filter) f.store(0, std::memory_order_relaxed);
+        }
+        static bool maybeSampled(const void* p) noexcept {
+            return filter[slot(p, 0)].load(std::memory_order_relaxed) != 0 &&
+                   filter[slot(p, 1)].load(std::memory_order_relaxed) != 0;
+        }
+
+        static void onAlloc(void* p, std::size_t sz, bool isArray) {
+            Counters::add(malloc_usable_size(p));
+            until_sample -= static_cast<std::int64_t>(sz);
+            if (until_sample > 0 || in_hook) return;
+            until_sample = kSampleBytes;
+
+            in_hook = true;
+            MemoryTracker::instance().onAlloc(p, sz, current_callsite_id(), isArray);
+            bump(slot(p, 0), 1);
+            bump(slot(p, 1), 1);
+            clearCallsite();
+            in_hook = false;
+        }
+
+        static void onFree(void* p, bool isArray) noexcept {
+            Counters::sub(malloc_usable_size(p));
+            if (in_hook || !maybeSampled(p)) return;
+            in_hook = true;
+            if (MemoryTracker::instance().onFree(p, isArray)) {
+                bump(slot(p, 0), -1);
+                bump(slot(p, 1), -1);
+            }
+            in_hook = false;
+        }
+
+        // Detenido: contadores exactos, sin tomar muestras nuevas
+        static void onAllocStopped(void* p, std::size_t, bool) noexcept {
+            Counters::add(malloc_usable_size(p));
+        }
+        static void onFreeStopped(void* p, bool isArray) noexcept { onFree(p, isArray); }
+    };
+
+    // Metadata en un encabezado delante del bloque: el hook asigna con
+    // header::allocate y libera con header::release, que desenlaza sin
+    // buscar en ninguna tabla. Los bloques internos (in_hook) y los de
+    // mp::stop() llevan encabezado pero quedan fuera de las listas.
+    struct HeaderPrefix {
+        static constexpr bool kHasCounters = false;
+        static constexpr bool kHeaderPrefix = true;
+        static void onAlloc(void* p, std::size_t sz, bool isArray) noexcept {
+            if (in_hook) { header::onAlloc(p, sz, isArray, false); return; }
+            in_hook = true;
+            header::onAlloc(p, sz, isArray, true);
+            clearCallsite();
+            in_hook = false;
+        }
+        static void onAllocStopped(void* p, std::size_t sz, bool isArray) noexcept {
+            header::onAlloc(p, sz, isArray, false);
+        }
+        // El trabajo de free esta en header::release (lo llama el hook)
+        static void onFree(void*, bool) noexcept {}
+        static void onFreeStopped(void*, bool) noexcept {}
+    };
+
+    // Registro dinamico (Callbacks): la tabla activa se lee con una carga
+    // atomica dentro de un epoch::ReadGuard, asi que se puede reemplazar en
+    // caliente (ver TrackingMode). Si la tabla trae rawAlloc/rawFree se usan
+    // directo; si no, se llama a los std::function como siempre. Antes de
+    // la primera tabla los eventos van al registro de arranque (BootRecorder).
+    struct DynamicCallbacks {
+        static constexpr bool kHasCounters = false;
+        static constexpr bool kHeaderPrefix = false;
+        static void onAlloc(void* p, std::size_t sz, bool isArray) {
+            epoch::ReadGuard rg;
+            const Callbacks* cb = active_callbacks();
+            if (!cb) { if (!in_hook) boot::recordAlloc(p, sz, isArray); return; }
+            if (cb->rawAlloc) { cb->rawAlloc(p, sz, isArray); return; }
+            if (in_hook) return;
+            in_hook = true;
+            const CallsiteInfo cs = currentCallsite();
+            cb->onAlloc(p, sz, cs.type_name, cs.file, cs.line, isArray);
+            clearCallsite();
+            in_hook = false;
+        }
+        static void onFree(void* p, bool isArray) noexcept {
+            epoch::ReadGuard rg;
+            const Callbacks* cb = active_callbacks();
+            if (!cb) { if (!in_hook) boot::recordFree(p); return; }
+            freeWith(*cb, p, isArray);
+        }
+        static void freeWith(const Callbacks& cb, void* p, bool isArray) noexcept {
+            if (cb.rawFree) { cb.rawFree(p, isArray); return; }
+            if (in_hook) return;
+            in_hook = true;
+            cb.onFree(p);
+            in_hook = false;
+        }
+
+        // Detenido: la tabla dice que necesita (rawAllocStopped/rawFreeStopped).
+        // Lo que no pide se descarta sin abrir el ReadGuard (ni su barrera).
+        // Una tabla sin ruta rapida recibe todo, como con el profiler en marcha.
+        static void onAllocStopped(void* p, std::size_t sz, bool isArray) {
+            if (!(callbacks_stopped_hooks() & kStoppedAllocs)) return;
+            epoch::ReadGuard rg;
+            const Callbacks* cb = active_callbacks();
+            if (!cb) return;
+            if (cb->rawAllocStopped) cb->rawAllocStopped(p, sz, isArray);
+            else if (!cb->rawAlloc)  onAlloc(p, sz, isArray);
+        }
+        static void onFreeStopped(void* p, bool isArray) noexcept {
+            if (!(callbacks_stopped_hooks() & kStoppedFrees)) return;
+            epoch::ReadGuard rg;
+            const Callbacks* cb = active_callbacks();
+            if (!cb) return;
+            if (cb->rawFreeStopped) cb->rawFreeStopped(p, isArray);
+            else if (!cb->rawFree)  onFree(p, isArray);
+        }
+    };
+
+} // namespace policy
+
+#if defined(MP_TRACKING_POLICY_NONE)
+    using ActivePolicy = policy::NoTracking;
+#elif defined(MP_TRACKING_POLICY_COUNTERS)
+    using ActivePolicy = policy::CountersOnly;
+#elif defined(MP_TRACKING_POLICY_FULL)
+    using ActivePolicy = policy::FullTracking;
+#elif defined(MP_TRACKING_POLICY_SAMPLED)
+    using ActivePolicy = policy::Sampled;
+#elif defined(MP_TRACKING_POLICY_HEADER)
+    using ActivePolicy = policy::HeaderPrefix;
+#else
+    using ActivePolicy = policy::DynamicCallbacks;
+#endif
+
+    // true si la politica permite cambiar de modo en caliente (TrackingMode)
+    constexpr bool kDynamicPolicy = std::is_same<ActivePolicy, policy::DynamicCallbacks>::value;
+
+} // namespace mp
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mp {
+namespace types {
+
+    // Registro de nombres de tipo.
+    //
+    // El hook solo guarda el puntero que trae el callsite (typeid(T).name(),
+    // o un nombre ya legible de type_name<T>()). Al armar un snapshot cada
+    // puntero se traduce a un id denso; cada nombre distinto se demanglea
+    // una sola vez (abi::__cxa_demangle) y queda en la tabla. Dos punteros
+    // con el mismo texto (un typeid por biblioteca) reciben el mismo id.
+
+    constexpr std::uint32_t kUnknown = 0;   // nullptr o "": "unknown"
+
+    // Id del nombre crudo; nunca desde el hook (toma un lock y asigna)
+    std::uint32_t intern(const char* raw);
+
+    // Nombre legible de un id ("unknown" si no existe)
+    std::string name(std::uint32_t id);
+
+    // Todos los nombres, indexados por id
+    std::vector<std::string> names();
+
+} // namespace types
+} // namespace mp
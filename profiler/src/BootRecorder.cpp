@@ -0,0 +1,196 @@
+#include "../include/BootRecorder.hpp"
+#include "../include/AllocId.hpp"
+#include "../include/CallerPc.hpp"
+#include "../include/Callsite.hpp"
+#include "../include/MemoryTracker.hpp"
+#include "../include/ReentryGuard.hpp"
+#include "../include/Sections.hpp"
+#include "../include/ThreadRegistry.hpp"
+#include "../include/Timestamp.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+namespace mp {
+namespace boot {
+
+namespace {
+
+  enum : std::uint8_t { kEmpty = 0, kAlloc = 1, kAllocArray = 2, kFree = 3 };
+
+  // Todo con inicializacion constante: se usa antes que cualquier
+  // constructor estatico. state se publica al final, con release.
+  struct Event {
+    std::atomic<std::uint8_t> state{kEmpty};
+    std::uint32_t line      = 0;
+    std::uint32_t callsite  = 0;       // g_callsite_id; si es 0, file/line/tipo
+    std::uint32_t thread_id = 0;
+    std::uint32_t section   = 0;
+    void*         ptr       = nullptr;
+    std::uint64_t size      = 0;
+    std::uint64_t alloc_id  = 0;
+    std::uint64_t timestamp = 0;
+    const void*   pc        = nullptr;
+    const char*   file      = nullptr;
+    const char*   type_name = nullptr;
+  };
+
+  Event g_events[kCapacity ? kCapacity : 1];   // MP_BOOT_EVENTS=0 lo apaga
+  std::atomic<std::size_t>   g_next{0};      // proxima entrada (puede pasar de kCapacity)
+  std::atomic<bool>          g_open{true};
+  std::atomic<std::uint64_t> g_dropped{0};
+
+  // Ordena la ultima pasada con los frees tardios (ver lateFree)
+  std::mutex g_late_mu;
+  bool       g_late_done = false;   // con g_late_mu
+
+  // Resumen, armado durante el replay (solo lo toca la instalacion)
+  Stats g_stats;
+  std::uint64_t g_first_ts = 0, g_last_ts = 0;
+
+  Event* claim() noexcept {
+    if (!g_open.load(std::memory_order_relaxed)) return nullptr;
+    const std::size_t i = g_next.fetch_add(1, std::memory_order_relaxed);
+    if (i >= kCapacity) {
+      g_dropped.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    return &g_events[i];
+  }
+
+  // Vivos del arranque: se recorre el buffer entero (kCapacity eventos como
+  // mucho, una vez por pasada de la instalacion)
+  void summarize_live(std::size_t end) {
+    std::unordered_map<void*, std::uint64_t> live;
+    for (std::size_t i = 0; i < end; ++i) {
+      const Event& e = g_events[i];
+      if (e.state.load(std::memory_order_relaxed) == kFree) live.erase(e.ptr);
+      else live[e.ptr] = e.size;
+    }
+    g_stats.live_count = live.size();
+    g_stats.live_bytes = 0;
+    for (const auto& kv : live) g_stats.live_bytes += kv.second;
+  }
+
+} // namespace
+
+void recordAlloc(void* p, std::size_t sz, bool isArray) noexcept {
+  Event* e = claim();
+  if (!e) return;
+  e->ptr       = p;
+  e->size      = sz;
+  e->alloc_id  = alloc_ids::next();
+  e->timestamp = timestamps::now();
+  e->thread_id = threads::current();
+  e->section   = sections::current();
+  e->pc        = g_caller_pc;
+  // Aqui no se puede asignar: un callsite sin descriptor se registra al
+  // pasar al tracker
+  e->callsite  = g_callsite_id;
+  e->file      = g_callsite.file;
+  e->line      = static_cast<std::uint32_t>(g_callsite.line);
+  e->type_name = g_callsite.type_name;
+  clearCallsite();
+  e->state.store(isArray ? kAllocArray : kAlloc, std::memory_order_release);
+}
+
+void recordFree(void* p) noexcept {
+  Event* e = claim();
+  if (!e) return;
+  e->ptr = p;
+  e->state.store(kFree, std::memory_order_release);
+}
+
+std::size_t replayInto(MemoryTracker& t, std::size_t from) {
+  ScopedHookGuard guard;
+  const std::size_t end = std::min(g_next.load(std::memory_order_acquire), kCapacity);
+  for (std::size_t i = from; i < end; ++i) {
+    Event& e = g_events[i];
+    // Una entrada reservada por un hook que todavia la esta llenando
+    std::uint8_t st;
+    while ((st = e.state.load(std::memory_order_acquire)) == kEmpty) {}
+
+    if (st == kFree) {
+      // El tracker la ignora si el bloque es de antes del buffer
+      t.onFree(e.ptr, false);
+      ++g_stats.frees;
+      continue;
+    }
+    AllocationRecord rec{};
+    rec.ptr       = e.ptr;
+    rec.size      = e.size;
+    rec.alloc_id  = e.alloc_id;
+    rec.timestamp = e.timestamp;
+    rec.thread_id = e.thread_id;
+    rec.callsite_id = e.callsite ? e.callsite
+                                 : callsite_id_of(CallsiteInfo{e.file, static_cast<int>(e.line), e.type_name});
+    rec.is_array  = st == kAllocArray;
+    rec.section   = e.section;
+    rec.pc_id     = pcs::intern(e.pc);
+    rec.stack_id  = 0; // la pila ya no existe
+    t.onAllocRecord(rec);
+
+    if (g_stats.allocs == 0) g_first_ts = e.timestamp;
+    g_last_ts = e.timestamp;
+    ++g_stats.allocs;
+    g_stats.bytes += e.size;
+  }
+  summarize_live(end);
+  return end;
+}
+
+void close() noexcept {
+  g_open.store(false, std::memory_order_relaxed);
+}
+
+void openLateFrees() noexcept {
+  detail::g_late_pending.store(true, std::memory_order_release);
+}
+
+void finishInto(MemoryTracker& t, std::size_t from) {
+  {
+    std::lock_guard<std::mutex> lock(g_late_mu);
+    replayInto(t, from);
+    g_late_done = true;
+  }
+  // release: quien lea false busca despues en un tracker que ya tiene todo
+  detail::g_late_pending.store(false, std::memory_order_release);
+  close();
+}
+
+bool lateFree(MemoryTracker& t, void* p) noexcept {
+  std::lock_guard<std::mutex> lock(g_late_mu);
+  if (g_late_done) return t.onFree(p, false); // la pasada ya aplico su alloc
+  recordFree(p);  // la pasada lo aplica despues del alloc (indice mayor)
+  return false;
+}
+
+Stats stats() noexcept {
+  Stats s = g_stats;
+  s.dropped = g_dropped.load(std::memory_order_relaxed);
+  if (g_last_ts > g_first_ts) {
+    const timestamps::Converter toNs;
+    s.span_ns = toNs(g_last_ts) - toNs(g_first_ts);
+  }
+  return s;
+}
+
+bool recorded() noexcept {
+  return g_next.load(std::memory_order_relaxed) != 0;
+}
+
+std::string stats_json() {
+  const Stats s = stats();
+  return "{\"allocs\":"      + std::to_string(s.allocs) +
+         ",\"frees\":"       + std::to_string(s.frees) +
+         ",\"bytes\":"       + std::to_string(s.bytes) +
+         ",\"live_bytes\":"  + std::to_string(s.live_bytes) +
+         ",\"live_count\":"  + std::to_string(s.live_count) +
+         ",\"dropped\":"     + std::to_string(s.dropped) +
+         ",\"span_ns\":"     + std::to_string(s.span_ns) + "}";
+}
+
+} // namespace boot
+} // namespace mp
@@ -1,49 +1,102 @@
 #include "../include/Callbacks.hpp"
+#include "../include/Epoch.hpp"
+#include "../include/ReentryGuard.hpp"
+#include <atomic>
 #include <mutex>
 
 namespace mp {
 
-  // Variable global estatica que guarda los callbacks registrados
-  static Callbacks g_cb;
+  // Tabla activa, publicada con release y leida con acquire. Es un puntero
+  // con inicializacion constante: vale nullptr aunque operator new corra
+  // durante la inicializacion estatica de otra unidad.
+  static std::atomic<const Callbacks*> g_active{nullptr};
 
-  // Bandera usada para asegurar que la inicializacion solo ocurre una vez
-  static std::once_flag g_init_once;
+  // Numero de version de la ultima tabla publicada
+  static std::atomic<std::uint32_t> g_version{0};
 
-  // Funcion que inicializa todos los callbacks con funciones vacias (no hacen nada)
-  static void init_noop() {
-    g_cb.onAlloc    = [](void*, std::size_t, const char*, const char*, int, bool){}; // No hace nada al asignar memoria
-    g_cb.onFree     = [](void*){};                                  // No hace nada al liberar memoria
-    g_cb.bytesInUse = []{ return std::size_t(0); };                 // Siempre retorna 0
-    g_cb.peakBytes  = []{ return std::size_t(0); };                 // Siempre retorna 0
-    g_cb.allocCount = []{ return std::size_t(0); };                 // Siempre retorna 0
-    g_cb.snapshot   = []{ return std::uint64_t(0); };               // Siempre retorna 0
-    g_cb.liveBlocks = []{ return std::vector<BlockInfo>{}; };       // Siempre retorna un vector vacio
+  // Bits kStopped* de la tabla activa (ver callbacks_stopped_hooks)
+  static std::atomic<std::uint8_t> g_stopped_hooks{0};
+
+  // Serializa a los escritores (register_callbacks concurrentes)
+  static std::mutex& publish_mutex() {
+    static std::mutex m;
+    return m;
+  }
+
+  // Tabla con funciones vacias (no hacen nada), para cuando nadie registro
+  static const Callbacks& noop_callbacks() {
+    static const Callbacks* cb = [] {
+      ScopedHookGuard guard;
+      Callbacks* c = new Callbacks();
+      c->onAlloc    = [](void*, std::size_t, const char*, const char*, int, bool){}; // No hace nada al asignar memoria
+      c->onFree     = [](void*){};                                  // No hace nada al liberar memoria
+      c->bytesInUse = []{ return std::size_t(0); };                 // Siempre retorna 0
+      c->peakBytes  = []{ return std::size_t(0); };                 // Siempre retorna 0
+      c->allocCount = []{ return std::size_t(0); };                 // Siempre retorna 0
+      c->snapshot   = []{ return std::uint64_t(0); };               // Siempre retorna 0
+      c->liveBlocks = []{ return std::vector<BlockInfo>{}; };       // Siempre retorna un vector vacio
+      c->aggregate  = [](std::size_t){ return AggregateStats{}; };  // Siempre retorna agregados vacios
+      c->version    = 0;
+      return c;
+    }();
+    return *cb;
+  }
+
+  static void delete_callbacks(void* p) {
+    ScopedHookGuard guard;
+    delete static_cast<Callbacks*>(p);
   }
 
   // Funcion para registrar nuevos callbacks desde afuera
   // Si algun callback no es proporcionado, se reemplaza por uno vacio
   void register_callbacks(const Callbacks& c) {
-    // Se asegura que init_noop solo se ejecute una vez en todo el programa
-    std::call_once(g_init_once, init_noop);
+    const Callbacks* old = nullptr;
+    {
+      // La copia (y sus std::function) no deben registrarse a si mismas
+      ScopedHookGuard guard;
+      Callbacks* t = new Callbacks(c);
 
-    // Guardamos los callbacks proporcionados por el usuario
-    g_cb = c;
+      // Si alguno de los callbacks no fue asignado, se reemplaza con version vacia
+      if (!t->onAlloc)    t->onAlloc = [](void*, std::size_t, const char*, const char*, int, bool){};
+      if (!t->onFree)     t->onFree     = [](void*){};
+      if (!t->bytesInUse) t->bytesInUse = []{ return std::size_t(0); };
+      if (!t->peakBytes)  t->peakBytes  = []{ return std::size_t(0); };
+      if (!t->allocCount) t->allocCount = []{ return std::size_t(0); };
+      if (!t->snapshot)   t->snapshot   = []{ return std::uint64_t(0); };
+      if (!t->liveBlocks) t->liveBlocks = []{ return std::vector<BlockInfo>{}; };
+      if (!t->aggregate)  t->aggregate  = [](std::size_t){ return AggregateStats{}; };
 
-    // Si alguno de los callbacks no fue asignado, se reemplaza con version vacia
-    if (!g_cb.onAlloc)    g_cb.onAlloc = [](void*, std::size_t, const char*, const char*, int, bool){};
-    if (!g_cb.onFree)     g_cb.onFree     = [](void*){};
-    if (!g_cb.bytesInUse) g_cb.bytesInUse = []{ return std::size_t(0); };
-    if (!g_cb.peakBytes)  g_cb.peakBytes  = []{ return std::size_t(0); };
-    if (!g_cb.allocCount) g_cb.allocCount = []{ return std::size_t(0); };
-    if (!g_cb.snapshot)   g_cb.snapshot   = []{ return std::uint64_t(0); };
-    if (!g_cb.liveBlocks) g_cb.liveBlocks = []{ return std::vector<BlockInfo>{}; };
+      std::lock_guard<std::mutex> lock(publish_mutex());
+      t->version = g_version.fetch_add(1, std::memory_order_relaxed) + 1;
+      g_stopped_hooks.store(static_cast<std::uint8_t>(
+          ((t->rawAllocStopped || !t->rawAlloc) ? kStoppedAllocs : 0) |
+          ((t->rawFreeStopped  || !t->rawFree)  ? kStoppedFrees  : 0)), std::memory_order_relaxed);
+      // Desde aqui la tabla es inmutable
+      old = g_active.exchange(t, std::memory_order_seq_cst);
+    }
+    // Los hooks que todavia leen la tabla anterior la mantienen viva
+    epoch::retire(const_cast<Callbacks*>(old), &delete_callbacks);
   }
 
   // Funcion para obtener los callbacks actuales
   // Siempre asegura que al menos existan callbacks vacios
   const Callbacks& get_callbacks() {
-    std::call_once(g_init_once, init_noop);
-    return g_cb;
+    const Callbacks* t = g_active.load(std::memory_order_acquire);
+    return t ? *t : noop_callbacks();
+  }
+
+  const Callbacks* active_callbacks() noexcept {
+    return g_active.load(std::memory_order_acquire);
+  }
+
+  std::uint8_t callbacks_stopped_hooks() noexcept {
+    return g_stopped_hooks.load(std::memory_order_relaxed);
+  }
+
+  std::uint32_t callbacks_version() noexcept {
+    epoch::ReadGuard rg;
+    const Callbacks* t = g_active.load(std::memory_order_acquire);
+    return t ? t->version : 0;
   }
 
-} // namespace mp
\ No newline at end of file
+} // namespace mp
@@ -1,29 +1,35 @@
 #include "../include/Callbacks.hpp"
 #include "../include/MemoryTracker.hpp"
 #include "../include/BlockInfo.hpp"
+#include "../include/BootRecorder.hpp"
+#include "../include/CallerPc.hpp"
+#include "../include/Epoch.hpp"
 #include "../include/Callsite.hpp"
+#include "../include/HeaderTracker.hpp"
 #include "../include/ReentryGuard.hpp"
+#include "../include/TrackingPolicies.hpp"
+#include "../include/Timestamp.hpp"
+#include "../include/TrackingMode.hpp"
+#include "../include/TypeRegistry.hpp"
+#include "../include/CallbacksRegistration.hpp"
 #include <atomic>
 #include <vector>
 #include <string>
 
 namespace mp {
 
-// Contador global atomico para asignaciones de memoria
-static std::atomic<std::uint64_t> g_alloc_id{0};
-
 // Contador global atomico para snapshots (capturas de estado)
 static std::atomic<std::uint64_t> g_snapshot_id{0};
 
-// Esta funcion instala callbacks que usan el sistema MemoryTracker
-// De esta forma, cada vez que se asigna o libera memoria, se registran los datos
-void install_callbacks_with_memorytracker() {
+// Arma la tabla de callbacks sobre MemoryTracker (sin publicarla)
+Callbacks make_memorytracker_callbacks() {
     mp::Callbacks cb{}; // Se crea un objeto Callbacks vacio
 
-    // Callback que se llama cada vez que se asigna memoria
+    // Callback que se llama cada vez que se asigna memoria (el registro
+    // guarda el id del callsite, no los punteros)
     cb.onAlloc = [](void* p, std::size_t sz, const char* type, const char* file, int line, bool is_array) {
-        mp::MemoryTracker::instance().onAlloc(p, sz, type, file, line, is_array);
-        (void)g_alloc_id.fetch_add(1, std::memory_order_relaxed);
+        const std::uint32_t callsite = mp::callsite_id_of(mp::CallsiteInfo{file, line, type});
+        mp::MemoryTracker::instance().onAlloc(p, sz, callsite, is_array);
         mp::clearCallsite();
     };
 
@@ -51,7 +57,11 @@ void install_callbacks_with_memorytracker() {
         mp::ScopedHookGuard guard;
 
         std::vector<BlockInfo> out; // Vector de resultados
+        std::uint32_t last_callsite = 0;            // ultimo callsite traducido
+        const mp::CallsiteDescriptor* d = nullptr;  // su descriptor
+        std::uint32_t last_type = mp::types::kUnknown;
         auto recs = mp::MemoryTracker::instance().snapshotLive(); // Obtenemos los bloques vivos
+        const mp::timestamps::Converter toNs; // calibra el TSC una vez por snapshot
         out.reserve(recs.size());
 
         // Convertimos cada registro del tracker en un BlockInfo
@@ -59,26 +69,36 @@ void install_callbacks_with_memorytracker() {
             BlockInfo b{};
             b.ptr       = r.ptr;                              // Direccion de memoria
             b.size      = r.size;                             // Tamaño en bytes
-            b.alloc_id  = g_alloc_id.fetch_add(1, std::memory_order_relaxed); // ID unico
+            b.alloc_id  = r.alloc_id;                         // Fijado al asignar
             b.thread_id = r.thread_id;                        // Hilo que hizo la asignacion
-            b.t_ns      = r.timestamp_ns;                     // Tiempo en nanosegundos
+            b.t_ns      = toNs(r.timestamp);                  // Crudo del hook a ns (steady)
+            b.pc        = mp::pcs::address(r.pc_id);          // Quien llamo a new (0 si no se capturo)
+            b.stack_id  = r.stack_id;                         // Pila completa (0 si no se capturo)
+
+            // Archivo, linea y tipo salen del descriptor del callsite; los
+            // bloques seguidos suelen compartirlo
+            if (r.callsite_id != last_callsite) {
+                last_callsite = r.callsite_id;
+                d = mp::callsite_descriptor(r.callsite_id);
+                last_type = mp::types::intern(d ? d->type_name : nullptr);
+            }
 
             // Si tenemos información de archivo y línea, la guardamos
-            if (r.file && *r.file) {
-                b.file = std::string(r.file);
-                b.line = r.line;
-                b.callsite = std::string(r.file) + ":" + std::to_string(r.line);
+            if (d && d->file && *d->file) {
+                b.file = std::string(d->file);
+                b.line = d->line;
+                b.callsite = b.file + ":" + std::to_string(d->line);
             } else {
                 b.file = "?";
                 b.line = 0;
-                b.callsite = "?:0"; // Si no hay información, se pone un valor por defecto
+                // Sin archivo: el PC de quien llamo a new, resuelto recien aqui
+                // ("?:0" si no se capturo)
+                b.callsite = mp::pcs::symbolize(r.pc_id);
             }
 
-            if (r.type_name && *r.type_name) {
-                b.type_name = std::string(r.type_name);
-            } else {
-                b.type_name = "unknown";
-            }
+            // Tipo por id: el nombre se demanglea una vez en el registro y
+            // no se copia a cada bloque
+            b.type_id = last_type;
 
             // Agregamos el bloque a la lista
             out.push_back(std::move(b));
@@ -86,6 +106,70 @@ void install_callbacks_with_memorytracker() {
         return out;
     };
 
+    // Callback que devuelve los agregados (top callsites, hilos, histograma)
+    cb.aggregate = [](std::size_t topCallsites) {
+        return mp::MemoryTracker::instance().aggregateStats(topCallsites);
+    };
+
+    return cb;
+}
+
+// Con la politica Header el hook no pasa por la tabla: solo se usan las
+// consultas, que leen las listas de encabezados
+Callbacks make_header_callbacks() {
+    mp::Callbacks cb{};
+    cb.onAlloc    = [](void*, std::size_t, const char*, const char*, int, bool) {};
+    cb.onFree     = [](void*) {};
+    cb.bytesInUse = [] { return mp::header::bytesInUse(); };
+    cb.peakBytes  = [] { return mp::header::peakBytes();  };
+    cb.allocCount = [] { return mp::header::allocCount(); };
+    cb.snapshot   = [] { return g_snapshot_id.fetch_add(1, std::memory_order_relaxed); };
+    cb.liveBlocks = [] { return mp::header::liveBlocks(); };
+    cb.aggregate  = [](std::size_t topCallsites) { return mp::header::aggregateStats(topCallsites); };
+    return cb;
+}
+
+// Esta funcion instala callbacks que usan el sistema MemoryTracker
+// De esta forma, cada vez que se asigna o libera memoria, se registran los datos
+void install_callbacks_with_memorytracker() {
+    // Politica dinamica: modo full, cambiable luego con set_tracking_mode.
+    // Lo anotado antes de la primera tabla (inicializacion estatica, carga
+    // de bibliotecas) pasa al tracker en dos tandas: lo anterior a publicar
+    // y, cuando ningun hook ve ya la tabla vacia, lo que llego mientras tanto
+    // (con los frees que el tracker no conocia, ver boot::lateFree).
+    if constexpr (mp::kDynamicPolicy) {
+        const bool first = mp::active_callbacks() == nullptr;
+        MemoryTracker& t = mp::MemoryTracker::instance();
+        std::size_t next = first ? mp::boot::replayInto(t, 0) : 0;
+        if (first) mp::boot::openLateFrees();
+        mp::set_tracking_mode(TrackingMode::Full);
+        if (first) {
+            mp::epoch::synchronize();
+            mp::boot::finishInto(t, next);
+        }
+        return;
+    }
+
+    if constexpr (mp::ActivePolicy::kHeaderPrefix) {
+        mp::register_callbacks(make_header_callbacks());
+        return;
+    }
+
+    mp::Callbacks cb = make_memorytracker_callbacks();
+
+    // Con politicas de contadores (Counters, Sampled) el tracker no ve todas
+    // las asignaciones: los totales salen de policy::Counters
+    if constexpr (mp::ActivePolicy::kHasCounters) {
+        cb.bytesInUse = [] { return mp::policy::Counters::bytesInUse(); };
+        cb.peakBytes  = [] { return mp::policy::Counters::peakBytes();  };
+        cb.allocCount = [] { return mp::policy::Counters::allocCount(); };
+        cb.aggregate  = [](std::size_t topCallsites) {
+            auto s = mp::MemoryTracker::instance().aggregateStats(topCallsites);
+            mp::policy::Counters::fillTotals(s);
+            return s;
+        };
+    }
+
     // Finalmente registramos todos los callbacks en el sistema
     mp::register_callbacks(cb);
 }
@@ -0,0 +1,154 @@
+#include "../include/CallerPc.hpp"
+#include "../include/ReentryGuard.hpp"
+#include "../include/SpinLock.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+
+#ifndef MP_ONLINE_SYMBOLIZATION
+#define MP_ONLINE_SYMBOLIZATION 1
+#endif
+
+namespace mp {
+namespace pcs {
+
+namespace {
+
+  std::atomic<bool> g_online{MP_ONLINE_SYMBOLIZATION != 0};
+
+  // Tabla hash PC -> id. Un slot toma su PC con CAS (0 = libre) y despues
+  // publica el id; nunca se borra. g_by_id es el camino inverso: la
+  // entrada id - 1 guarda el PC del id. Los ids salen de g_count, asi que
+  // son densos: 1..count().
+  struct Slot {
+    std::atomic<std::uintptr_t> pc{0};
+    std::atomic<std::uint32_t>  id{0};     // 0 = aun no publicado
+  };
+  Slot g_slots[kMaxPcs];
+  std::atomic<std::uintptr_t> g_by_id[kMaxPcs];
+  std::atomic<std::uint32_t> g_count{0};
+  std::atomic<std::uint64_t> g_misses{0};
+
+  constexpr std::uint32_t kMaxProbes = 64;   // mas lejos: se considera llena
+
+  // El hilo que gano el slot publica el id enseguida; si lo desalojaron
+  // entre el CAS y la publicacion, se cede la CPU
+  std::uint32_t waitId(const Slot& s) noexcept {
+    unsigned spins = 0;
+    std::uint32_t id;
+    while ((id = s.id.load(std::memory_order_acquire)) == 0) {
+      if (++spins < SpinLock::kSpinsBeforeYield) cpu_relax();
+      else { std::this_thread::yield(); spins = 0; }
+    }
+    return id;
+  }
+
+  inline std::uint32_t home(std::uintptr_t pc) noexcept {
+    const std::uint64_t h = static_cast<std::uint64_t>(pc) * 0x9E3779B97F4A7C15ull;
+    return static_cast<std::uint32_t>(h >> 48) & (kMaxPcs - 1);
+  }
+
+  // id -> nombre ya resuelto
+  struct Names {
+    std::mutex mu;
+    std::unordered_map<std::uint32_t, std::string> by_id;
+  };
+  Names& names() {
+    static Names* n = new Names(); // nunca se destruye
+    return *n;
+  }
+
+  std::string hex(std::uintptr_t v) {
+    char buf[2 + 2 * sizeof(v) + 1];
+    std::snprintf(buf, sizeof(buf), "0x%llx", static_cast<unsigned long long>(v));
+    return buf;
+  }
+
+  std::string describe(std::uintptr_t pc) {
+    Dl_info info{};
+    if (!dladdr(reinterpret_cast<void*>(pc), &info)) return hex(pc);
+
+    std::string module = "?";
+    if (info.dli_fname && *info.dli_fname) {
+      const char* slash = std::strrchr(info.dli_fname, '/');
+      module = slash ? slash + 1 : info.dli_fname;
+    }
+    if (info.dli_sname && info.dli_saddr) {
+      int status = 0;
+      char* dem = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+      std::string fn = (status == 0 && dem) ? dem : info.dli_sname;
+      std::free(dem);
+      return fn + "+" + hex(pc - reinterpret_cast<std::uintptr_t>(info.dli_saddr)) + " (" + module + ")";
+    }
+    return module + "+" + hex(pc - reinterpret_cast<std::uintptr_t>(info.dli_fbase));
+  }
+
+} // namespace
+
+std::uint32_t intern(const void* pc) noexcept {
+  const std::uintptr_t key = reinterpret_cast<std::uintptr_t>(pc);
+  if (!key) return 0;
+  std::uint32_t slot = home(key);
+  for (std::uint32_t n = 0; n < kMaxProbes; ++n, slot = (slot + 1) & (kMaxPcs - 1)) {
+    Slot& s = g_slots[slot];
+    std::uintptr_t cur = s.pc.load(std::memory_order_acquire);
+    if (cur == 0) {
+      if (s.pc.compare_exchange_strong(cur, key, std::memory_order_acq_rel)) {
+        // Cada slot ganado consume un id, y hay tantos ids como slots
+        const std::uint32_t id = g_count.fetch_add(1, std::memory_order_relaxed) + 1;
+        g_by_id[id - 1].store(key, std::memory_order_release);
+        s.id.store(id, std::memory_order_release);
+        return id;
+      }
+      // Otro hilo tomo el slot: cur tiene su PC
+    }
+    if (cur == key) return waitId(s);
+  }
+  g_misses.fetch_add(1, std::memory_order_relaxed);
+  return 0;
+}
+
+std::uintptr_t address(std::uint32_t id) noexcept {
+  if (id == 0 || id > kMaxPcs) return 0;
+  return g_by_id[id - 1].load(std::memory_order_acquire);
+}
+
+std::string symbolize(std::uint32_t id) {
+  const std::uintptr_t pc = address(id);
+  if (!pc) return "?:0";
+  if (!online_symbolization()) return hex(pc);
+
+  ScopedHookGuard guard; // el cache y dladdr no se atribuyen a nadie
+  Names& n = names();
+  std::lock_guard<std::mutex> lock(n.mu);
+  auto it = n.by_id.find(id);
+  if (it == n.by_id.end()) it = n.by_id.emplace(id, describe(pc)).first;
+  return it->second;
+}
+
+void set_online_symbolization(bool on) noexcept {
+  g_online.store(on, std::memory_order_relaxed);
+}
+
+bool online_symbolization() noexcept {
+  return g_online.load(std::memory_order_relaxed);
+}
+
+std::uint32_t count() noexcept {
+  return g_count.load(std::memory_order_relaxed);
+}
+
+std::uint64_t misses() noexcept {
+  return g_misses.load(std::memory_order_relaxed);
+}
+
+} // namespace pcs
+} // namespace mp
@@ -0,0 +1,74 @@
+#include "../include/Callsite.hpp"
+
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace mp {
+
+namespace {
+
+  // id -> descriptor. Se escribe una vez por id, antes de publicar el id en
+  // el descriptor, asi que la lectura no necesita lock.
+  std::atomic<const CallsiteDescriptor*> g_table[kMaxCallsiteIds];
+  std::atomic<std::uint32_t> g_next{1}; // 0 = sin descriptor
+
+  std::mutex& register_mutex() {
+    static std::mutex m;
+    return m;
+  }
+
+} // namespace
+
+std::uint32_t register_callsite(CallsiteDescriptor& d) noexcept {
+  std::lock_guard<std::mutex> lock(register_mutex());
+  std::uint32_t id = d.id.load(std::memory_order_relaxed);
+  if (id) return id; // otro hilo lo registro primero
+  id = g_next.load(std::memory_order_relaxed);
+  if (id >= kMaxCallsiteIds) return 0;
+  g_table[id].store(&d, std::memory_order_release);
+  g_next.store(id + 1, std::memory_order_relaxed);
+  d.id.store(id, std::memory_order_release);
+  return id;
+}
+
+const CallsiteDescriptor* callsite_descriptor(std::uint32_t id) noexcept {
+  if (id == 0 || id >= kMaxCallsiteIds) return nullptr;
+  return g_table[id].load(std::memory_order_acquire);
+}
+
+std::uint32_t callsite_id_of(const CallsiteInfo& cs) {
+  if (!cs.file && !cs.type_name) return 0;
+  if (const CallsiteDescriptor* d = callsite_descriptor(g_callsite_id)) {
+    if (d->file == cs.file && d->line == cs.line && d->type_name == cs.type_name) return g_callsite_id;
+  }
+
+  // Un ScopedCallsite suele cubrir muchas asignaciones seguidas: el ultimo
+  // sitio del hilo se resuelve sin lock
+  thread_local CallsiteInfo t_last;
+  thread_local std::uint32_t t_last_id = 0;
+  if (t_last_id && t_last.file == cs.file && t_last.line == cs.line && t_last.type_name == cs.type_name) {
+    return t_last_id;
+  }
+
+  static std::mutex* mu = new std::mutex();
+  static auto* ids = new std::map<std::tuple<const char*, int, const char*>, std::uint32_t>();
+  std::uint32_t id;
+  {
+    std::lock_guard<std::mutex> lock(*mu);
+    auto key = std::make_tuple(cs.file, cs.line, cs.type_name);
+    auto it = ids->find(key);
+    if (it != ids->end()) {
+      id = it->second;
+    } else {
+      auto* d = new CallsiteDescriptor(cs.file, cs.line, cs.type_name, 0); // nunca se libera
+      id = register_callsite(*d);
+      ids->emplace(key, id);
+    }
+  }
+  t_last = cs;
+  t_last_id = id;
+  return id;
+}
+
+} // namespace mp
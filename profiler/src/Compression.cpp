@@ -0,0 +1,234 @@
+#include "../include/Compression.hpp"
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+#ifdef MP_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace mp {
+
+  // === Estadisticas globales (se leen desde el SUMMARY) ===
+
+  static std::atomic<std::uint64_t> g_frames{0};
+  static std::atomic<std::uint64_t> g_raw_bytes{0};
+  static std::atomic<std::uint64_t> g_comp_bytes{0};
+  static std::atomic<std::uint64_t> g_cpu_ns{0};
+
+  std::uint64_t thread_cpu_ns() noexcept {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<std::uint64_t>(ts.tv_nsec);
+  }
+
+  void record_compression(std::size_t raw, std::size_t compressed, std::uint64_t ns) noexcept {
+    g_frames.fetch_add(1, std::memory_order_relaxed);
+    g_raw_bytes.fetch_add(raw, std::memory_order_relaxed);
+    g_comp_bytes.fetch_add(compressed, std::memory_order_relaxed);
+    g_cpu_ns.fetch_add(ns, std::memory_order_relaxed);
+  }
+
+  CompressionStats compression_stats() noexcept {
+    CompressionStats s;
+    s.frames           = g_frames.load(std::memory_order_relaxed);
+    s.raw_bytes        = g_raw_bytes.load(std::memory_order_relaxed);
+    s.compressed_bytes = g_comp_bytes.load(std::memory_order_relaxed);
+    s.cpu_ns           = g_cpu_ns.load(std::memory_order_relaxed);
+    return s;
+  }
+
+  // === Nombres ===
+
+  const char* codec_name(Codec c) noexcept {
+    switch (c) {
+      case Codec::MpLz: return "mplz";
+      case Codec::Zlib: return "zlib";
+      default:          return "none";
+    }
+  }
+
+  bool codec_from_name(const std::string& name, Codec& out) noexcept {
+    if (name == "none" || name == "off") { out = Codec::None; return true; }
+    if (name == "mplz")                  { out = Codec::MpLz; return true; }
+#ifdef MP_HAVE_ZLIB
+    if (name == "zlib")                  { out = Codec::Zlib; return true; }
+#endif
+    return false;
+  }
+
+  std::string available_codecs_json() {
+#ifdef MP_HAVE_ZLIB
+    return "[\"mplz\",\"zlib\"]";
+#else
+    return "[\"mplz\"]";
+#endif
+  }
+
+  // === MpLz: LZ77 con formato de bloque estilo LZ4 ===
+  //
+  // Secuencia: token (4 bits literales | 4 bits match-4), [extension literales],
+  // literales, offset de 16 bits little-endian, [extension match]. Las
+  // extensiones son bytes 255 encadenados. La ultima secuencia solo tiene
+  // literales. Ventana de 64 KiB y tabla hash de 16K posiciones.
+
+  static constexpr std::size_t kMinMatch   = 4;
+  static constexpr std::size_t kLastLits   = 5;     // el bloque termina en literales
+  static constexpr std::size_t kMaxOffset  = 65535;
+  static constexpr unsigned    kHashLog    = 14;
+
+  static inline std::uint32_t read32(const unsigned char* p) {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+  }
+
+  static inline std::uint32_t lz_hash(std::uint32_t v) {
+    return (v * 2654435761u) >> (32 - kHashLog);
+  }
+
+  static inline void put_length(std::string& out, std::size_t len) {
+    while (len >= 255) { out.push_back(static_cast<char>(255)); len -= 255; }
+    out.push_back(static_cast<char>(len));
+  }
+
+  static void lz_emit(std::string& out, const unsigned char* lit, std::size_t litLen,
+                      std::size_t offset, std::size_t matchLen) {
+    const std::size_t ml = matchLen ? matchLen - kMinMatch : 0;
+    unsigned char token = static_cast<unsigned char>(
+        ((litLen >= 15 ? 15 : litLen) << 4) | (ml >= 15 ? 15 : ml));
+    out.push_back(static_cast<char>(token));
+    if (litLen >= 15) put_length(out, litLen - 15);
+    out.append(reinterpret_cast<const char*>(lit), litLen);
+    if (!matchLen) return; // ultima secuencia
+    out.push_back(static_cast<char>(offset & 0xFF));
+    out.push_back(static_cast<char>((offset >> 8) & 0xFF));
+    if (ml >= 15) put_length(out, ml - 15);
+  }
+
+  static void mplz_compress(const unsigned char* src, std::size_t n, std::string& out) {
+    out.clear();
+    out.reserve(n + n / 255 + 16);
+
+    std::vector<std::uint32_t> table(std::size_t(1) << kHashLog, 0); // pos+1, 0 = vacio
+    std::size_t anchor = 0;
+    std::size_t ip     = 0;
+    const std::size_t matchLimit = n > kLastLits ? n - kLastLits : 0;
+
+    while (ip + kMinMatch + kLastLits + 3 < n) {
+      const std::uint32_t seq = read32(src + ip);
+      const std::uint32_t h   = lz_hash(seq);
+      const std::size_t   ref = table[h];
+      table[h] = static_cast<std::uint32_t>(ip + 1);
+
+      if (ref == 0 || ip - (ref - 1) > kMaxOffset || read32(src + ref - 1) != seq) {
+        ++ip;
+        continue;
+      }
+
+      const std::size_t mpos = ref - 1;
+      std::size_t len = kMinMatch;
+      while (ip + len < matchLimit && src[mpos + len] == src[ip + len]) ++len;
+
+      lz_emit(out, src + anchor, ip - anchor, ip - mpos, len);
+      ip += len;
+      anchor = ip;
+    }
+
+    lz_emit(out, src + anchor, n - anchor, 0, 0);
+  }
+
+  static bool read_length(const unsigned char* src, std::size_t n, std::size_t& ip, std::size_t& len) {
+    for (;;) {
+      if (ip >= n) return false;
+      const unsigned char b = src[ip++];
+      len += b;
+      if (b != 255) return true;
+    }
+  }
+
+  static bool mplz_decompress(const unsigned char* src, std::size_t n,
+                              std::size_t rawSize, std::string& out) {
+    out.clear();
+    out.reserve(rawSize);
+    std::size_t ip = 0;
+
+    while (ip < n) {
+      const unsigned char token = src[ip++];
+
+      std::size_t lit = token >> 4;
+      if (lit == 15 && !read_length(src, n, ip, lit)) return false;
+      if (lit > n - ip || out.size() + lit > rawSize) return false;
+      out.append(reinterpret_cast<const char*>(src + ip), lit);
+      ip += lit;
+
+      if (ip == n) break; // ultima secuencia: solo literales
+
+      if (n - ip < 2) return false;
+      const std::size_t offset = std::size_t(src[ip]) | (std::size_t(src[ip + 1]) << 8);
+      ip += 2;
+      if (offset == 0 || offset > out.size()) return false;
+
+      std::size_t len = token & 15;
+      if (len == 15 && !read_length(src, n, ip, len)) return false;
+      len += kMinMatch;
+      if (out.size() + len > rawSize) return false;
+
+      // Copia byte a byte: el match puede solaparse con lo que se escribe
+      std::size_t from = out.size() - offset;
+      for (std::size_t i = 0; i < len; ++i) out.push_back(out[from + i]);
+    }
+    return out.size() == rawSize;
+  }
+
+  // === API ===
+
+  bool compress_frame(Codec c, const char* data, std::size_t n, std::string& out) {
+    const auto* src = reinterpret_cast<const unsigned char*>(data);
+    switch (c) {
+      case Codec::MpLz:
+        mplz_compress(src, n, out);
+        return true;
+#ifdef MP_HAVE_ZLIB
+      case Codec::Zlib: {
+        uLongf destLen = compressBound(static_cast<uLong>(n));
+        out.resize(destLen);
+        int rc = compress2(reinterpret_cast<Bytef*>(&out[0]), &destLen,
+                           src, static_cast<uLong>(n), Z_BEST_SPEED);
+        if (rc != Z_OK) return false;
+        out.resize(destLen);
+        return true;
+      }
+#endif
+      default:
+        out.assign(data, n);
+        return true;
+    }
+  }
+
+  bool decompress_frame(Codec c, const char* data, std::size_t n,
+                        std::size_t raw_size, std::string& out) {
+    const auto* src = reinterpret_cast<const unsigned char*>(data);
+    switch (c) {
+      case Codec::MpLz:
+        return mplz_decompress(src, n, raw_size, out);
+#ifdef MP_HAVE_ZLIB
+      case Codec::Zlib: {
+        out.resize(raw_size);
+        uLongf destLen = static_cast<uLongf>(raw_size);
+        int rc = uncompress(reinterpret_cast<Bytef*>(&out[0]), &destLen,
+                            src, static_cast<uLong>(n));
+        return rc == Z_OK && destLen == raw_size;
+      }
+#endif
+      case Codec::None:
+        if (n != raw_size) return false;
+        out.assign(data, n);
+        return true;
+      default:
+        return false;
+    }
+  }
+
+} // namespace mp
@@ -0,0 +1,154 @@
+#include "../include/Epoch.hpp"
+#include "../include/ReentryGuard.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mp {
+namespace epoch {
+
+namespace {
+
+  constexpr std::size_t kMaxSlots = 256;
+
+  // Un slot por linea de cache para que los hilos no se pisen
+  struct alignas(64) Slot {
+    std::atomic<std::uint64_t> active{0};   // epoca al entrar, 0 = fuera
+    std::atomic<bool>          used{false};
+  };
+
+  Slot g_slots[kMaxSlots];
+  std::atomic<std::uint64_t> g_epoch{1};
+
+  // Lectores sin slot (mas de kMaxSlots hilos vivos): se cuentan aparte y
+  // el escritor los espera de forma conservadora
+  std::atomic<std::uint64_t> g_overflow{0};
+
+  struct Retired {
+    void*          ptr;
+    void         (*deleter)(void*);
+    std::uint64_t  epoch;
+  };
+
+  // Estado del escritor; static local para que exista aunque se retire algo
+  // durante la inicializacion estatica
+  struct RetireList {
+    std::mutex           mu;
+    std::vector<Retired> items;
+  };
+  RetireList& retire_list() {
+    static RetireList* l = new RetireList(); // nunca se destruye
+    return *l;
+  }
+
+  // Slot del hilo. Se toma en el primer guard y se suelta al terminar el hilo.
+  struct ThreadSlot {
+    Slot* slot  = nullptr;
+    int   state = 0;   // 0 sin pedir, 1 con slot, 2 sin slot (overflow o hilo terminando)
+    int   depth = 0;
+    ~ThreadSlot() {
+      if (slot) {
+        slot->active.store(0, std::memory_order_release);
+        slot->used.store(false, std::memory_order_release);
+        slot = nullptr;
+      }
+      state = 2;
+    }
+  };
+  thread_local ThreadSlot t_slot;
+
+  void claim(ThreadSlot& ts) noexcept {
+    for (auto& s : g_slots) {
+      bool expected = false;
+      if (!s.used.load(std::memory_order_relaxed) &&
+          s.used.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+        ts.slot  = &s;
+        ts.state = 1;
+        return;
+      }
+    }
+    ts.state = 2;
+  }
+
+  // Menor epoca de los lectores activos (UINT64_MAX si no hay ninguno)
+  std::uint64_t min_active() noexcept {
+    std::uint64_t m = UINT64_MAX;
+    for (auto& s : g_slots) {
+      const std::uint64_t e = s.active.load(std::memory_order_seq_cst);
+      if (e != 0 && e < m) m = e;
+    }
+    return m;
+  }
+
+} // namespace
+
+ReadGuard::ReadGuard() noexcept {
+  ThreadSlot& ts = t_slot;
+  if (ts.depth++ > 0) return;
+  if (ts.state == 0) claim(ts);
+  if (ts.slot) {
+    // seq_cst: el anuncio debe ser visible antes de cargar el puntero protegido
+    ts.slot->active.store(g_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+  } else {
+    g_overflow.fetch_add(1, std::memory_order_seq_cst);
+  }
+}
+
+ReadGuard::~ReadGuard() {
+  ThreadSlot& ts = t_slot;
+  if (--ts.depth > 0) return;
+  if (ts.slot) {
+    ts.slot->active.store(0, std::memory_order_release);
+  } else {
+    g_overflow.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+void retire(void* p, void (*deleter)(void*)) {
+  if (!p) return;
+  {
+    ScopedHookGuard guard;
+    RetireList& l = retire_list();
+    std::lock_guard<std::mutex> lock(l.mu);
+    // Lectores con epoca >= e entraron despues de la publicacion que
+    // reemplazo a p, asi que no pueden tenerlo
+    const std::uint64_t e = g_epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+    l.items.push_back(Retired{p, deleter, e});
+  }
+  try_reclaim();
+}
+
+std::uint64_t try_reclaim() {
+  ScopedHookGuard guard;
+  std::vector<Retired> ready;
+  std::uint64_t pending = 0;
+  {
+    RetireList& l = retire_list();
+    std::lock_guard<std::mutex> lock(l.mu);
+    if (l.items.empty()) return 0;
+    const bool overflow = g_overflow.load(std::memory_order_seq_cst) != 0;
+    const std::uint64_t m = min_active();
+    std::size_t keep = 0;
+    for (auto& r : l.items) {
+      if (!overflow && r.epoch <= m) ready.push_back(r);
+      else l.items[keep++] = r;
+    }
+    l.items.resize(keep);
+    pending = keep;
+  }
+  for (auto& r : ready) r.deleter(r.ptr);
+  return pending;
+}
+
+void synchronize() {
+  const std::uint64_t e = g_epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+  for (;;) {
+    if (min_active() >= e && g_overflow.load(std::memory_order_seq_cst) == 0) return;
+    std::this_thread::yield();
+  }
+}
+
+} // namespace epoch
+} // namespace mp
@@ -0,0 +1,308 @@
+#include "../include/HeaderTracker.hpp"
+#include "../include/AllocId.hpp"
+#include "../include/CallerPc.hpp"
+#include "../include/Callsite.hpp"
+#include "../include/ReentryGuard.hpp"
+#include "../include/SpinLock.hpp"
+#include "../include/ThreadRegistry.hpp"
+#include "../include/Timestamp.hpp"
+#include "../include/TypeRegistry.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+
+#include <unistd.h>
+
+namespace mp {
+namespace header {
+
+namespace {
+
+  constexpr std::uint64_t kMagic = 0x6D705F6864725F31ull; // "mp_hdr_1"
+
+  std::uint64_t expected_magic(const BlockHeader* h) noexcept {
+    return (kMagic ^ reinterpret_cast<std::uintptr_t>(h)) & ~std::uint64_t(kFlagMask);
+  }
+
+  // Lista de bloques vivos de un hilo. Cada una en su linea de cache: el
+  // dueño la toca en cada new y los demas solo al liberar sus bloques.
+  struct alignas(64) List : SpinLock {
+    std::atomic<BlockHeader*> head{nullptr};
+  };
+
+  List g_lists[threads::kMaxThreads];
+
+  std::atomic<std::uint64_t> g_foreign{0};
+
+  // Pico del proceso como en policy::Counters: cada hilo acumula su saldo
+  // (allocs menos frees que hizo el) en su linea y lo vuelca a g_in_use al
+  // pasar kFlushBytes. Cada alloc sube el pico con g_in_use mas el saldo
+  // propio; faltan solo los saldos positivos sin volcar de otros hilos.
+  constexpr std::int64_t kFlushBytes = 32 * 1024;
+  struct alignas(64) PeakShard {
+    std::atomic<std::int64_t> pending{0};
+  };
+  PeakShard g_peak_shards[threads::kMaxThreads];
+  std::atomic<std::int64_t> g_in_use{0};
+  std::atomic<std::int64_t> g_peak{0};
+
+  void raise_peak(std::int64_t now) noexcept {
+    std::int64_t prev = g_peak.load(std::memory_order_relaxed);
+    while (now > prev && !g_peak.compare_exchange_weak(prev, now, std::memory_order_relaxed)) {}
+  }
+
+  void flush_peak(PeakShard& s) noexcept {
+    const std::int64_t v = s.pending.exchange(0, std::memory_order_relaxed);
+    const std::int64_t now = g_in_use.fetch_add(v, std::memory_order_relaxed) + v;
+    if (v > 0) raise_peak(now);
+  }
+
+  void peak_add(std::uint32_t thread, std::size_t sz) noexcept {
+    PeakShard& s = g_peak_shards[thread];
+    const auto v = static_cast<std::int64_t>(sz);
+    const std::int64_t pending = s.pending.fetch_add(v, std::memory_order_relaxed) + v;
+    if (pending >= kFlushBytes) flush_peak(s);
+    else if (pending > 0) raise_peak(g_in_use.load(std::memory_order_relaxed) + pending);
+  }
+
+  void peak_sub(std::size_t sz) noexcept {
+    PeakShard& s = g_peak_shards[threads::current()];
+    const auto v = static_cast<std::int64_t>(sz);
+    if (s.pending.fetch_sub(v, std::memory_order_relaxed) - v <= -kFlushBytes) flush_peak(s);
+  }
+
+  // Lo que se copia de un encabezado con el lock de su lista tomado
+  struct Copy {
+    void*         user;
+    std::uint64_t size;
+    std::uint64_t timestamp;
+    std::uint64_t alloc_id;
+    std::uint32_t thread_id;
+    std::uint32_t callsite;
+    std::uint32_t pc_id;
+  };
+
+  template <class Fn>
+  void for_each_live(Fn&& fn) {
+    for (std::uint32_t i = 0; i < threads::kMaxThreads; ++i) {
+      List& l = g_lists[i];
+      if (!l.head.load(std::memory_order_relaxed)) continue;
+      l.lock();
+      for (BlockHeader* h = l.head.load(std::memory_order_relaxed); h; h = h->next) {
+        fn(Copy{reinterpret_cast<char*>(h) + kHeaderBytes, h->size, h->timestamp,
+                h->alloc_id, h->thread_id, h->callsite, h->pc_id});
+      }
+      l.unlock();
+    }
+  }
+
+  std::vector<Copy> copy_live() {
+    std::vector<Copy> out;
+    out.reserve(static_cast<std::size_t>(threads::totals().live_count) + 64);
+    for_each_live([&](const Copy& c) { out.push_back(c); });
+    return out;
+  }
+
+  void warn_foreign() noexcept {
+    static const char msg[] = "[mp] delete de un puntero sin encabezado del profiler; se libera tal cual\n";
+    ssize_t r = ::write(2, msg, sizeof(msg) - 1);
+    (void)r;
+  }
+
+} // namespace
+
+void* allocate(std::size_t sz, std::size_t align) noexcept {
+  if (align <= alignof(std::max_align_t)) {
+    if (sz > SIZE_MAX - kHeaderBytes) return nullptr;
+    char* base = static_cast<char*>(std::malloc(sz + kHeaderBytes));
+    if (!base) return nullptr;
+    header_of(base + kHeaderBytes)->offset = static_cast<std::uint32_t>(kHeaderBytes);
+    return base + kHeaderBytes;
+  }
+  // Alineacion extendida: el encabezado ocupa un multiplo de align, asi el
+  // puntero del usuario queda alineado y el encabezado justo antes
+  const std::size_t prefix = (kHeaderBytes + align - 1) & ~(align - 1);
+  if (sz > SIZE_MAX - prefix || prefix > UINT32_MAX) return nullptr;
+  void* base = nullptr;
+  if (posix_memalign(&base, align, sz + prefix) != 0) return nullptr;
+  char* user = static_cast<char*>(base) + prefix;
+  header_of(user)->offset = static_cast<std::uint32_t>(prefix);
+  return user;
+}
+
+void onAlloc(void* user, std::size_t sz, bool isArray, bool tracked) noexcept {
+  BlockHeader* h = header_of(user);
+  h->size = sz;
+  const std::uint64_t flags = isArray ? std::uint64_t(kArray) : 0;
+  if (!tracked) {
+    h->prev = h->next = nullptr;
+    h->magic = expected_magic(h) | flags;
+    return;
+  }
+
+  h->timestamp = timestamps::now();
+  h->alloc_id  = alloc_ids::next();
+  h->thread_id = threads::current();
+  h->callsite  = current_callsite_id();
+  h->pc_id     = pcs::intern(g_caller_pc);
+  h->prev      = nullptr;
+  h->magic     = expected_magic(h) | flags | kTracked;
+
+  List& l = g_lists[h->thread_id];
+  l.lock();
+  BlockHeader* head = l.head.load(std::memory_order_relaxed);
+  h->next = head;
+  if (head) head->prev = h;
+  l.head.store(h, std::memory_order_relaxed);
+  l.unlock();
+
+  threads::onAlloc(h->thread_id, sz);
+  peak_add(h->thread_id, sz);
+}
+
+void release(void* user) noexcept {
+  // magic es lo ultimo del encabezado: para un puntero ajeno se lee la
+  // cabecera de malloc (siempre mapeada) y no lo que hay 64 bytes antes
+  BlockHeader* h = header_of(user);
+  const std::uint64_t m = h->magic;
+  if ((m & ~std::uint64_t(kFlagMask)) != expected_magic(h)) {
+    if (g_foreign.fetch_add(1, std::memory_order_relaxed) == 0) warn_foreign();
+    std::free(user);
+    return;
+  }
+
+  if (m & kTracked) {
+    List& l = g_lists[h->thread_id];
+    l.lock();
+    if (h->prev) h->prev->next = h->next;
+    else l.head.store(h->next, std::memory_order_relaxed);
+    if (h->next) h->next->prev = h->prev;
+    l.unlock();
+    threads::onFree(h->thread_id, h->size);
+    peak_sub(h->size);
+  }
+  h->magic = 0; // un segundo delete del mismo puntero ya no coincide
+  std::free(reinterpret_cast<char*>(user) - h->offset);
+}
+
+std::vector<BlockInfo> liveBlocks() {
+  ScopedHookGuard guard;
+  const std::vector<Copy> live = copy_live();
+  const timestamps::Converter toNs;
+
+  std::vector<BlockInfo> out;
+  out.reserve(live.size());
+  for (const Copy& c : live) {
+    BlockInfo b{};
+    b.ptr       = c.user;
+    b.size      = c.size;
+    b.alloc_id  = c.alloc_id;
+    b.thread_id = c.thread_id;
+    b.t_ns      = toNs(c.timestamp);
+    b.pc        = pcs::address(c.pc_id);
+    const CallsiteDescriptor* d = callsite_descriptor(c.callsite);
+    if (d && d->file) {
+      b.file     = d->file;
+      b.line     = d->line;
+      b.callsite = b.file + ":" + std::to_string(b.line);
+    } else {
+      b.file     = "?";
+      b.callsite = pcs::symbolize(c.pc_id);
+    }
+    b.type_id = d ? types::intern(d->type_name) : types::kUnknown;
+    out.push_back(std::move(b));
+  }
+  return out;
+}
+
+// Totales e hilos salen de los contadores por hilo; callsites e histograma
+// se arman recorriendo las listas (no hay agregados por sitio en el hook)
+AggregateStats aggregateStats(std::size_t topCallsites) {
+  ScopedHookGuard guard;
+  AggregateStats out;
+  const ThreadCounters t = threads::totals();
+  out.bytes_in_use = t.live_bytes;
+  out.live_count   = t.live_count;
+  out.total_allocs = t.total_allocs;
+  out.total_frees  = t.total_frees;
+  out.total_bytes  = t.total_bytes;
+  out.peak         = peakBytes();
+
+  for (auto& th : threads::snapshot().threads) {
+    if (th.counters.total_allocs == 0) continue;
+    ThreadUsage u;
+    u.thread_id    = th.id;
+    u.name         = std::move(th.name);
+    u.live_bytes   = th.counters.live_bytes;
+    u.live_count   = th.counters.live_count;
+    u.total_allocs = th.counters.total_allocs;
+    out.threads.push_back(std::move(u));
+  }
+  std::sort(out.threads.begin(), out.threads.end(),
+            [](const ThreadUsage& a, const ThreadUsage& b) { return a.live_bytes > b.live_bytes; });
+
+  // Sitio = descriptor, o PC si no hay (mismo criterio que MemoryTracker)
+  std::unordered_map<std::uint64_t, CallsiteUsage> sites;
+  for (const Copy& c : copy_live()) {
+    const std::uint64_t key = c.callsite ? c.callsite : (std::uint64_t(1) << 32) | c.pc_id;
+    CallsiteUsage& u = sites[key];
+    u.live_bytes += c.size;
+    ++u.live_count;
+    ++u.total_allocs; // sin historico por sitio: cuenta solo los vivos
+    const std::size_t b = size_histogram_bucket(c.size);
+    ++out.size_hist_count[b];
+    out.size_hist_bytes[b] += c.size;
+  }
+
+  std::unordered_map<std::string, CallsiteUsage> merged;
+  for (const auto& kv : sites) {
+    const CallsiteDescriptor* d = (kv.first >> 32) ? nullptr
+                                                   : callsite_descriptor(static_cast<std::uint32_t>(kv.first));
+    std::string name = (d && d->file) ? std::string(d->file) + ":" + std::to_string(d->line)
+                                      : pcs::symbolize(static_cast<std::uint32_t>(kv.first & 0xFFFFFFFFu));
+    CallsiteUsage& u = merged[name];
+    u.live_bytes   += kv.second.live_bytes;
+    u.live_count   += kv.second.live_count;
+    u.total_allocs += kv.second.total_allocs;
+  }
+  out.callsite_count = merged.size();
+  std::vector<CallsiteUsage> all;
+  all.reserve(merged.size());
+  for (auto& kv : merged) {
+    kv.second.callsite = kv.first;
+    all.push_back(std::move(kv.second));
+  }
+  const std::size_t n = std::min(topCallsites, all.size());
+  std::partial_sort(all.begin(), all.begin() + static_cast<std::ptrdiff_t>(n), all.end(),
+                    [](const CallsiteUsage& a, const CallsiteUsage& b) { return a.live_bytes > b.live_bytes; });
+  all.resize(n);
+  out.top_callsites = std::move(all);
+
+  out.t_ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+  return out;
+}
+
+std::size_t bytesInUse() noexcept {
+  return static_cast<std::size_t>(threads::totals().live_bytes);
+}
+
+// El pico lo sube cada alloc (ver PeakShard); lo que se lee tambien cuenta
+std::size_t peakBytes() noexcept {
+  raise_peak(static_cast<std::int64_t>(threads::totals().live_bytes));
+  return static_cast<std::size_t>(g_peak.load(std::memory_order_relaxed));
+}
+
+std::size_t allocCount() noexcept {
+  return static_cast<std::size_t>(threads::totals().total_allocs);
+}
+
+std::uint64_t foreignFrees() noexcept {
+  return g_foreign.load(std::memory_order_relaxed);
+}
+
+} // namespace header
+} // namespace mp
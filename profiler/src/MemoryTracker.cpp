@@ -1,6 +1,15 @@
 #include "../include/MemoryTracker.hpp"
 #include <new> // std::nothrow (por si se usa en el futuro)
 #include "../include/ReentryGuard.hpp"  // para ScopedHookGuard
+#include "../include/AllocId.hpp"
+#include "../include/CallerPc.hpp"
+#include "../include/Overhead.hpp"
+#include "../include/Sections.hpp"
+#include "../include/Stacks.hpp"
+#include "../include/ThreadRegistry.hpp"
+#include "../include/Timestamp.hpp"
+#include <algorithm>
+#include <string>
 
 namespace mp {
 
@@ -12,26 +21,21 @@ uint64_t MemoryTracker::nowNs() {
     return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
 }
 
-// Devuelve un identificador unico para el hilo actual (reducido a 32 bits)
-uint32_t MemoryTracker::thisThreadId() {
-    auto h = std::hash<std::thread::id>{}(std::this_thread::get_id());
-    // Reducir a 32 bits de forma portable
-    return static_cast<uint32_t>(h & 0xFFFFFFFFu);
-}
-
 // === Singleton ===
 
 // Devuelve la unica instancia de MemoryTracker (patron singleton)
+// Nunca se destruye: los delete que corren durante la destruccion estatica
+// (o en otros hilos al salir) siguen llamando a onFree
 MemoryTracker& MemoryTracker::instance() {
-    static MemoryTracker inst;
-    return inst;
+    alignas(MemoryTracker) static unsigned char storage[sizeof(MemoryTracker)];
+    static MemoryTracker* inst = new (storage) MemoryTracker();
+    return *inst;
 }
 
 // === Registro de asignacion ===
 
 // Se llama cada vez que se asigna memoria
-void MemoryTracker::onAlloc(void* p, std::size_t sz, const char* type,
-                            const char* file, int line, bool isArray) {
+void MemoryTracker::onAlloc(void* p, std::size_t sz, std::uint32_t callsite, bool isArray) {
     if (!p || sz == 0) {
         // Si malloc devolvio nullptr (o size==0), no registramos
         return;
@@ -41,17 +45,73 @@ void MemoryTracker::onAlloc(void* p, std::size_t sz, const char* type,
     AllocationRecord rec;
     rec.ptr          = p;              // Direccion de memoria
     rec.size         = sz;             // Tamaño en bytes
-    rec.type_name    = type;           // Nombre del tipo
-    rec.timestamp_ns = nowNs();        // Tiempo de asignacion
-    rec.thread_id    = thisThreadId(); // Id del hilo
-    rec.file         = file;           // Archivo fuente
-    rec.line         = line;           // Numero de linea
+    rec.alloc_id     = alloc_ids::next(); // Rango propio del hilo, sin contencion
+    rec.timestamp    = timestamps::now(); // Crudo (rdtsc, coarse...); a ns al serializar
+    rec.thread_id    = threads::current(); // Id denso del hilo (cacheado en TLS)
+    rec.callsite_id  = callsite;       // Archivo, linea y tipo (descriptor)
     rec.is_array     = isArray;        // Si fue new[] en lugar de new
+    rec.section      = sections::current(); // ScopedSection mas interna del hilo
+    rec.pc_id        = pcs::intern(g_caller_pc); // Quien llamo a new (sin lock)
+    rec.stack_id     = stacks::capture(g_caller_pc); // 0 si la captura esta apagada
+
+    RecentBuffer* b = recentFor(rec.thread_id);
+    if (!b) { // hilo sin id (tabla de hilos llena): directo a la tabla
+        overhead::TimedLock lock(mu_);
+        raisePeak(sz);
+        insertLocked(rec, false);
+        return;
+    }
+
+    // Hilo y seccion se cuentan ya (atomicos, sin mu_); la tabla, si el
+    // bloque sobrevive al buffer
+    threads::onAlloc(rec.thread_id, sz);
+    sections::onAlloc(rec.section, sz);
+
+    b->lock();
+    raisePeak(sz);
+    const std::uint32_t i = b->next++ % kRecentSlots;
+    if (b->ptrs[i]) { // el mas viejo del anillo envejecio: pasa a la tabla
+        overhead::TimedLock lock(mu_);
+        insertLocked(b->recs[i], true);
+    }
+    b->ptrs[i] = p;
+    b->recs[i] = rec;
+    if (i == kRecentSlots - 1) {
+        rebuildFilterLocked(*b); // quita los bits de lo que ya salio
+    } else {
+        const std::size_t bit = filterBit(p);
+        b->filter[bit / 64].fetch_or(std::uint64_t(1) << (bit % 64), std::memory_order_relaxed);
+    }
+    b->unlock();
+}
+
+void MemoryTracker::onAllocRecord(const AllocationRecord& rec) {
+    overhead::TimedLock lock(mu_);
+    raisePeak(rec.size);
+    insertLocked(rec, false);
+}
+
+void MemoryTracker::raisePeak(std::size_t sz) noexcept {
+    const auto base_fn = baseline_fn_.load(std::memory_order_relaxed);
+    const std::size_t base = base_fn ? base_fn() : 0;
+    const std::size_t now  = in_use_.fetch_add(sz, std::memory_order_relaxed) + sz + base;
+    std::size_t prev = peak_bytes_.load(std::memory_order_relaxed);
+    while (now > prev && !peak_bytes_.compare_exchange_weak(prev, now, std::memory_order_relaxed)) {}
+}
 
-    std::lock_guard<std::mutex> lock(mu_);
+// Agrega un registro a la tabla y a las metricas (requiere mu_ tomado)
+void MemoryTracker::insertLocked(const AllocationRecord& rec, bool counted) {
+    void* const p        = rec.ptr;
+    const std::size_t sz = rec.size;
 
-    // Guardamos el registro en la tabla de asignaciones vivas
-    live_.emplace(p, rec);
+    // Guardamos el registro en la tabla de asignaciones vivas. Si la
+    // direccion ya estaba, su free no paso por aqui (profiler apagado en ese
+    // momento): el registro viejo es basura y se reemplaza.
+    auto ins = live_.try_emplace(p, rec);
+    if (!ins.second) {
+        forgetLocked(ins.first->second);
+        ins.first->second = rec;
+    }
 
     // Actualizamos metricas
     ++total_allocs_;
@@ -59,35 +119,286 @@ void MemoryTracker::onAlloc(void* p, std::size_t sz, const char* type,
     total_bytes_  += sz;
     active_bytes_ += sz;
 
-    // Si superamos el máximo histórico, actualizarlo
-    if (active_bytes_ > peak_bytes_) {
-        peak_bytes_ = active_bytes_;
+    // Agregados para STATS
+    UsageCounters& site = by_site_[siteOf(rec)];
+    site.live_bytes += sz;
+    ++site.live_count;
+    ++site.total_allocs;
+
+    const std::size_t b = size_histogram_bucket(sz);
+    ++hist_count_[b];
+    hist_bytes_[b] += sz;
+
+    if (counted) {
+        ++recent_promoted_;
+    } else {
+        threads::onAlloc(rec.thread_id, sz);
+        sections::onAlloc(rec.section, sz);
+    }
+}
+
+// === Buffer de asignaciones recientes ===
+
+MemoryTracker::RecentBuffer* MemoryTracker::recentFor(std::uint32_t thread_id) {
+    if (thread_id == threads::kUnknown) return nullptr;
+    RecentBuffer* b = recent_[thread_id].load(std::memory_order_acquire);
+    if (b) return b;
+    // Solo el hilo dueño del id lo crea (un id se recicla recien cuando su
+    // hilo termino)
+    ScopedHookGuard guard;
+    b = new RecentBuffer();
+    recent_[thread_id].store(b, std::memory_order_release);
+    recent_used_.store(true, std::memory_order_relaxed);
+    return b;
+}
+
+void MemoryTracker::rebuildFilterLocked(RecentBuffer& b) noexcept {
+    std::uint64_t words[kFilterWords] = {};
+    for (const void* p : b.ptrs) {
+        if (!p) continue;
+        const std::size_t bit = filterBit(p);
+        words[bit / 64] |= std::uint64_t(1) << (bit % 64);
+    }
+    // release: quien lea un bit en 0 ve tambien el paso a la tabla
+    for (std::size_t w = 0; w < kFilterWords; ++w) b.filter[w].store(words[w], std::memory_order_release);
+}
+
+bool MemoryTracker::cancelRecentLocked(RecentBuffer& b, void* p, std::uint64_t now) noexcept {
+    // Del mas nuevo al mas viejo: lo tipico es liberar lo ultimo asignado
+    for (std::uint32_t k = 1; k <= kRecentSlots; ++k) {
+        const std::uint32_t i = (b.next - k) % kRecentSlots;
+        if (b.ptrs[i] != p) continue;
+        const AllocationRecord& r = b.recs[i];
+        b.ptrs[i] = nullptr;
+        in_use_.fetch_sub(r.size, std::memory_order_relaxed);
+        threads::onFree(r.thread_id, r.size);
+        sections::onFree(r.section, r.size);
+        ++b.hits;
+        b.hit_bytes += r.size;
+        const SiteKey key = siteOf(r);
+        SiteTally& tally = b.sites[SiteKeyHash{}(key) % kSiteTally];
+        if (tally.count && !(tally.site == key)) {
+            // Choque con otro sitio: el viejo pasa a by_site_ ya
+            overhead::TimedLock lock(mu_);
+            mergeSiteTallyLocked(tally);
+        }
+        tally.site = key;
+        ++tally.count;
+        if (r.timestamp) ++b.lifetime[lifetime_bucket(timestamps::elapsed_ns(r.timestamp, now))];
+        return true;
+    }
+    return false;
+}
+
+// Pasa los registros del buffer a la tabla, del mas viejo al mas nuevo, y
+// suma lo cancelado en el (requiere b y mu_ tomados)
+void MemoryTracker::promoteRecentLocked(RecentBuffer& b, RecentSums& sums) {
+    for (std::uint32_t k = 0; k < kRecentSlots; ++k) {
+        const std::uint32_t i = (b.next + k) % kRecentSlots;
+        if (!b.ptrs[i]) continue;
+        insertLocked(b.recs[i], true);
+        b.ptrs[i] = nullptr;
+    }
+    rebuildFilterLocked(b);
+    for (SiteTally& t : b.sites) mergeSiteTallyLocked(t);
+    sums.hits  += b.hits;
+    sums.bytes += b.hit_bytes;
+    for (std::size_t i = 0; i < kLifetimeBuckets; ++i) sums.lifetime[i] += b.lifetime[i];
+}
+
+void MemoryTracker::mergeSiteTallyLocked(SiteTally& t) {
+    if (!t.count) return;
+    by_site_[t.site].total_allocs += t.count;
+    t.count = 0;
+}
+
+// Vaciar no cambia lo que el tracker reporta (los bloques ya contaban en
+// hilos y secciones), por eso se puede llamar desde las consultas const
+MemoryTracker::RecentSums MemoryTracker::flushRecent() const {
+    RecentSums sums;
+    if (!recent_used_.load(std::memory_order_relaxed)) return sums;
+    ScopedHookGuard guard; // la tabla asigna nodos con un buffer tomado
+    auto* self = const_cast<MemoryTracker*>(this);
+    const std::uint32_t n = threads::slots_used();
+    for (std::uint32_t t = 0; t < n; ++t) {
+        RecentBuffer* b = recent_[t].load(std::memory_order_acquire);
+        if (!b) continue;
+        b->lock();
+        {
+            overhead::TimedLock lock(mu_);
+            self->promoteRecentLocked(*b, sums);
+        }
+        b->unlock();
+    }
+    return sums;
+}
+
+// Toma (o suelta) los buffers existentes, en orden de id. Con todos
+// tomados, ningun onAlloc/onFree queda a medias entre buffer y tabla.
+std::uint32_t MemoryTracker::lockRecent() noexcept {
+    const std::uint32_t n = recent_used_.load(std::memory_order_relaxed) ? threads::slots_used() : 0;
+    for (std::uint32_t t = 0; t < n; ++t) {
+        if (RecentBuffer* b = recent_[t].load(std::memory_order_acquire)) b->lock();
+    }
+    return n;
+}
+
+void MemoryTracker::unlockRecent(std::uint32_t n) noexcept {
+    for (std::uint32_t t = 0; t < n; ++t) {
+        if (RecentBuffer* b = recent_[t].load(std::memory_order_acquire)) b->unlock();
+    }
+}
+
+// Descarta el contenido de los buffers (con lockRecent hecho)
+void MemoryTracker::dropRecentLocked(std::uint32_t n) noexcept {
+    for (std::uint32_t t = 0; t < n; ++t) {
+        RecentBuffer* b = recent_[t].load(std::memory_order_acquire);
+        if (!b) continue;
+        for (void*& p : b->ptrs) p = nullptr;
+        rebuildFilterLocked(*b);
+        b->hits = b->hit_bytes = 0;
+        for (SiteTally& t : b->sites) t.count = 0;
+        for (std::uint64_t& c : b->lifetime) c = 0;
     }
 }
 
 // === Registro de liberacion ===
 
 // Se llama cada vez que se libera memoria
-void MemoryTracker::onFree(void* p, bool /*isArray*/) noexcept {
-    if (!p) return; // delete nullptr es válido y no hace nada
+bool MemoryTracker::onFree(void* p, bool /*isArray*/) noexcept {
+    if (!p) return false; // delete nullptr es válido y no hace nada
+    const std::uint64_t now = timestamps::now();
+
+    // 1. Buffer del propio hilo: el caso de los temporales, sin mu_
+    const std::uint32_t self_id = threads::t_id;
+    RecentBuffer* own = self_id ? recent_[self_id].load(std::memory_order_acquire) : nullptr;
+    if (own && mayHold(*own, p)) {
+        own->lock();
+        const bool hit = cancelRecentLocked(*own, p, now);
+        own->unlock();
+        if (hit) return true;
+    }
 
-    std::lock_guard<std::mutex> lock(mu_);
+    // 2. Buffer de otro hilo (free cruzado de un bloque reciente), solo
+    //    los que su filtro no descarta
+    if (recent_used_.load(std::memory_order_relaxed)) {
+        const std::uint32_t n = threads::slots_used();
+        for (std::uint32_t t = 0; t < n; ++t) {
+            RecentBuffer* b = recent_[t].load(std::memory_order_acquire);
+            if (!b || b == own || !mayHold(*b, p)) continue;
+            b->lock();
+            const bool hit = cancelRecentLocked(*b, p, now);
+            b->unlock();
+            if (hit) return true;
+        }
+    }
+
+    // 3. Tabla. Un registro solo se mueve de un buffer a la tabla, con el
+    //    lock del buffer y mu_ tomados y antes de que su bit se borre del
+    //    filtro: si no estaba en el buffer al paso 2, esta consulta lo ve.
+    return eraseFromTable(p, now);
+}
+
+// Quita p de la tabla si esta (toma mu_)
+bool MemoryTracker::eraseFromTable(void* p, std::uint64_t now) noexcept {
+    overhead::TimedLock lock(mu_);
 
     // Buscar el puntero en la tabla de bloques vivos
     auto it = live_.find(p);
     if (it != live_.end()) {
-        const auto sz = it->second.size; // Obtener tamaño del bloque
-
-        // Restar bytes activos (con seguridad para evitar underflow)
-        if (active_bytes_ >= sz) active_bytes_ -= sz;
-
-        // Decrementar contador de asignaciones activas
-        if (active_allocs_ > 0)  --active_allocs_;
+        if (it->second.timestamp) {
+            ++lifetime_hist_[lifetime_bucket(timestamps::elapsed_ns(it->second.timestamp, now))];
+        }
+        forgetLocked(it->second);
         live_.erase(it); // eliminamos el registro
+        return true;
     }
     // Si el puntero no estaba registrado, no hacer nada
     // (puede ser memoria asignada antes de activar el profiler)
     // Importante: no lanzar excepciones aqui
+    return false;
+}
+
+// Descuenta un bloque de metricas y agregados (requiere mu_ tomado)
+void MemoryTracker::forgetLocked(const AllocationRecord& r) noexcept {
+    const auto sz = r.size; // Obtener tamaño del bloque
+
+    // Restar bytes activos (con seguridad para evitar underflow)
+    if (active_bytes_ >= sz) active_bytes_ -= sz;
+    in_use_.fetch_sub(sz, std::memory_order_relaxed);
+
+    // Decrementar contador de asignaciones activas
+    if (active_allocs_ > 0)  --active_allocs_;
+    ++total_frees_;
+
+    // Descontar de los agregados (las entradas ya existen: las creo onAlloc)
+    auto site = by_site_.find(siteOf(r));
+    if (site != by_site_.end()) {
+        site->second.live_bytes -= sz;
+        --site->second.live_count;
+    }
+    threads::onFree(r.thread_id, sz);
+    const std::size_t b = size_histogram_bucket(sz);
+    --hist_count_[b];
+    hist_bytes_[b] -= sz;
+
+    sections::onFree(r.section, sz);
+}
+
+// === Traspaso entre modos de seguimiento ===
+
+// Vacia el tracker devolviendo lo que contenia. Los bloques vivos siguen
+// asignados (su free toma mu_ antes de llamar a free), asi que se puede
+// medir su tamaño utilizable aqui.
+MemoryTracker::Handoff MemoryTracker::drain(std::size_t (*usableSize)(void*)) {
+    ScopedHookGuard guard;
+    Handoff h;
+    std::unordered_map<void*, AllocationRecord> old;
+    const std::uint32_t n = lockRecent();
+    {
+        overhead::TimedLock lock(mu_);
+        // Los buffers entran a la tabla y sus cancelados a los totales
+        RecentSums sums;
+        for (std::uint32_t t = 0; t < n; ++t) {
+            if (RecentBuffer* b = recent_[t].load(std::memory_order_acquire)) promoteRecentLocked(*b, sums);
+        }
+        dropRecentLocked(n);
+        for (const auto& kv : live_) {
+            h.live_usable_bytes += usableSize ? usableSize(kv.first) : kv.second.size;
+        }
+        h.live_count   = live_.size();
+        h.total_allocs = total_allocs_ + sums.hits;
+        h.total_frees  = total_frees_ + sums.hits;
+        h.total_bytes  = total_bytes_ + sums.bytes;
+        h.peak         = peak_bytes_.load(std::memory_order_relaxed);
+        old.swap(live_);
+        clearLocked();
+    }
+    unlockRecent(n);
+    return h; // old se libera fuera del lock
+}
+
+// Pone todo en cero (tabla, metricas y agregados)
+void MemoryTracker::clearLocked() noexcept {
+    live_.clear();
+    sections::clearLive();
+    by_site_.clear();
+    threads::clearLive();
+    for (std::size_t i = 0; i < kSizeHistogramBuckets; ++i) {
+        hist_count_[i] = 0;
+        hist_bytes_[i] = 0;
+    }
+    for (std::uint64_t& c : lifetime_hist_) c = 0;
+    recent_promoted_ = 0;
+    total_allocs_ = active_allocs_ = total_frees_ = 0;
+    total_bytes_ = active_bytes_ = 0;
+    in_use_.store(0, std::memory_order_relaxed);
+    peak_bytes_.store(0, std::memory_order_relaxed);
+}
+
+void MemoryTracker::setBaseline(std::size_t (*bytesFn)()) {
+    overhead::TimedLock lock(mu_);
+    baseline_fn_.store(bytesFn, std::memory_order_relaxed);
 }
 
 // === Snapshot de bloques vivos ===
@@ -96,43 +407,135 @@ void MemoryTracker::onFree(void* p, bool /*isArray*/) noexcept {
 std::vector<AllocationRecord> MemoryTracker::snapshotLive() const {
     // Evita que las asignaciones internas del vector se auto-registren
     ScopedHookGuard guard;
+    overhead::ScopedTimer timer(OverheadMetric::Snapshot); // MP_SELF_PROFILE
+    flushRecent();
 
-    std::lock_guard<std::mutex> lock(mu_);
+    overhead::TimedLock lock(mu_);
     std::vector<AllocationRecord> out;
     out.reserve(live_.size());
     for (const auto& kv : live_) out.push_back(kv.second);
     return out;
 }
 
+// === Agregados ===
+
+// Devuelve metricas, top de callsites, uso por hilo e histograma de tamaños.
+// El lock solo cubre la copia de los contadores; el formateo va despues.
+AggregateStats MemoryTracker::aggregateStats(std::size_t topCallsites) const {
+    ScopedHookGuard guard;
+
+    AggregateStats out;
+    std::vector<std::pair<SiteKey, UsageCounters>> sites;
+    const RecentSums recent = flushRecent();
+    {
+        overhead::TimedLock lock(mu_);
+        out.bytes_in_use = active_bytes_;
+        out.peak         = peak_bytes_.load(std::memory_order_relaxed);
+        out.live_count   = active_allocs_;
+        out.total_allocs = total_allocs_ + recent.hits;
+        out.total_frees  = total_frees_ + recent.hits;
+        out.total_bytes  = total_bytes_ + recent.bytes;
+        sites.assign(by_site_.begin(), by_site_.end());
+        for (std::size_t i = 0; i < kSizeHistogramBuckets; ++i) {
+            out.size_hist_count[i] = hist_count_[i];
+            out.size_hist_bytes[i] = hist_bytes_[i];
+        }
+        for (std::size_t i = 0; i < kLifetimeBuckets; ++i) {
+            out.lifetime_hist[i] = lifetime_hist_[i] + recent.lifetime[i];
+        }
+        out.recent_hits     = recent.hits;
+        out.recent_promoted = recent_promoted_;
+    }
+    out.t_ns = nowNs();
+
+    // Por hilo, del registro (solo los que asignaron algo registrado)
+    for (auto& t : threads::snapshot().threads) {
+        if (t.counters.total_allocs == 0) continue;
+        ThreadUsage u;
+        u.thread_id    = t.id;
+        u.name         = std::move(t.name);
+        u.live_bytes   = t.counters.live_bytes;
+        u.live_count   = t.counters.live_count;
+        u.total_allocs = t.counters.total_allocs;
+        out.threads.push_back(std::move(u));
+    }
+
+    // Un mismo "file:line" puede venir de varios descriptores (un header
+    // incluido en varias unidades, o un tipo distinto): se fusiona por
+    // texto. Los sitios sin archivo se nombran por su PC, resuelto recien
+    // aqui.
+    std::unordered_map<std::string, CallsiteUsage> merged;
+    merged.reserve(sites.size());
+    for (const auto& kv : sites) {
+        const CallsiteDescriptor* d = callsite_descriptor(kv.first.callsite);
+        std::string name = (d && d->file && *d->file)
+                               ? std::string(d->file) + ":" + std::to_string(d->line)
+                               : pcs::symbolize(kv.first.pc_id);
+        CallsiteUsage& u = merged[name];
+        u.live_bytes   += kv.second.live_bytes;
+        u.live_count   += kv.second.live_count;
+        u.total_allocs += kv.second.total_allocs;
+    }
+    out.callsite_count = merged.size();
+
+    std::vector<CallsiteUsage> all;
+    all.reserve(merged.size());
+    for (auto& kv : merged) {
+        kv.second.callsite = kv.first;
+        all.push_back(std::move(kv.second));
+    }
+    auto byBytes = [](const CallsiteUsage& a, const CallsiteUsage& b) {
+        return a.live_bytes != b.live_bytes ? a.live_bytes > b.live_bytes : a.total_allocs > b.total_allocs;
+    };
+    const std::size_t n = std::min(topCallsites, all.size());
+    std::partial_sort(all.begin(), all.begin() + static_cast<std::ptrdiff_t>(n), all.end(), byBytes);
+    all.resize(n);
+    out.top_callsites = std::move(all);
+
+    std::sort(out.threads.begin(), out.threads.end(),
+              [](const ThreadUsage& a, const ThreadUsage& b) { return a.live_bytes > b.live_bytes; });
+    return out;
+}
+
 // === Metricas ===
 
 // Devuelve los bytes actualmente en uso
 std::size_t MemoryTracker::activeBytes() const {
-    std::lock_guard<std::mutex> lock(mu_);
+    flushRecent();
+    overhead::TimedLock lock(mu_);
     return active_bytes_;
 }
 
-// Devuelve el maximo historico de bytes usados
+// Devuelve el maximo historico de bytes usados (sin flush: el pico ya
+// cuenta los bloques de los buffers)
 std::size_t MemoryTracker::peakBytes() const {
-    std::lock_guard<std::mutex> lock(mu_);
-    return peak_bytes_;
+    return peak_bytes_.load(std::memory_order_relaxed);
 }
 
 // Devuelve el numero total de asignaciones realizadas
 std::size_t MemoryTracker::totalAllocs() const {
-    std::lock_guard<std::mutex> lock(mu_);
-    return total_allocs_;
+    const RecentSums recent = flushRecent();
+    overhead::TimedLock lock(mu_);
+    return total_allocs_ + recent.hits;
 }
 
 // Devuelve el numero de asignaciones actualmente activas
 std::size_t MemoryTracker::activeAllocs() const {
-    std::lock_guard<std::mutex> lock(mu_);
+    flushRecent();
+    overhead::TimedLock lock(mu_);
     return active_allocs_;
 }
 
 // Metodo auxiliar (actualmente no hace nada, reservado para pruebas)
 void MemoryTracker::resetForTesting() {
-    // Por ahora no-op. // TODO: permitir reset opcional bajo flag de desarrollo
+    ScopedHookGuard guard;
+    const std::uint32_t n = lockRecent();
+    {
+        overhead::TimedLock lock(mu_);
+        dropRecentLocked(n);
+        clearLocked();
+    }
+    unlockRecent(n);
 }
 
 } // namespace mp
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "../include/Modules.hpp"
+#include "../include/ReentryGuard.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+#include <elf.h>
+#include <link.h>
+
+namespace mp {
+namespace modules {
+
+namespace {
+
+  // Rango cargado de un objeto (segmento PT_LOAD) y su build id
+  struct LoadedRange {
+    std::uintptr_t start, end;
+    std::string    build_id;
+  };
+
+  std::string note_build_id(const dl_phdr_info* info, const ElfW(Phdr)& ph) {
+    const char* p   = reinterpret_cast<const char*>(info->dlpi_addr + ph.p_vaddr);
+    const char* end = p + ph.p_memsz;
+    while (p + sizeof(ElfW(Nhdr)) <= end) {
+      const auto* n = reinterpret_cast<const ElfW(Nhdr)*>(p);
+      const char* name = p + sizeof(ElfW(Nhdr));
+      const char* desc = name + ((n->n_namesz + 3) & ~3u);
+      if (n->n_type == NT_GNU_BUILD_ID && n->n_namesz == 4 && std::memcmp(name, "GNU", 4) == 0) {
+        static const char kHex[] = "0123456789abcdef";
+        std::string out;
+        for (std::uint32_t i = 0; i < n->n_descsz; ++i) {
+          const unsigned char c = static_cast<unsigned char>(desc[i]);
+          out += kHex[c >> 4];
+          out += kHex[c & 15];
+        }
+        return out;
+      }
+      p = desc + ((n->n_descsz + 3) & ~3u);
+    }
+    return "";
+  }
+
+  int on_object(dl_phdr_info* info, std::size_t, void* arg) {
+    auto& out = *static_cast<std::vector<LoadedRange>*>(arg);
+    std::string id;
+    for (int i = 0; i < info->dlpi_phnum && id.empty(); ++i) {
+      if (info->dlpi_phdr[i].p_type == PT_NOTE) id = note_build_id(info, info->dlpi_phdr[i]);
+    }
+    for (int i = 0; i < info->dlpi_phnum; ++i) {
+      const ElfW(Phdr)& ph = info->dlpi_phdr[i];
+      if (ph.p_type != PT_LOAD) continue;
+      const std::uintptr_t b = info->dlpi_addr + ph.p_vaddr;
+      out.push_back(LoadedRange{b, b + ph.p_memsz, id});
+    }
+    return 0;
+  }
+
+} // namespace
+
+std::vector<ModuleMapping> snapshot() {
+  ScopedHookGuard guard; // los vectores y strings temporales no se registran
+
+  std::vector<LoadedRange> loaded;
+  dl_iterate_phdr(&on_object, &loaded);
+
+  std::vector<ModuleMapping> out;
+  FILE* f = std::fopen("/proc/self/maps", "r");
+  if (!f) return out;
+  char line[4096];
+  while (std::fgets(line, sizeof(line), f)) {
+    unsigned long long start = 0, end = 0, offset = 0;
+    char perms[8] = {};
+    int path_at = 0;
+    if (std::sscanf(line, "%llx-%llx %7s %llx %*s %*s %n", &start, &end, perms, &offset, &path_at) < 4) continue;
+    if (!std::strchr(perms, 'x') || path_at <= 0 || line[path_at] != '/') continue;
+
+    ModuleMapping m;
+    m.start  = static_cast<std::uintptr_t>(start);
+    m.end    = static_cast<std::uintptr_t>(end);
+    m.offset = offset;
+    m.path   = line + path_at;
+    while (!m.path.empty() && (m.path.back() == '\n' || m.path.back() == ' ')) m.path.pop_back();
+    for (const LoadedRange& r : loaded) {
+      if (r.start <= m.start && m.start < r.end) { m.build_id = r.build_id; break; }
+    }
+    out.push_back(std::move(m));
+  }
+  std::fclose(f);
+  return out;
+}
+
+} // namespace modules
+} // namespace mp
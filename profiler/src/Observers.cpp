@@ -0,0 +1,194 @@
+#include "../include/Observers.hpp"
+#include "../include/Epoch.hpp"
+#include "../include/ReentryGuard.hpp"
+#include "../include/Timestamp.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+namespace mp {
+namespace observers {
+
+namespace {
+
+  // Lista publicada; inmutable desde que se publica
+  struct List {
+    std::uint32_t count = 0;
+    std::uint32_t slot[kMaxObservers] = {};   // slot = id - 1
+    AllocObserver obs[kMaxObservers];
+  };
+
+  // Contadores por slot, fuera de la lista para que sobrevivan a las
+  // republicaciones. Una linea de cache por observador.
+  struct alignas(64) Counters {
+    std::atomic<std::uint64_t> allocs{0};
+    std::atomic<std::uint64_t> frees{0};
+    std::atomic<std::uint64_t> skipped{0};
+    std::atomic<std::uint64_t> ns{0};
+  };
+
+  std::atomic<const List*> g_list{nullptr};
+  Counters g_counters[kMaxObservers];
+  bool     g_slot_used[kMaxObservers] = {};   // con publish_mutex
+
+  // Asignaciones que faltan para la proxima muestra, por hilo y slot
+  thread_local std::uint32_t t_until_sample[kMaxObservers] = {};
+
+  std::mutex& publish_mutex() {
+    static std::mutex m;
+    return m;
+  }
+
+  void delete_list(void* p) {
+    ScopedHookGuard guard;
+    delete static_cast<List*>(p);
+  }
+
+  // Publica l (nullptr = sin observadores) y retira la anterior (con publish_mutex)
+  void publish(List* l) {
+    const List* old = g_list.exchange(l, std::memory_order_seq_cst);
+    g_any.store(l != nullptr, std::memory_order_relaxed);
+    epoch::retire(const_cast<List*>(old), &delete_list);
+  }
+
+  // Suma a c el tiempo desde t0 y devuelve el instante actual, que sirve
+  // de inicio al siguiente observador (una lectura del reloj por llamada)
+  std::uint64_t add_ns(Counters& c, std::uint64_t t0) noexcept {
+    const std::uint64_t t1 = timestamps::now();
+    c.ns.fetch_add(timestamps::elapsed_ns(t0, t1), std::memory_order_relaxed);
+    return t1;
+  }
+
+} // namespace
+
+std::uint32_t add(const AllocObserver& o) {
+  if (!o.onAlloc && !o.onFree) return 0;
+  ScopedHookGuard guard;
+  std::lock_guard<std::mutex> lock(publish_mutex());
+  const List* cur = g_list.load(std::memory_order_acquire);
+  if (cur && cur->count == kMaxObservers) return 0;
+
+  std::uint32_t s = 0;
+  while (g_slot_used[s]) ++s;
+  g_slot_used[s] = true;
+  // El slot quedo libre tras un remove, que ya espero a los lectores
+  g_counters[s].allocs.store(0, std::memory_order_relaxed);
+  g_counters[s].frees.store(0, std::memory_order_relaxed);
+  g_counters[s].skipped.store(0, std::memory_order_relaxed);
+  g_counters[s].ns.store(0, std::memory_order_relaxed);
+
+  List* l = cur ? new List(*cur) : new List();
+  l->slot[l->count] = s;
+  l->obs[l->count]  = o;
+  if (l->obs[l->count].sample_every == 0) l->obs[l->count].sample_every = 1;
+  ++l->count;
+  publish(l);
+  return s + 1;
+}
+
+bool remove(std::uint32_t id) {
+  {
+    ScopedHookGuard guard;
+    std::lock_guard<std::mutex> lock(publish_mutex());
+    const List* cur = g_list.load(std::memory_order_acquire);
+    if (!cur || id == 0 || id > kMaxObservers) return false;
+    if (std::find(cur->slot, cur->slot + cur->count, id - 1) == cur->slot + cur->count) return false;
+
+    List* l = nullptr;
+    if (cur->count > 1) {
+      l = new List();
+      for (std::uint32_t i = 0; i < cur->count; ++i) {
+        if (cur->slot[i] == id - 1) continue;
+        l->slot[l->count] = cur->slot[i];
+        l->obs[l->count]  = cur->obs[i];
+        ++l->count;
+      }
+    }
+    publish(l);
+  }
+  // Hooks que aun recorren la lista vieja pueden estar llamando al
+  // observador: el slot (y ctx) se liberan cuando salieron
+  epoch::synchronize();
+  std::lock_guard<std::mutex> lock(publish_mutex());
+  g_slot_used[id - 1] = false;
+  return true;
+}
+
+void notifyAlloc(void* p, std::size_t sz, bool isArray) noexcept {
+  if (in_hook) return; // asignaciones del profiler o de un observador
+  in_hook = true;
+  {
+    epoch::ReadGuard rg;
+    if (const List* l = g_list.load(std::memory_order_acquire)) {
+      std::uint64_t t = timestamps::now();
+      for (std::uint32_t i = 0; i < l->count; ++i) {
+        const AllocObserver& o = l->obs[i];
+        if (!o.onAlloc) continue;
+        Counters& c = g_counters[l->slot[i]];
+        if (sz < o.min_size || sz > o.max_size) {
+          c.skipped.fetch_add(1, std::memory_order_relaxed);
+          continue;
+        }
+        if (o.sample_every > 1) {
+          std::uint32_t& until = t_until_sample[l->slot[i]];
+          if (until > 1) {
+            --until;
+            c.skipped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+          }
+          until = o.sample_every;
+        }
+        o.onAlloc(o.ctx, p, sz, isArray);
+        t = add_ns(c, t);
+        c.allocs.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+  in_hook = false;
+}
+
+void notifyFree(void* p, std::size_t sz, bool isArray) noexcept {
+  if (in_hook) return;
+  in_hook = true;
+  {
+    epoch::ReadGuard rg;
+    if (const List* l = g_list.load(std::memory_order_acquire)) {
+      std::uint64_t t = timestamps::now();
+      for (std::uint32_t i = 0; i < l->count; ++i) {
+        const AllocObserver& o = l->obs[i];
+        if (!o.onFree) continue;
+        Counters& c = g_counters[l->slot[i]];
+        o.onFree(o.ctx, p, sz, isArray);
+        t = add_ns(c, t);
+        c.frees.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+  in_hook = false;
+}
+
+std::vector<ObserverUsage> snapshot() {
+  ScopedHookGuard guard;
+  std::vector<ObserverUsage> out;
+  std::lock_guard<std::mutex> lock(publish_mutex());
+  const List* l = g_list.load(std::memory_order_acquire);
+  if (!l) return out;
+  out.reserve(l->count);
+  for (std::uint32_t i = 0; i < l->count; ++i) {
+    const Counters& c = g_counters[l->slot[i]];
+    ObserverUsage u;
+    u.id      = l->slot[i] + 1;
+    u.name    = l->obs[i].name ? l->obs[i].name : "";
+    u.allocs  = c.allocs.load(std::memory_order_relaxed);
+    u.frees   = c.frees.load(std::memory_order_relaxed);
+    u.skipped = c.skipped.load(std::memory_order_relaxed);
+    u.ns      = c.ns.load(std::memory_order_relaxed);
+    out.push_back(std::move(u));
+  }
+  std::sort(out.begin(), out.end(),
+            [](const ObserverUsage& a, const ObserverUsage& b) { return a.id < b.id; });
+  return out;
+}
+
+} // namespace observers
+} // namespace mp
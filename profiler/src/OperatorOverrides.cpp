@@ -1,95 +1,174 @@
-#include "../include/OperatorOverrides.hpp"
-#include "../include/ProfilerNew.hpp"
-#include "../include/Callbacks.hpp"
-#include "../include/Callsite.hpp"
-
-#include <new>
-#include <cstdlib>
-
-// Variable thread_local que previene recursión infinita
-// Si in_hook=true, significa que YA estamos dentro de un hook
-// y NO debemos volver a llamar callbacks
-namespace mp { thread_local bool in_hook = false; }
-
-// === Sobrecarga del operador new ===
-void* operator new(std::size_t sz) {
-  // 1. Si tamaño es 0, ajustar a 1 (estándar C++)
-  if (sz == 0) sz = 1;
-
-  // 2. Asignar memoria con malloc (NO con new, ¡evita recursión!)
-  void* p = std::malloc(sz);
-  if (!p) throw std::bad_alloc{}; // Si falla, lanzar excepción
-
-  // 3. Si NO estamos en recursión, registrar la asignación
-  if (!mp::in_hook) {
-    mp::in_hook = true; // Activar flag de recursión
-
-    const auto& cb = mp::get_callbacks(); // Obtener callbacks registrados
-
-    // CRÍTICO: Capturar callsite ANTES de cualquier operación
-    // Esto obtiene: archivo, línea, tipo
-    auto cs = mp::currentCallsite();
-
-    // Notificar al sistema que se asignó memoria
-    // Parámetros: ptr, tamaño, tipo, archivo, línea, es_array
-    cb.onAlloc(p, sz, cs.type_name, cs.file, cs.line, false);
-
-    // Limpiar callsite para la próxima asignación
-    mp::clearCallsite();
-
-    mp::in_hook = false; // Desactivar flag
-  }
-  return p; // Retornar el puntero asignado
-}
-
-// === Sobrecarga del operador delete ===
-void operator delete(void* p) noexcept {
-  if (!p) return;
-  if (!mp::in_hook) {
-    mp::in_hook = true;
-    const auto& cb = mp::get_callbacks();
-    cb.onFree(p);
-    mp::in_hook = false;
-  }
-  std::free(p);
-}
-
-// === Sobrecarga del operador new[] ===
-void* operator new[](std::size_t sz) {
-  if (sz == 0) sz = 1;
-  void* p = std::malloc(sz);
-  if (!p) throw std::bad_alloc{};
-
-  if (!mp::in_hook) {
-    mp::in_hook = true;
-    const auto& cb = mp::get_callbacks();
-
-    // IMPORTANTE: Capturar callsite ANTES de cualquier operación
-    auto cs = mp::currentCallsite();
-
-    // Notificar asignación de arreglo
-    cb.onAlloc(p, sz, cs.type_name, cs.file, cs.line, true);
-
-    // Limpiar callsite DESPUÉS de notificar
-    mp::clearCallsite();
-
-    mp::in_hook = false;
-  }
-  return p;
-}
-
-// === Sobrecarga del operador delete[] ===
-void operator delete[](void* p) noexcept {
-  if (!p) return;
-  if (!mp::in_hook) {
-    mp::in_hook = true;
-    const auto& cb = mp::get_callbacks();
-    cb.onFree(p);
-    mp::in_hook = false;
-  }
-  std::free(p);
-}
-
-// === Sobrecargas de delete con tamaño ===
-void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
-void operator delete[](void* p, std::size_t) noexcept { operator delete[](p); }
\ No newline at end of file
+#include "../include/OperatorOverrides.hpp"
+#include "../include/CallerPc.hpp"
+#include "../include/Observers.hpp"
+#include "../include/Overhead.hpp"
+#include "../include/ProfilerNew.hpp"
+#include "../include/TrackingPolicies.hpp"
+
+#include <new>
+#include <cstdlib>
+
+// Variable thread_local que previene recursión infinita
+// Si in_hook=true, significa que YA estamos dentro de un hook
+// y NO debemos volver a llamar callbacks
+namespace mp { thread_local bool in_hook = false; }
+
+namespace {
+
+  // El id de MP_TAG_CALLSITE vale para una sola asignacion: se descarta al
+  // salir del hook aunque la politica no haya registrado el bloque
+  // (counters, detenido, sampled sin muestra). Las asignaciones internas
+  // del profiler (in_hook) no lo tocan.
+  struct CallsiteIdConsumer {
+    ~CallsiteIdConsumer() {
+      if (!mp::in_hook) mp::g_callsite_id = 0;
+    }
+  };
+
+  // Hook de asignacion, plantilla sobre la politica elegida en CMake.
+  // Con politicas estaticas todo se inlinea: no hay call_once ni std::function.
+  // `caller` es la direccion de retorno de operator new: se toma en el
+  // operador mismo, no aqui, para que sea la del codigo que pidio memoria.
+  template <class Policy>
+  inline void* hooked_new(std::size_t sz, bool isArray, const void* caller,
+                          std::size_t align = 0) {
+    // 1. Si tamaño es 0, ajustar a 1 (estándar C++)
+    if (sz == 0) sz = 1;
+    CallsiteIdConsumer consume;
+
+    // 2. Asignar memoria con malloc (NO con new, ¡evita recursión!); la
+    //    politica Header pide lugar para su encabezado. Las formas con
+    //    align_val_t usan posix_memalign si malloc no alcanza.
+    void* p = nullptr;
+    if constexpr (Policy::kHeaderPrefix) {
+      p = mp::header::allocate(sz, align);
+    } else if (align > alignof(std::max_align_t)) {
+      if (posix_memalign(&p, align, sz) != 0) p = nullptr;
+    } else {
+      p = std::malloc(sz);
+    }
+    if (!p) return nullptr; // las formas que lanzan tiran bad_alloc
+    mp::overhead::HookTimer timer(mp::OverheadMetric::HookAlloc); // MP_SELF_PROFILE
+
+    // 3. Profiler detenido (mp::stop): sin trabajo por bloque
+    if (!mp::policy::Enabled::get()) {
+      Policy::onAllocStopped(p, sz, isArray);
+      return p;
+    }
+
+    // 4. Notificar a la politica (ella maneja in_hook y el callsite)
+#if MP_CALLER_PC
+    mp::g_caller_pc = caller;
+#else
+    (void)caller;
+#endif
+    Policy::onAlloc(p, sz, isArray);
+
+    // 5. Observadores (mp::observers), si hay alguno
+    if (mp::observers::any()) mp::observers::notifyAlloc(p, sz, isArray);
+    return p;
+  }
+
+  inline void* or_throw(void* p) {
+    if (!p) throw std::bad_alloc{}; // Si falla, lanzar excepción
+    return p;
+  }
+
+  std::size_t align_of(std::align_val_t al) noexcept { return static_cast<std::size_t>(al); }
+
+  // Hook de liberacion. sz es el tamaño del sized delete (0 = desconocido);
+  // solo llega a los observadores.
+  template <class Policy>
+  inline void hooked_delete(void* p, bool isArray, std::size_t sz = 0) noexcept {
+    if (!p) return;
+    {
+      mp::overhead::HookTimer timer(mp::OverheadMetric::HookFree); // MP_SELF_PROFILE
+      // Detenido: se siguen descontando los bloques registrados antes del stop
+      if (mp::policy::Enabled::get()) Policy::onFree(p, isArray);
+      else Policy::onFreeStopped(p, isArray);
+      if (mp::observers::any()) mp::observers::notifyFree(p, sz, isArray);
+    }
+    if constexpr (Policy::kHeaderPrefix) mp::header::release(p);
+    else std::free(p);
+  }
+
+} // namespace
+
+// === Sobrecarga del operador new ===
+void* operator new(std::size_t sz) {
+  return or_throw(hooked_new<mp::ActivePolicy>(sz, false, __builtin_return_address(0)));
+}
+
+// === Sobrecarga del operador delete ===
+void operator delete(void* p) noexcept {
+  hooked_delete<mp::ActivePolicy>(p, false);
+}
+
+// === Sobrecarga del operador new[] ===
+void* operator new[](std::size_t sz) {
+  return or_throw(hooked_new<mp::ActivePolicy>(sz, true, __builtin_return_address(0)));
+}
+
+// === Sobrecarga del operador delete[] ===
+void operator delete[](void* p) noexcept {
+  hooked_delete<mp::ActivePolicy>(p, true);
+}
+
+// === Sobrecargas de delete con tamaño ===
+// El tamaño es el que se paso a new; se reporta a los observadores
+void operator delete(void* p, std::size_t sz) noexcept {
+  hooked_delete<mp::ActivePolicy>(p, false, sz);
+}
+void operator delete[](void* p, std::size_t sz) noexcept {
+  hooked_delete<mp::ActivePolicy>(p, true, sz);
+}
+
+// === Formas nothrow ===
+// Sin ellas libstdc++ las implementa llamando a las de arriba dentro de un
+// try: funciona, pero la direccion de retorno seria la de libstdc++
+void* operator new(std::size_t sz, const std::nothrow_t&) noexcept {
+  return hooked_new<mp::ActivePolicy>(sz, false, __builtin_return_address(0));
+}
+void* operator new[](std::size_t sz, const std::nothrow_t&) noexcept {
+  return hooked_new<mp::ActivePolicy>(sz, true, __builtin_return_address(0));
+}
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+  hooked_delete<mp::ActivePolicy>(p, false);
+}
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+  hooked_delete<mp::ActivePolicy>(p, true);
+}
+
+// === Formas con alineacion (tipos sobrealineados, C++17) ===
+// Las de libstdc++ asignan con aligned_alloc y liberan con free sin pasar
+// por el hook: el bloque no se registraba
+void* operator new(std::size_t sz, std::align_val_t al) {
+  return or_throw(hooked_new<mp::ActivePolicy>(sz, false, __builtin_return_address(0), align_of(al)));
+}
+void* operator new[](std::size_t sz, std::align_val_t al) {
+  return or_throw(hooked_new<mp::ActivePolicy>(sz, true, __builtin_return_address(0), align_of(al)));
+}
+void* operator new(std::size_t sz, std::align_val_t al, const std::nothrow_t&) noexcept {
+  return hooked_new<mp::ActivePolicy>(sz, false, __builtin_return_address(0), align_of(al));
+}
+void* operator new[](std::size_t sz, std::align_val_t al, const std::nothrow_t&) noexcept {
+  return hooked_new<mp::ActivePolicy>(sz, true, __builtin_return_address(0), align_of(al));
+}
+void operator delete(void* p, std::align_val_t) noexcept {
+  hooked_delete<mp::ActivePolicy>(p, false);
+}
+void operator delete[](void* p, std::align_val_t) noexcept {
+  hooked_delete<mp::ActivePolicy>(p, true);
+}
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+  hooked_delete<mp::ActivePolicy>(p, false);
+}
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+  hooked_delete<mp::ActivePolicy>(p, true);
+}
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+  hooked_delete<mp::ActivePolicy>(p, false);
+}
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+  hooked_delete<mp::ActivePolicy>(p, true);
+}
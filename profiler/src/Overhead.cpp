@@ -0,0 +1,103 @@
+#include "../include/Overhead.hpp"
+#include "../include/ReentryGuard.hpp"
+#include "../include/ThreadRegistry.hpp"
+
+namespace mp {
+
+const char* overhead_metric_name(OverheadMetric m) noexcept {
+  switch (m) {
+  case OverheadMetric::HookAlloc: return "hook_alloc";
+  case OverheadMetric::HookFree:  return "hook_free";
+  case OverheadMetric::LockWait:  return "lock_wait";
+  case OverheadMetric::LockHold:  return "lock_hold";
+  case OverheadMetric::Snapshot:  return "snapshot_live";
+  }
+  return "?";
+}
+
+namespace overhead {
+
+#if MP_SELF_PROFILE
+
+namespace {
+
+  // Histogramas de un hilo. Solo el hilo dueño escribe (salvo el id 0, que
+  // comparten los hilos sin registrar), pero se leen desde las consultas.
+  struct alignas(64) ThreadHist {
+    std::atomic<std::uint64_t> count[kOverheadMetrics] = {};
+    std::atomic<std::uint64_t> total[kOverheadMetrics] = {};
+    std::atomic<std::uint64_t> max[kOverheadMetrics]   = {};
+    std::atomic<std::uint64_t> hist[kOverheadMetrics][kOverheadBuckets] = {};
+  };
+
+  // Uno por id de hilo; se crean en la primera medicion y no se liberan
+  // (un id reciclado sigue sumando sobre el mismo)
+  std::atomic<ThreadHist*> g_hists[threads::kMaxThreads] = {};
+
+  ThreadHist* hist_for(std::uint32_t id) noexcept {
+    ThreadHist* h = g_hists[id].load(std::memory_order_acquire);
+    if (h) return h;
+    ScopedHookGuard guard;
+    ThreadHist* fresh = new ThreadHist();
+    if (g_hists[id].compare_exchange_strong(h, fresh, std::memory_order_acq_rel)) return fresh;
+    delete fresh; // otro hilo sin id se adelanto
+    return h;
+  }
+
+  std::size_t bucket(std::uint64_t t) noexcept {
+    const std::size_t b = 63 - static_cast<std::size_t>(__builtin_clzll(t | 1));
+    return b < kOverheadBuckets ? b : kOverheadBuckets - 1;
+  }
+
+} // namespace
+
+void record(OverheadMetric m, std::uint64_t t) noexcept {
+  ThreadHist* h = hist_for(threads::current());
+  const auto i = static_cast<std::size_t>(m);
+  h->count[i].fetch_add(1, std::memory_order_relaxed);
+  h->total[i].fetch_add(t, std::memory_order_relaxed);
+  h->hist[i][bucket(t)].fetch_add(1, std::memory_order_relaxed);
+  std::uint64_t prev = h->max[i].load(std::memory_order_relaxed);
+  while (t > prev && !h->max[i].compare_exchange_weak(prev, t, std::memory_order_relaxed)) {}
+}
+
+OverheadSnapshot snapshot() {
+  ScopedHookGuard guard;
+  OverheadSnapshot s;
+  s.enabled      = true;
+  s.sample_every = MP_SELF_PROFILE_SAMPLE;
+#if MP_HAVE_RDTSC
+  s.cycles      = true;
+  s.ns_per_tick = timestamps::Converter().ns_per_tick();
+#endif
+  const std::uint32_t n = threads::slots_used();
+  for (std::uint32_t id = 0; id < n; ++id) {
+    const ThreadHist* h = g_hists[id].load(std::memory_order_acquire);
+    if (!h) continue;
+    OverheadSnapshot::Thread t;
+    t.thread_id = id;
+    for (std::size_t i = 0; i < kOverheadMetrics; ++i) {
+      OverheadCounters& c = t.metrics[i];
+      c.count       = h->count[i].load(std::memory_order_relaxed);
+      c.total_ticks = h->total[i].load(std::memory_order_relaxed);
+      c.max_ticks   = h->max[i].load(std::memory_order_relaxed);
+      s.total[i].count       += c.count;
+      s.total[i].total_ticks += c.total_ticks;
+      if (c.max_ticks > s.total[i].max_ticks) s.total[i].max_ticks = c.max_ticks;
+      for (std::size_t b = 0; b < kOverheadBuckets; ++b) {
+        s.hist[i][b] += h->hist[i][b].load(std::memory_order_relaxed);
+      }
+    }
+    s.threads.push_back(t);
+  }
+  return s;
+}
+
+#else
+
+OverheadSnapshot snapshot() { return OverheadSnapshot{}; }
+
+#endif
+
+} // namespace overhead
+} // namespace mp
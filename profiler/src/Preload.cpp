@@ -0,0 +1,446 @@
+// libmp_preload.so: perfila un programa sin recompilarlo.
+//
+//   LD_PRELOAD=./libmp_preload.so ./programa
+//
+// Reemplaza la familia malloc (malloc, calloc, realloc, free, memalign,
+// posix_memalign, aligned_alloc, valloc, pvalloc, malloc_usable_size) y
+// mmap/munmap, y pasa cada bloque a la politica de CMake igual que el hook
+// de operator new. La .so no trae OperatorOverrides: el new/delete de
+// libstdc++ termina en este malloc, asi que cada bloque se cuenta una vez
+// (sin isArray ni sized delete, y con el PC dentro de operator new).
+//
+// Las funciones reales se piden con dlsym(RTLD_NEXT). dlsym puede asignar
+// (calloc para el error de dlerror, por ejemplo) antes de tener malloc: esas
+// asignaciones salen de un buffer estatico y nunca se devuelven.
+//
+// El constructor instala los callbacks, aplica las variables de entorno y
+// arranca SocketClient. Lo asignado antes (constructores de libc y
+// libstdc++) no se registra.
+
+#include "../include/CallbacksRegistration.hpp"
+#include "../include/CallerPc.hpp"
+#include "../include/MmapStats.hpp"
+#include "../include/Observers.hpp"
+#include "../include/Overhead.hpp"
+#include "../include/ReentryGuard.hpp"
+#include "../include/SocketClient.hpp"
+#include "../include/TrackingMode.hpp"
+#include "../include/TrackingPolicies.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+
+#include <dlfcn.h>
+#include <malloc.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Sin OperatorOverrides en la .so, la bandera de reentrada se define aqui
+namespace mp { thread_local bool in_hook = false; }
+
+namespace {
+
+  using MallocFn        = void* (*)(std::size_t);
+  using FreeFn          = void  (*)(void*);
+  using CallocFn        = void* (*)(std::size_t, std::size_t);
+  using ReallocFn       = void* (*)(void*, std::size_t);
+  using MemalignFn      = void* (*)(std::size_t, std::size_t);
+  using PosixMemalignFn = int   (*)(void**, std::size_t, std::size_t);
+  using UsableFn        = std::size_t (*)(void*);
+  using MmapFn          = void* (*)(void*, std::size_t, int, int, int, off_t);
+  using Mmap64Fn        = void* (*)(void*, std::size_t, int, int, int, off64_t);
+  using MunmapFn        = int   (*)(void*, std::size_t);
+
+  struct Real {
+    MallocFn        malloc         = nullptr;
+    FreeFn          free           = nullptr;
+    CallocFn        calloc         = nullptr;
+    ReallocFn       realloc        = nullptr;
+    MemalignFn      memalign       = nullptr;
+    PosixMemalignFn posix_memalign = nullptr;
+    MemalignFn      aligned_alloc  = nullptr;
+    MallocFn        valloc         = nullptr;
+    MallocFn        pvalloc        = nullptr;
+    UsableFn        usable         = nullptr;
+    MmapFn          mmap           = nullptr;
+    Mmap64Fn        mmap64         = nullptr;
+    MunmapFn        munmap         = nullptr;
+  };
+
+  Real g_real;
+  std::atomic<int>  g_resolve{0};     // 0 = sin resolver, 1 = en dlsym, 2 = listo
+  std::atomic<bool> g_ready{false};   // el constructor termino: se registra
+
+  template <class Fn>
+  Fn next(const char* name) noexcept {
+    return reinterpret_cast<Fn>(dlsym(RTLD_NEXT, name));
+  }
+
+  // Se llena una copia local y se publica al final: mientras dlsym corre,
+  // todo cae en el buffer de arranque (tambien un free de algo de ahi)
+  void resolve() noexcept {
+    int expected = 0;
+    if (!g_resolve.compare_exchange_strong(expected, 1, std::memory_order_acq_rel)) return;
+    Real r;
+    r.malloc         = next<MallocFn>("malloc");
+    r.free           = next<FreeFn>("free");
+    r.calloc         = next<CallocFn>("calloc");
+    r.realloc        = next<ReallocFn>("realloc");
+    r.memalign       = next<MemalignFn>("memalign");
+    r.posix_memalign = next<PosixMemalignFn>("posix_memalign");
+    r.aligned_alloc  = next<MemalignFn>("aligned_alloc");
+    r.valloc         = next<MallocFn>("valloc");
+    r.pvalloc        = next<MallocFn>("pvalloc");
+    r.usable         = next<UsableFn>("malloc_usable_size");
+    r.mmap           = next<MmapFn>("mmap");
+    r.mmap64         = next<Mmap64Fn>("mmap64");
+    r.munmap         = next<MunmapFn>("munmap");
+    if (!r.malloc || !r.free || !r.calloc || !r.realloc || !r.mmap || !r.munmap) {
+      static const char msg[] = "[mp] libmp_preload: dlsym(RTLD_NEXT) no encontro malloc/mmap\n";
+      ssize_t w = ::write(2, msg, sizeof(msg) - 1);
+      (void)w;
+      std::abort();
+    }
+    g_real = r;
+    g_resolve.store(2, std::memory_order_release);
+  }
+
+  inline bool resolved() noexcept {
+    if (g_resolve.load(std::memory_order_acquire) == 2) return true;
+    resolve();
+    return g_resolve.load(std::memory_order_acquire) == 2;
+  }
+
+  // === Buffer de arranque (asignaciones de dlsym) ===
+  // Asignador lineal: cada bloque lleva su tamaño en los 8 bytes previos.
+  constexpr std::size_t kBootBytes = 256 * 1024;
+  alignas(4096) char g_boot[kBootBytes];
+  std::atomic<std::size_t> g_boot_used{0};
+
+  bool is_boot(const void* p) noexcept {
+    const char* c = static_cast<const char*>(p);
+    return c >= g_boot && c < g_boot + kBootBytes;
+  }
+
+  void* boot_alloc(std::size_t sz, std::size_t align) noexcept {
+    align = std::max<std::size_t>(align, 16);
+    std::size_t used = g_boot_used.load(std::memory_order_relaxed);
+    std::size_t off;
+    do {
+      off = (used + sizeof(std::size_t) + align - 1) & ~(align - 1);
+      if (off > kBootBytes || sz > kBootBytes - off) return nullptr;
+    } while (!g_boot_used.compare_exchange_weak(used, off + sz, std::memory_order_relaxed));
+    std::memcpy(g_boot + off - sizeof(std::size_t), &sz, sizeof(sz));
+    return g_boot + off; // memoria estatica: ya esta en cero
+  }
+
+  std::size_t boot_size(const void* p) noexcept {
+    std::size_t sz;
+    std::memcpy(&sz, static_cast<const char*>(p) - sizeof(std::size_t), sizeof(sz));
+    return sz;
+  }
+
+  // === Hook (mismos pasos que hooked_new/hooked_delete) ===
+  inline void track_alloc(void* p, std::size_t sz, const void* caller) {
+    if (!g_ready.load(std::memory_order_relaxed)) return;
+    mp::overhead::HookTimer timer(mp::OverheadMetric::HookAlloc);
+    if (!mp::policy::Enabled::get()) {
+      mp::ActivePolicy::onAllocStopped(p, sz, false);
+      return;
+    }
+#if MP_CALLER_PC
+    mp::g_caller_pc = caller;
+#else
+    (void)caller;
+#endif
+    mp::ActivePolicy::onAlloc(p, sz, false);
+    if (mp::observers::any()) mp::observers::notifyAlloc(p, sz, false);
+  }
+
+  inline void track_free(void* p) noexcept {
+    if (!g_ready.load(std::memory_order_relaxed)) return;
+    mp::overhead::HookTimer timer(mp::OverheadMetric::HookFree);
+    if (!mp::policy::Enabled::get()) mp::ActivePolicy::onFreeStopped(p, false);
+    else mp::ActivePolicy::onFree(p, false);
+    if (mp::observers::any()) mp::observers::notifyFree(p, 0, false);
+  }
+
+  // Si realloc falla, el bloque viejo sigue vivo: se vuelve a registrar con
+  // su tamaño utilizable (el pedido original ya no se conoce)
+  inline void retrack(void* p, const void* caller) {
+    track_alloc(p, g_real.usable ? g_real.usable(p) : 0, caller);
+  }
+
+  // === Regiones mmap anonimas ===
+  // La tabla usa el malloc real: sus nodos no pasan por el hook
+  template <class T>
+  struct RealAllocator {
+    using value_type = T;
+    RealAllocator() = default;
+    template <class U> RealAllocator(const RealAllocator<U>&) noexcept {}
+    T* allocate(std::size_t n) {
+      void* p = g_real.malloc(n * sizeof(T));
+      if (!p) throw std::bad_alloc{};
+      return static_cast<T*>(p);
+    }
+    void deallocate(T* p, std::size_t) noexcept { g_real.free(p); }
+    template <class U> bool operator==(const RealAllocator<U>&) const noexcept { return true; }
+    template <class U> bool operator!=(const RealAllocator<U>&) const noexcept { return false; }
+  };
+
+  // inicio -> fin, sin solaparse
+  using RegionMap = std::map<std::uintptr_t, std::uintptr_t, std::less<std::uintptr_t>,
+                             RealAllocator<std::pair<const std::uintptr_t, std::uintptr_t>>>;
+
+  std::mutex     g_regions_mu;
+  std::uintptr_t g_page = 4096;
+
+  // Nunca se destruye: puede haber munmap despues de los destructores
+  RegionMap& regions() {
+    static RegionMap* m = new (g_real.malloc(sizeof(RegionMap))) RegionMap();
+    return *m;
+  }
+
+  std::uintptr_t page_up(std::size_t len) noexcept {
+    return (static_cast<std::uintptr_t>(len) + g_page - 1) & ~(g_page - 1);
+  }
+
+  void remove_range(std::uintptr_t a, std::uintptr_t b);
+
+  // Un MAP_FIXED sobre una region anotada la reemplaza: primero se quita
+  void add_region(void* addr, std::size_t len) {
+    const auto start = reinterpret_cast<std::uintptr_t>(addr);
+    const std::uintptr_t bytes = page_up(len);
+    std::lock_guard<std::mutex> lock(g_regions_mu);
+    remove_range(start, start + bytes);
+    regions()[start] = start + bytes;
+    mp::mmaps::onMap(bytes);
+  }
+
+  // Quita [a, b) de la tabla; un munmap parcial recorta o parte regiones
+  void remove_range(std::uintptr_t a, std::uintptr_t b) {
+    RegionMap& m = regions();
+    auto it = m.upper_bound(a);
+    if (it != m.begin()) --it;
+    std::uint64_t bytes = 0;
+    std::int64_t gone = 0;
+    while (it != m.end() && it->first < b) {
+      const std::uintptr_t s = it->first, e = it->second;
+      if (e <= a) { ++it; continue; }
+      it = m.erase(it);
+      ++gone;
+      bytes += std::min(e, b) - std::max(s, a);
+      if (s < a) { m.emplace(s, a); --gone; }
+      if (e > b) { it = m.emplace(b, e).first; ++it; --gone; }
+    }
+    if (bytes) mp::mmaps::onUnmap(bytes, gone);
+  }
+
+  // mmap anonimo con exito y con el profiler listo
+  inline bool counts(void* r, int flags) noexcept {
+    return r != MAP_FAILED && (flags & MAP_ANONYMOUS) &&
+           g_ready.load(std::memory_order_relaxed) && !mp::in_hook;
+  }
+
+  // === Arranque ===
+  mp::SocketClient* g_client = nullptr;
+
+  void stop_client() {
+    if (g_client) g_client->stop();
+    g_ready.store(false, std::memory_order_relaxed);
+  }
+
+  const char* env_or(const char* name, const char* fallback) {
+    const char* v = std::getenv(name);
+    return (v && *v) ? v : fallback;
+  }
+
+  __attribute__((constructor)) void mp_preload_init() {
+    resolve();
+    g_page = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+    {
+      mp::ScopedHookGuard guard;
+      regions();
+      mp::install_callbacks_with_memorytracker();
+
+      // MP_MODE: modo inicial (solo con la politica Dynamic)
+      if (const char* mode = std::getenv("MP_MODE")) {
+        mp::TrackingMode m;
+        std::string err;
+        if (!mp::tracking_mode_from_name(mode, m)) err = "modo desconocido";
+        else mp::set_tracking_mode(m, &err);
+        if (!err.empty()) std::fprintf(stderr, "[mp] MP_MODE=%s: %s\n", mode, err.c_str());
+      }
+    }
+    g_ready.store(true, std::memory_order_release);
+
+    // MP_CONNECT=0: solo registrar (sin GUI), p.ej. para medir el overhead
+    if (std::strcmp(env_or("MP_CONNECT", "1"), "0") == 0) return;
+    const char* host = env_or("MP_HOST", "127.0.0.1");
+    const long port  = std::strtol(env_or("MP_PORT", "7777"), nullptr, 10);
+    if (port <= 0 || port > 65535) {
+      std::fprintf(stderr, "[mp] MP_PORT invalido; no se conecta\n");
+      return;
+    }
+    g_client = new mp::SocketClient(); // nunca se libera: vive hasta exit
+    if (const char* ms = std::getenv("MP_METRICS_MS")) {
+      const long v = std::strtol(ms, nullptr, 10);
+      if (v > 0) g_client->setMetricsIntervalMs(static_cast<std::uint32_t>(v));
+    }
+    g_client->start(host, static_cast<std::uint16_t>(port));
+    // atexit despues de los estaticos de la .so: corre antes que sus destructores
+    std::atexit(stop_client);
+  }
+
+} // namespace
+
+// === Familia malloc ===
+extern "C" {
+
+void* malloc(std::size_t sz) noexcept {
+  if (!resolved()) return boot_alloc(sz, 16);
+  void* p = g_real.malloc(sz);
+  if (p) track_alloc(p, sz, __builtin_return_address(0));
+  return p;
+}
+
+void free(void* p) noexcept {
+  if (!p || is_boot(p)) return; // el buffer de arranque no se recicla
+  if (!resolved()) return;
+  track_free(p);
+  g_real.free(p);
+}
+
+void* calloc(std::size_t n, std::size_t sz) noexcept {
+  std::size_t total;
+  if (__builtin_mul_overflow(n, sz, &total)) {
+    errno = ENOMEM;
+    return nullptr;
+  }
+  if (!resolved()) return boot_alloc(total, 16);
+  void* p = g_real.calloc(n, sz);
+  if (p) track_alloc(p, total, __builtin_return_address(0));
+  return p;
+}
+
+void* realloc(void* p, std::size_t sz) noexcept {
+  const void* caller = __builtin_return_address(0);
+  if (p && is_boot(p)) {
+    // Se muda al heap real (o a otro bloque de arranque si aun no hay)
+    void* q = resolved() ? g_real.malloc(sz) : boot_alloc(sz, 16);
+    if (!q) return nullptr;
+    std::memcpy(q, p, std::min(boot_size(p), sz));
+    if (!is_boot(q)) track_alloc(q, sz, caller);
+    return q;
+  }
+  if (!resolved()) return p ? nullptr : boot_alloc(sz, 16);
+  if (!p) {
+    void* q = g_real.malloc(sz);
+    if (q) track_alloc(q, sz, caller);
+    return q;
+  }
+  if (sz == 0) { // como glibc: libera y devuelve NULL
+    track_free(p);
+    g_real.free(p);
+    return nullptr;
+  }
+  // Se da de baja antes: si realloc mueve el bloque, otro hilo puede
+  // recibir la direccion vieja apenas vuelve
+  track_free(p);
+  void* q = g_real.realloc(p, sz);
+  if (!q) {
+    retrack(p, caller);
+    return nullptr;
+  }
+  track_alloc(q, sz, caller);
+  return q;
+}
+
+void* memalign(std::size_t align, std::size_t sz) noexcept {
+  if (!resolved()) return boot_alloc(sz, align);
+  void* p = g_real.memalign(align, sz);
+  if (p) track_alloc(p, sz, __builtin_return_address(0));
+  return p;
+}
+
+int posix_memalign(void** out, std::size_t align, std::size_t sz) noexcept {
+  if (!resolved()) {
+    void* p = boot_alloc(sz, align);
+    if (!p) return ENOMEM;
+    *out = p;
+    return 0;
+  }
+  const int rc = g_real.posix_memalign(out, align, sz);
+  if (rc == 0) track_alloc(*out, sz, __builtin_return_address(0));
+  return rc;
+}
+
+void* aligned_alloc(std::size_t align, std::size_t sz) noexcept {
+  if (!resolved()) return boot_alloc(sz, align);
+  void* p = g_real.aligned_alloc(align, sz);
+  if (p) track_alloc(p, sz, __builtin_return_address(0));
+  return p;
+}
+
+void* valloc(std::size_t sz) noexcept {
+  if (!resolved()) return boot_alloc(sz, static_cast<std::size_t>(g_page));
+  void* p = g_real.valloc(sz);
+  if (p) track_alloc(p, sz, __builtin_return_address(0));
+  return p;
+}
+
+void* pvalloc(std::size_t sz) noexcept {
+  if (!resolved()) return boot_alloc(page_up(sz), static_cast<std::size_t>(g_page));
+  void* p = g_real.pvalloc(sz);
+  if (p) track_alloc(p, page_up(sz), __builtin_return_address(0));
+  return p;
+}
+
+std::size_t malloc_usable_size(void* p) noexcept {
+  if (!p) return 0;
+  if (is_boot(p)) return boot_size(p);
+  return resolved() ? g_real.usable(p) : 0;
+}
+
+// === mmap ===
+// Solo se anotan los mapeos anonimos; mremap no se intercepta (una region
+// movida queda con su direccion y tamaño viejos hasta su munmap).
+
+void* mmap(void* addr, std::size_t len, int prot, int flags, int fd, off_t off) noexcept {
+  if (!resolved()) return MAP_FAILED;
+  void* r = g_real.mmap(addr, len, prot, flags, fd, off);
+  if (counts(r, flags)) add_region(r, len);
+  return r;
+}
+
+void* mmap64(void* addr, std::size_t len, int prot, int flags, int fd, off64_t off) noexcept {
+  if (!resolved()) return MAP_FAILED;
+  void* r = g_real.mmap64 ? g_real.mmap64(addr, len, prot, flags, fd, off)
+                          : g_real.mmap(addr, len, prot, flags, fd, static_cast<off_t>(off));
+  if (counts(r, flags)) add_region(r, len);
+  return r;
+}
+
+// Con el lock tomado durante el munmap real: un mmap de otro hilo que
+// recibe la misma direccion no se anota hasta que esta baja termina
+int munmap(void* addr, std::size_t len) noexcept {
+  if (!resolved()) return -1;
+  if (mp::mmaps::g_regions.load(std::memory_order_relaxed) == 0) return g_real.munmap(addr, len);
+  std::lock_guard<std::mutex> lock(g_regions_mu);
+  const int rc = g_real.munmap(addr, len);
+  if (rc == 0) {
+    const auto a = reinterpret_cast<std::uintptr_t>(addr);
+    remove_range(a, a + page_up(len));
+  }
+  return rc;
+}
+
+} // extern "C"
@@ -1,62 +1,223 @@
 #include "../include/ProfilerAPI.hpp"
+#include "../include/AllocId.hpp"
+#include "../include/BootRecorder.hpp"
 #include "../include/Callbacks.hpp"
+#include "../include/CallerPc.hpp"
 #include "../include/Serializer.hpp"
+#include "../include/Compression.hpp"
+#include "../include/Epoch.hpp"
+#include "../include/HeaderTracker.hpp"
+#include "../include/MmapStats.hpp"
+#include "../include/TrackingMode.hpp"
+#include "../include/ReentryGuard.hpp"
+#include "../include/TrackingPolicies.hpp"
+#include "../include/Modules.hpp"
+#include "../include/Observers.hpp"
+#include "../include/Overhead.hpp"
+#include "../include/Sections.hpp"
+#include "../include/ThreadRegistry.hpp"
+#include "../include/Timestamp.hpp"
+#include <algorithm>
 #include <atomic>
-
-// Flag global atomico que indica si el profiler esta habilitado
-namespace { std::atomic<bool> g_enabled{true}; }
+#include <chrono>
 
 namespace mp {
 
   // === Control del profiler ===
+  // El flag lo leen los hooks de new/delete (policy::Enabled); ver las
+  // variantes *Stopped en TrackingPolicies.hpp
 
   // Inicia el profiler
-  void start() { g_enabled.store(true, std::memory_order_relaxed); }
+  void start() { policy::Enabled::on.store(true, std::memory_order_relaxed); }
 
   // Detiene el profiler
-  void stop() { g_enabled.store(false, std::memory_order_relaxed); }
+  void stop() { policy::Enabled::on.store(false, std::memory_order_relaxed); }
 
   // Indica si el profiler esta habilitado
-  bool is_enabled() { return g_enabled.load(std::memory_order_relaxed); }
+  bool is_enabled() { return policy::Enabled::get(); }
+
+  // === Modo de seguimiento ===
+
+  // Cambia el modo por nombre
+  bool set_tracking_mode(const std::string& mode, std::string* err) {
+    TrackingMode m;
+    if (!tracking_mode_from_name(mode, m)) {
+      if (err) *err = "unknown tracking mode";
+      return false;
+    }
+    return set_tracking_mode(m, err);
+  }
+
+  // Nombre del modo vigente
+  std::string current_tracking_mode() { return tracking_mode_name(tracking_mode()); }
+
+  // Cambia el reloj de los registros (Timestamp.hpp)
+  bool set_timestamp_source(const std::string& source, std::string* err) {
+    TimestampSource s;
+    if (!timestamp_source_from_name(source, s)) {
+      if (err) *err = "unknown timestamp source";
+      return false;
+    }
+    return timestamps::set_source(s, err);
+  }
+
+  std::string current_timestamp_source() { return timestamp_source_name(timestamps::source()); }
 
   // === Snapshots y metricas ===
+  // Cada consulta abre un ReadGuard: la tabla no se libera mientras se usa
+
+  // liveBlocks/aggregate asignan con in_hook activo. Todo lo intermedio se
+  // arma y se libera con el guard; solo el string devuelto se copia fuera de
+  // el, para que alloc y free de cada bloque pasen por el mismo camino (si
+  // no, los contadores restarian frees de bloques que nunca sumaron).
+  template <class Build>
+  static std::string build_internal(Build build) {
+    std::string internal;
+    {
+      ScopedHookGuard guard;
+      epoch::ReadGuard rg;
+      internal = build(get_callbacks());
+    }
+    std::string out(internal);
+    ScopedHookGuard guard;
+    std::string().swap(internal);
+    return out;
+  }
 
   // Obtiene un nuevo id de snapshot
   SnapshotId snapshot() {
+    epoch::ReadGuard rg;
     const auto& cb = get_callbacks();
     return cb.snapshot();
   }
 
+  // Payload del SUMMARY: metricas basicas + estadisticas del transporte
+  static std::string summary_payload() {
+    std::string extra = "\"compression\":" + make_compression_json(compression_stats());
+    extra += ",\"mode\":\"";
+    extra += tracking_mode_name(tracking_mode());
+    extra += "\",\"callbacks_version\":" + std::to_string(callbacks_version());
+    extra += std::string(",\"enabled\":") + (is_enabled() ? "true" : "false");
+    if constexpr (ActivePolicy::kHeaderPrefix) {
+      extra += ",\"foreign_frees\":" + std::to_string(header::foreignFrees());
+    }
+    if (boot::recorded()) extra += ",\"boot\":" + boot::stats_json(); // costo del arranque (Dynamic)
+    if (pcs::count() || pcs::misses()) {
+      // misses: asignaciones sin atribucion por PC (tabla sin lugar)
+      extra += ",\"caller_pcs\":{\"count\":" + std::to_string(pcs::count()) +
+               ",\"misses\":" + std::to_string(pcs::misses()) + "}";
+    }
+    if (mmaps::active()) extra += ",\"mmap\":" + mmaps::json(); // solo con libmp_preload.so
+    if constexpr (overhead::kEnabled) {
+      extra += ",\"overhead\":" + make_overhead_summary_json(overhead::snapshot()); // MP_SELF_PROFILE
+    }
+    epoch::ReadGuard rg;
+    const auto& cb = get_callbacks();
+    return make_summary_json(cb.bytesInUse(), cb.peakBytes(), cb.allocCount(), extra);
+  }
+
   // Devuelve un resumen en formato JSON con metricas basicas
   std::string summary_json() {
-    const auto& cb = get_callbacks();
-    return make_summary_json(cb.bytesInUse(), cb.peakBytes(), cb.allocCount());
+    return summary_payload();
   }
 
   // Devuelve una lista de asignaciones vivas en formato CSV
   std::string live_allocs_csv() {
-    const auto& cb = get_callbacks();
-    return make_live_allocs_csv(cb.liveBlocks());
+    return build_internal([](const Callbacks& cb) { return make_live_allocs_csv(cb.liveBlocks()); });
+  }
+
+  // Devuelve los agregados (top callsites, hilos, histograma) en JSON
+  std::string stats_json(std::size_t top_callsites) {
+    return build_internal([top_callsites](const Callbacks& cb) {
+      return make_stats_json(cb.aggregate(top_callsites));
+    });
   }
 
   // Devuelve un mensaje JSON con el resumen de metricas
   std::string summary_message_json() {
-    const auto& cb = get_callbacks();
-    auto payload = make_summary_json(cb.bytesInUse(), cb.peakBytes(), cb.allocCount());
-    return make_message_json("SUMMARY", payload);
+    return make_message_json("SUMMARY", summary_payload());
   }
 
   // Devuelve un mensaje JSON con la lista de asignaciones vivas
   std::string live_allocs_message_json() {
-    const auto& cb = get_callbacks();
-    auto payload = make_live_allocs_json(cb.liveBlocks());
-    return make_message_json("LIVE_ALLOCS", payload);
+    return live_allocs_message_json(false);
+  }
+
+  std::string live_allocs_message_json(bool type_table, std::uint64_t since_id) {
+    return build_internal([type_table, since_id](const Callbacks& cb) {
+      // La marca va antes de copiar: lo que se asigne mientras tanto queda
+      // en este snapshot y tambien en el proximo SINCE
+      const std::uint64_t mark = alloc_ids::fence();
+      std::vector<BlockInfo> blocks = cb.liveBlocks();
+      if (since_id) {
+        blocks.erase(std::remove_if(blocks.begin(), blocks.end(),
+                                    [since_id](const BlockInfo& b) { return b.alloc_id < since_id; }),
+                     blocks.end());
+      }
+      return make_message_json("LIVE_ALLOCS",
+                               make_live_allocs_json(blocks, modules::snapshot(), type_table, mark));
+    });
+  }
+
+  // Devuelve un mensaje JSON con los agregados (mucho mas barato que LIVE_ALLOCS)
+  std::string stats_message_json(std::size_t top_callsites) {
+    return make_message_json("STATS", stats_json(top_callsites));
+  }
+
+  // Devuelve el arbol de secciones en JSON
+  std::string sections_json() {
+    const auto t = std::chrono::steady_clock::now().time_since_epoch();
+    return make_sections_json(sections::snapshot(), static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t).count()));
+  }
+
+  // Devuelve un mensaje JSON con el arbol de secciones
+  std::string sections_message_json() {
+    return make_message_json("SECTIONS", sections_json());
+  }
+
+  // Devuelve el registro de hilos en JSON
+  std::string threads_json() {
+    const auto t = std::chrono::steady_clock::now().time_since_epoch();
+    return make_threads_json(threads::snapshot(), static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t).count()));
+  }
+
+  // Devuelve un mensaje JSON con el registro de hilos
+  std::string threads_message_json() {
+    return make_message_json("THREADS", threads_json());
+  }
+
+  // Devuelve los observadores de asignaciones en JSON
+  std::string observers_json() {
+    const auto t = std::chrono::steady_clock::now().time_since_epoch();
+    return make_observers_json(observers::snapshot(), static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t).count()));
+  }
+
+  // Devuelve un mensaje JSON con los observadores
+  std::string observers_message_json() {
+    return make_message_json("OBSERVERS", observers_json());
   }
 
+  // Devuelve el costo medido del propio profiler en JSON
+  std::string overhead_json() {
+    const auto t = std::chrono::steady_clock::now().time_since_epoch();
+    return make_overhead_json(overhead::snapshot(), static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t).count()));
+  }
+
+  // Devuelve un mensaje JSON con el costo del profiler
+  std::string overhead_message_json() {
+    return make_message_json("PROFILER_OVERHEAD", overhead_json());
+  }
+
+  void set_thread_name(const char* name) { threads::set_name(name); }
+
   // === Secciones de medicion (scope) ===
-  // Por ahora son no-op (no hacen nada)
-  ScopedSection::ScopedSection(const char* /*name*/) {}
-  ScopedSection::~ScopedSection() {}
+  // Apilan/desapilan la seccion del hilo (ver Sections.hpp)
+  ScopedSection::ScopedSection(const char* name) { sections::enter(name); }
+  ScopedSection::~ScopedSection() { sections::leave(); }
 
   // === Wrappers de compatibilidad (ej. para SocketClient demo) ===
   namespace api {
@@ -0,0 +1,159 @@
+#include "../include/Sections.hpp"
+#include "../include/ReentryGuard.hpp"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace mp {
+namespace sections {
+
+namespace {
+
+  // Nodo del arbol. parent/name se escriben una vez, antes de publicar el
+  // nodo con g_count; los contadores los mueve el tracker con su lock.
+  struct Node {
+    std::atomic<std::uint64_t> live_bytes{0};
+    std::atomic<std::uint64_t> live_count{0};
+    std::atomic<std::uint64_t> total_allocs{0};
+    std::atomic<std::uint64_t> total_bytes{0};
+    std::uint32_t parent = kRoot;
+    const char*   name   = "(root)";
+  };
+
+  Node g_nodes[kMaxSections];
+  std::atomic<std::uint32_t> g_count{1}; // el nodo 0 es la raiz
+
+  // (padre, nombre) -> id. Solo se consulta cuando falla la cache del hilo.
+  struct Registry {
+    std::mutex mu;
+    std::map<std::pair<std::uint32_t, std::string>, std::uint32_t> ids;
+  };
+  Registry& registry() {
+    static Registry* r = new Registry(); // nunca se destruye
+    return *r;
+  }
+
+  // Pila del hilo. Los enter() mas alla de kMaxDepth solo se cuentan, para
+  // que sus leave() no saquen secciones de afuera.
+  struct Stack {
+    std::uint32_t ids[kMaxDepth];
+    std::uint32_t depth    = 0;
+    std::uint32_t overflow = 0;
+  };
+  thread_local Stack t_stack;
+
+  // Cache directa (padre, direccion del nombre) -> id
+  struct CacheEntry {
+    std::uint32_t parent = 0;
+    const char*   name   = nullptr;
+    std::uint32_t id     = 0;
+  };
+  constexpr std::size_t kCacheSlots = 16;
+  thread_local CacheEntry t_cache[kCacheSlots];
+
+  std::uint32_t lookup(std::uint32_t parent, const char* name) {
+    const std::size_t slot = ((reinterpret_cast<std::uintptr_t>(name) >> 3) ^ parent) & (kCacheSlots - 1);
+    CacheEntry& c = t_cache[slot];
+    if (c.name == name && c.parent == parent) return c.id;
+
+    std::uint32_t id;
+    {
+      ScopedHookGuard guard; // el mapa del registro no se atribuye a nadie
+      Registry& r = registry();
+      std::lock_guard<std::mutex> lock(r.mu);
+      auto it = r.ids.find({parent, name});
+      if (it != r.ids.end()) {
+        id = it->second;
+      } else {
+        const std::uint32_t n = g_count.load(std::memory_order_relaxed);
+        if (n >= kMaxSections) {
+          id = parent;
+        } else {
+          g_nodes[n].parent = parent;
+          g_nodes[n].name   = name;
+          g_count.store(n + 1, std::memory_order_release);
+          id = n;
+        }
+        r.ids.emplace(std::make_pair(parent, std::string(name)), id);
+      }
+    }
+    c = CacheEntry{parent, name, id};
+    return id;
+  }
+
+  void fill(SectionCounters& out, const Node& n) noexcept {
+    out.live_bytes   = n.live_bytes.load(std::memory_order_relaxed);
+    out.live_count   = n.live_count.load(std::memory_order_relaxed);
+    out.total_allocs = n.total_allocs.load(std::memory_order_relaxed);
+    out.total_bytes  = n.total_bytes.load(std::memory_order_relaxed);
+  }
+
+  void add(SectionCounters& into, const SectionCounters& c) noexcept {
+    into.live_bytes   += c.live_bytes;
+    into.live_count   += c.live_count;
+    into.total_allocs += c.total_allocs;
+    into.total_bytes  += c.total_bytes;
+  }
+
+} // namespace
+
+void enter(const char* name) {
+  Stack& s = t_stack;
+  if (s.depth >= kMaxDepth) { ++s.overflow; return; }
+  s.ids[s.depth] = lookup(current(), name ? name : "?");
+  ++s.depth;
+}
+
+void leave() noexcept {
+  Stack& s = t_stack;
+  if (s.overflow) { --s.overflow; return; }
+  if (s.depth) --s.depth;
+}
+
+std::uint32_t current() noexcept {
+  const Stack& s = t_stack;
+  return s.depth ? s.ids[s.depth - 1] : kRoot;
+}
+
+void onAlloc(std::uint32_t id, std::size_t sz) noexcept {
+  Node& n = g_nodes[id];
+  n.live_bytes.fetch_add(sz, std::memory_order_relaxed);
+  n.live_count.fetch_add(1, std::memory_order_relaxed);
+  n.total_allocs.fetch_add(1, std::memory_order_relaxed);
+  n.total_bytes.fetch_add(sz, std::memory_order_relaxed);
+}
+
+void onFree(std::uint32_t id, std::size_t sz) noexcept {
+  Node& n = g_nodes[id];
+  n.live_bytes.fetch_sub(sz, std::memory_order_relaxed);
+  n.live_count.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void clearLive() noexcept {
+  const std::uint32_t count = g_count.load(std::memory_order_acquire);
+  for (std::uint32_t i = 0; i < count; ++i) {
+    g_nodes[i].live_bytes.store(0, std::memory_order_relaxed);
+    g_nodes[i].live_count.store(0, std::memory_order_relaxed);
+  }
+}
+
+std::vector<SectionUsage> snapshot() {
+  const std::uint32_t count = g_count.load(std::memory_order_acquire);
+  std::vector<SectionUsage> out(count);
+  for (std::uint32_t i = 0; i < count; ++i) {
+    out[i].id     = i;
+    out[i].parent = g_nodes[i].parent;
+    out[i].name   = g_nodes[i].name;
+    fill(out[i].exclusive, g_nodes[i]);
+    out[i].inclusive = out[i].exclusive;
+  }
+  // Los hijos tienen id mayor que su padre: de atras hacia adelante cada
+  // nodo ya tiene su inclusive completo cuando se suma al padre
+  for (std::uint32_t i = count; i-- > 1;) add(out[out[i].parent].inclusive, out[i].inclusive);
+  return out;
+}
+
+} // namespace sections
+} // namespace mp
@@ -1,6 +1,10 @@
 #include "../include/Serializer.hpp"
+#include "../include/Stacks.hpp"
+#include "../include/TypeRegistry.hpp"
 #include <string>
 #include <cstdint>   // uint64_t, uintptr_t
+#include <cstdio>    // snprintf
+#include <unordered_set>
 
 namespace mp {
 
@@ -14,6 +18,25 @@ namespace mp {
     return std::to_string(reinterpret_cast<std::uintptr_t>(p));
   }
 
+  // PC en hexadecimal, como lo esperan addr2line y los mapas de /proc
+  static inline std::string pc_to_str(std::uintptr_t pc){
+    char buf[2 + 2*sizeof(pc) + 1];
+    std::snprintf(buf, sizeof(buf), "0x%llx", (unsigned long long)pc);
+    return buf;
+  }
+
+  // Campo CSV: entre comillas si trae comas o comillas (nombres de plantillas)
+  static inline std::string csv_field(const std::string& s){
+    if (s.find_first_of(",\"\n") == std::string::npos) return s;
+    std::string out = "\"";
+    for (char c : s) {
+      if (c=='\"') out.push_back('\"');
+      out.push_back(c);
+    }
+    out.push_back('\"');
+    return out;
+  }
+
   // Escapa caracteres especiales para que un string sea valido en JSON
   static inline std::string json_escape(const std::string& s){
     std::string out;
@@ -37,6 +60,250 @@ namespace mp {
     return j;
   }
 
+  // Igual, agregando campos extra antes de cerrar el objeto
+  std::string make_summary_json(std::size_t b, std::size_t p, std::size_t c,
+                                const std::string& extra){
+    std::string j = make_summary_json(b, p, c);
+    if (!extra.empty()) {
+      j.pop_back(); // quita '}'
+      j += ",";
+      j += extra;
+      j += "}";
+    }
+    return j;
+  }
+
+  // Estadisticas de compresion (ratio = comprimido/original, menor es mejor)
+  std::string make_compression_json(const CompressionStats& s){
+    char buf[64];
+    const double ratio = s.raw_bytes ? double(s.compressed_bytes) / double(s.raw_bytes) : 1.0;
+    const double nsPerKb = s.raw_bytes ? double(s.cpu_ns) * 1024.0 / double(s.raw_bytes) : 0.0;
+    std::string j = "{\"frames\":" + u64_to_str(s.frames) +
+                    ",\"raw_bytes\":" + u64_to_str(s.raw_bytes) +
+                    ",\"compressed_bytes\":" + u64_to_str(s.compressed_bytes);
+    std::snprintf(buf, sizeof(buf), "%.4f", ratio);
+    j += ",\"ratio\":"; j += buf;
+    j += ",\"cpu_ns\":" + u64_to_str(s.cpu_ns);
+    std::snprintf(buf, sizeof(buf), "%.1f", nsPerKb);
+    j += ",\"ns_per_kb\":"; j += buf;
+    j += "}";
+    return j;
+  }
+
+  // Agregados para el mensaje STATS
+  std::string make_stats_json(const AggregateStats& s){
+    std::string j = "{\"t_ns\":" + u64_to_str(s.t_ns) +
+                    ",\"bytes_in_use\":" + u64_to_str(s.bytes_in_use) +
+                    ",\"peak\":" + u64_to_str(s.peak) +
+                    ",\"live_count\":" + u64_to_str(s.live_count) +
+                    ",\"total_allocs\":" + u64_to_str(s.total_allocs) +
+                    ",\"total_frees\":" + u64_to_str(s.total_frees) +
+                    ",\"total_bytes\":" + u64_to_str(s.total_bytes) +
+                    ",\"callsite_count\":" + u64_to_str(s.callsite_count);
+    j.reserve(j.size() + s.top_callsites.size()*96 + s.threads.size()*80 + 1024);
+
+    j += ",\"top_callsites\":[";
+    for (std::size_t i = 0; i < s.top_callsites.size(); ++i){
+      const auto& c = s.top_callsites[i];
+      if (i) j += ",";
+      j += "{\"callsite\":\"" + json_escape(c.callsite) + "\"";
+      j += ",\"live_bytes\":" + u64_to_str(c.live_bytes);
+      j += ",\"live_count\":" + u64_to_str(c.live_count);
+      j += ",\"total_allocs\":" + u64_to_str(c.total_allocs) + "}";
+    }
+    j += "],\"threads\":[";
+    for (std::size_t i = 0; i < s.threads.size(); ++i){
+      const auto& t = s.threads[i];
+      if (i) j += ",";
+      j += "{\"thread_id\":" + std::to_string(t.thread_id);
+      j += ",\"name\":\"" + json_escape(t.name) + "\"";
+      j += ",\"live_bytes\":" + u64_to_str(t.live_bytes);
+      j += ",\"live_count\":" + u64_to_str(t.live_count);
+      j += ",\"total_allocs\":" + u64_to_str(t.total_allocs) + "}";
+    }
+    j += "],\"size_histogram\":[";
+    bool first = true;
+    for (std::size_t i = 0; i < kSizeHistogramBuckets; ++i){
+      if (s.size_hist_count[i] == 0) continue;
+      if (!first) j += ",";
+      first = false;
+      j += "{\"min\":" + u64_to_str(i == 0 ? 0 : (std::uint64_t(1) << i));
+      j += ",\"count\":" + u64_to_str(s.size_hist_count[i]);
+      j += ",\"bytes\":" + u64_to_str(s.size_hist_bytes[i]) + "}";
+    }
+    j += "],\"lifetime_histogram\":[";
+    first = true;
+    std::uint64_t min_ns = 0;
+    for (std::size_t i = 0; i < kLifetimeBuckets; ++i, min_ns = min_ns ? min_ns*10 : 1000){
+      if (s.lifetime_hist[i] == 0) continue;
+      if (!first) j += ",";
+      first = false;
+      j += "{\"min_ns\":" + u64_to_str(min_ns);
+      j += ",\"count\":" + u64_to_str(s.lifetime_hist[i]) + "}";
+    }
+    // hit_ratio: frees resueltos en el buffer de recientes sobre el total
+    char ratio[32];
+    std::snprintf(ratio, sizeof(ratio), "%.4f",
+                  s.total_frees ? double(s.recent_hits) / double(s.total_frees) : 0.0);
+    j += "],\"short_lived\":{\"hits\":" + u64_to_str(s.recent_hits);
+    j += ",\"promoted\":" + u64_to_str(s.recent_promoted);
+    j += std::string(",\"hit_ratio\":") + ratio + "}}";
+    return j;
+  }
+
+  static void append_section_counters(std::string& j, const SectionCounters& c){
+    j += "{\"live_bytes\":" + u64_to_str(c.live_bytes);
+    j += ",\"live_count\":" + u64_to_str(c.live_count);
+    j += ",\"total_allocs\":" + u64_to_str(c.total_allocs);
+    j += ",\"total_bytes\":" + u64_to_str(c.total_bytes) + "}";
+  }
+
+  // Un nodo y sus hijos (la profundidad esta acotada por sections::kMaxDepth)
+  static void append_section(std::string& j, const std::vector<SectionUsage>& v,
+                             const std::vector<std::vector<std::uint32_t>>& children, std::uint32_t id){
+    const SectionUsage& s = v[id];
+    j += "{\"id\":" + std::to_string(s.id);
+    j += ",\"name\":\"" + json_escape(s.name) + "\"";
+    j += ",\"exclusive\":"; append_section_counters(j, s.exclusive);
+    j += ",\"inclusive\":"; append_section_counters(j, s.inclusive);
+    j += ",\"children\":[";
+    for (std::size_t i = 0; i < children[id].size(); ++i){
+      if (i) j += ",";
+      append_section(j, v, children, children[id][i]);
+    }
+    j += "]}";
+  }
+
+  // Genera el arbol de secciones en JSON
+  std::string make_sections_json(const std::vector<SectionUsage>& v, std::uint64_t t_ns){
+    std::string j = "{\"t_ns\":" + u64_to_str(t_ns) +
+                    ",\"section_count\":" + u64_to_str(v.size()) + ",\"root\":";
+    if (v.empty()){
+      j += "null}";
+      return j;
+    }
+    std::vector<std::vector<std::uint32_t>> children(v.size());
+    for (std::size_t i = 1; i < v.size(); ++i) children[v[i].parent].push_back(static_cast<std::uint32_t>(i));
+    j.reserve(j.size() + v.size()*256);
+    append_section(j, v, children, 0);
+    j += "}";
+    return j;
+  }
+
+  // Genera el JSON del mensaje THREADS
+  std::string make_threads_json(const ThreadsSnapshot& s, std::uint64_t t_ns){
+    std::string j = "{\"t_ns\":" + u64_to_str(t_ns) +
+                    ",\"thread_count\":" + u64_to_str(s.threads.size()) + ",\"threads\":[";
+    j.reserve(j.size() + s.threads.size()*224 + 160);
+    for (std::size_t i = 0; i < s.threads.size(); ++i){
+      const auto& t = s.threads[i];
+      if (i) j += ",";
+      j += "{\"id\":" + std::to_string(t.id);
+      j += ",\"os_tid\":" + u64_to_str(t.os_tid);
+      j += ",\"name\":\"" + json_escape(t.name) + "\"";
+      j += std::string(",\"alive\":") + (t.alive ? "true" : "false");
+      j += ",\"live_bytes\":" + u64_to_str(t.counters.live_bytes);
+      j += ",\"peak_bytes\":" + u64_to_str(t.counters.peak_bytes);
+      j += ",\"live_count\":" + u64_to_str(t.counters.live_count);
+      j += ",\"total_allocs\":" + u64_to_str(t.counters.total_allocs);
+      j += ",\"total_frees\":" + u64_to_str(t.counters.total_frees);
+      j += ",\"total_bytes\":" + u64_to_str(t.counters.total_bytes) + "}";
+    }
+    j += "],\"exited\":{\"threads\":" + u64_to_str(s.exited_threads);
+    j += ",\"peak_bytes\":" + u64_to_str(s.exited.peak_bytes);
+    j += ",\"total_allocs\":" + u64_to_str(s.exited.total_allocs);
+    j += ",\"total_frees\":" + u64_to_str(s.exited.total_frees);
+    j += ",\"total_bytes\":" + u64_to_str(s.exited.total_bytes) + "}}";
+    return j;
+  }
+
+  // Genera el JSON del mensaje OBSERVERS
+  std::string make_observers_json(const std::vector<ObserverUsage>& v, std::uint64_t t_ns){
+    std::string j = "{\"t_ns\":" + u64_to_str(t_ns) +
+                    ",\"observer_count\":" + u64_to_str(v.size()) + ",\"observers\":[";
+    j.reserve(j.size() + v.size()*160 + 2);
+    for (std::size_t i = 0; i < v.size(); ++i){
+      const auto& o = v[i];
+      const std::uint64_t calls = o.allocs + o.frees;
+      if (i) j += ",";
+      j += "{\"id\":" + std::to_string(o.id);
+      j += ",\"name\":\"" + json_escape(o.name) + "\"";
+      j += ",\"allocs\":" + u64_to_str(o.allocs);
+      j += ",\"frees\":" + u64_to_str(o.frees);
+      j += ",\"skipped\":" + u64_to_str(o.skipped);
+      j += ",\"ns\":" + u64_to_str(o.ns);
+      j += ",\"ns_per_call\":" + u64_to_str(calls ? o.ns / calls : 0) + "}";
+    }
+    j += "]}";
+    return j;
+  }
+
+  // Una metrica de PROFILER_OVERHEAD; con hist agrega avg_ns y el histograma
+  static void append_overhead_metric(std::string& j, const OverheadSnapshot& s,
+                                     const OverheadCounters& c, const std::uint64_t* hist){
+    const auto ns = [&](std::uint64_t ticks){
+      return u64_to_str(static_cast<std::uint64_t>(static_cast<double>(ticks) * s.ns_per_tick));
+    };
+    j += "{\"count\":" + u64_to_str(c.count);
+    j += ",\"total_ns\":" + ns(c.total_ticks);
+    if (hist) j += ",\"avg_ns\":" + ns(c.count ? c.total_ticks / c.count : 0);
+    j += ",\"max_ns\":" + ns(c.max_ticks);
+    if (hist){
+      j += ",\"histogram\":[";
+      bool first = true;
+      for (std::size_t b = 0; b < kOverheadBuckets; ++b){
+        if (hist[b] == 0) continue;
+        if (!first) j += ",";
+        first = false;
+        j += "{\"min_ticks\":" + u64_to_str(b ? std::uint64_t(1) << b : 0);
+        j += ",\"count\":" + u64_to_str(hist[b]) + "}";
+      }
+      j += "]";
+    }
+    j += "}";
+  }
+
+  static void append_overhead_metrics(std::string& j, const OverheadSnapshot& s, bool hist){
+    j += "{";
+    for (std::size_t i = 0; i < kOverheadMetrics; ++i){
+      if (i) j += ",";
+      j += std::string("\"") + overhead_metric_name(static_cast<OverheadMetric>(i)) + "\":";
+      append_overhead_metric(j, s, s.total[i], hist ? s.hist[i] : nullptr);
+    }
+    j += "}";
+  }
+
+  // Genera el JSON del mensaje PROFILER_OVERHEAD
+  std::string make_overhead_json(const OverheadSnapshot& s, std::uint64_t t_ns){
+    std::string j = "{\"t_ns\":" + u64_to_str(t_ns);
+    if (!s.enabled) return j + ",\"enabled\":false}";
+    char tick[32];
+    std::snprintf(tick, sizeof(tick), "%.4f", s.ns_per_tick);
+    j += ",\"enabled\":true,\"sample_every\":" + std::to_string(s.sample_every);
+    j += std::string(",\"unit\":\"") + (s.cycles ? "cycles" : "ns") + "\"";
+    j += std::string(",\"ns_per_tick\":") + tick + ",\"metrics\":";
+    append_overhead_metrics(j, s, true);
+    j += ",\"threads\":[";
+    for (std::size_t t = 0; t < s.threads.size(); ++t){
+      if (t) j += ",";
+      j += "{\"thread_id\":" + std::to_string(s.threads[t].thread_id);
+      for (std::size_t i = 0; i < kOverheadMetrics; ++i){
+        j += std::string(",\"") + overhead_metric_name(static_cast<OverheadMetric>(i)) + "\":";
+        append_overhead_metric(j, s, s.threads[t].metrics[i], nullptr);
+      }
+      j += "}";
+    }
+    j += "]}";
+    return j;
+  }
+
+  std::string make_overhead_summary_json(const OverheadSnapshot& s){
+    std::string j = "{\"sample_every\":" + std::to_string(s.sample_every) + ",\"metrics\":";
+    append_overhead_metrics(j, s, false);
+    j += "}";
+    return j;
+  }
+
   // Genera un CSV con la lista de bloques de memoria vivos
   std::string make_live_allocs_csv(const std::vector<BlockInfo>& v){
     std::string out = "ptr,size,alloc_id,thread_id,t_ns,callsite\n";
@@ -47,14 +314,26 @@ namespace mp {
       out += u64_to_str(b.alloc_id); out += ",";
       out += std::to_string(b.thread_id); out += ",";
       out += u64_to_str(b.t_ns); out += ",";
-      out += b.callsite; out += "\n";
+      out += csv_field(b.callsite); out += "\n";
     }
     return out;
   }
 
-  // Genera un JSON con la lista de bloques de memoria vivos
-  std::string make_live_allocs_json(const std::vector<BlockInfo>& v){
+  // Bloques vivos y sus pilas. Con typeTable cada bloque lleva "type_id"
+  // y los nombres van una vez en "types"; si no, "type_name" en cada bloque.
+  static std::string live_allocs_json(const std::vector<BlockInfo>& v, bool typeTable){
+    // Nombres del registro, escapados una vez por tipo usado
+    const std::vector<std::string> names = types::names();
+    std::vector<std::string> escaped(names.size());
+    std::vector<bool> used(names.size(), false);
+    auto typeName = [&](const BlockInfo& b) -> const std::string& {
+      const std::uint32_t id = b.type_id < names.size() ? b.type_id : types::kUnknown;
+      if (!used[id]) { used[id] = true; escaped[id] = json_escape(names[id]); }
+      return escaped[id];
+    };
+
     std::string j = "{\"blocks\":[";
+    j.reserve(v.size()*224);
     bool first=true;
     for (const auto& b : v){
       if(!first) j += ",";
@@ -67,7 +346,74 @@ namespace mp {
       j += "\"callsite\":\""+json_escape(b.callsite)+"\",";
       j += "\"file\":\""+json_escape(b.file)+"\",";
       j += "\"line\":"+std::to_string(b.line)+",";
-      j += "\"type_name\":\""+json_escape(b.type_name)+"\"}";
+      if (!b.type_id && !b.type_name.empty()) {
+        // BlockInfo armado por otro backend, sin pasar por el registro
+        j += "\"type_name\":\""+json_escape(b.type_name)+"\",";
+      } else if (typeTable) {
+        typeName(b);
+        j += "\"type_id\":"+std::to_string(b.type_id)+",";
+      } else {
+        j += "\"type_name\":\""; j += typeName(b); j += "\",";
+      }
+      j += "\"pc\":\""+pc_to_str(b.pc)+"\",";
+      j += "\"stack_id\":"+std::to_string(b.stack_id)+"}";
+    }
+    j += "]";
+
+    if (typeTable) {
+      j += ",\"types\":[";
+      first=true;
+      for (std::size_t id = 0; id < names.size(); ++id){
+        if (!used[id]) continue;
+        if(!first) j += ",";
+        first=false;
+        j += "{\"id\":"+std::to_string(id)+",\"name\":\""+escaped[id]+"\"}";
+      }
+      j += "]";
+    }
+
+    // Cada pila una sola vez: {"id":N,"frames":["0x..",...]}, frames[0] el mas interno
+    std::unordered_set<std::uint32_t> seen;
+    j += ",\"stacks\":[";
+    first=true;
+    for (const auto& b : v){
+      if (!b.stack_id || !seen.insert(b.stack_id).second) continue;
+      if(!first) j += ",";
+      first=false;
+      j += "{\"id\":"+std::to_string(b.stack_id)+",\"frames\":[";
+      const auto frames = stacks::frames(b.stack_id);
+      for (std::size_t i = 0; i < frames.size(); ++i){
+        if (i) j += ",";
+        j += "\""+pc_to_str(frames[i])+"\"";
+      }
+      j += "]}";
+    }
+    j += "]}";
+    return j;
+  }
+
+  // Genera un JSON con la lista de bloques de memoria vivos
+  std::string make_live_allocs_json(const std::vector<BlockInfo>& v){
+    return live_allocs_json(v, false);
+  }
+
+  // Agrega los mapeos ejecutables al JSON de bloques vivos
+  std::string make_live_allocs_json(const std::vector<BlockInfo>& v,
+                                    const std::vector<ModuleMapping>& modules,
+                                    bool type_table,
+                                    std::uint64_t next_alloc_id){
+    std::string j = live_allocs_json(v, type_table);
+    j.pop_back(); // quita '}'
+    if (next_alloc_id) j += ",\"next_alloc_id\":"+u64_to_str(next_alloc_id);
+    j += ",\"modules\":[";
+    for (std::size_t i = 0; i < modules.size(); ++i){
+      const auto& m = modules[i];
+      if (i) j += ",";
+      j += "{\"start\":\""+pc_to_str(m.start)+"\"";
+      j += ",\"end\":\""+pc_to_str(m.end)+"\"";
+      j += ",\"offset\":\""+pc_to_str(m.offset)+"\"";
+      j += ",\"path\":\""+json_escape(m.path)+"\"";
+      j += ",\"build_id\":\""+m.build_id+"\"}";
     }
     j += "]}";
     return j;
@@ -83,4 +429,22 @@ namespace mp {
     return j;
   }
 
+  // Inserta "session" y "seq" al inicio de un mensaje {"type":...}
+  std::string make_sequenced_message_json(const std::string& msg,
+                                          const std::string& session,
+                                          uint64_t seq){
+    std::string j = "{\"session\":\"";
+    j.reserve(msg.size() + session.size() + 40);
+    j += json_escape(session);
+    j += "\",\"seq\":";
+    j += u64_to_str(seq);
+    if (msg.size() > 2) {
+      j += ",";
+      j.append(msg, 1, std::string::npos); // msg sin su '{' inicial
+    } else {
+      j += "}";
+    }
+    return j;
+  }
+
 } // namespace mp
\ No newline at end of file
@@ -1,11 +1,17 @@
 #include "SocketClient.hpp"
 #include "ProfilerAPI.hpp"
+#include "Serializer.hpp"
+#include "Compression.hpp"
+#include "TrackingMode.hpp"
+#include "Callbacks.hpp"
 #include "Callsite.hpp"
 
 #include <atomic>
 #include <chrono>
 #include <cstring>
+#include <deque>
 #include <mutex>
+#include <random>
 #include <string>
 #include <thread>
 #include <vector>
@@ -106,11 +112,87 @@ static std::string trimCopy(const std::string& s) {
     return s.substr(i, j - i);
 }
 
+// Genera un id de sesion aleatorio (hex de 64 bits) para este proceso
+static std::string makeSessionId() {
+    std::random_device rd;
+    std::uint64_t v = (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+    v ^= static_cast<std::uint64_t>(::getpid()) << 16;
+    v ^= static_cast<std::uint64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(v));
+    return std::string(buf);
+}
+
+// --------------------------- replay buffer ---------------------------
+
+/**
+ * @brief Buffer acotado con los ultimos frames enviados (ya serializados).
+ *
+ * Se usa para reenviar a un visor que se reconecta solo los frames que
+ * perdio. Se descartan los mas antiguos cuando se supera el limite de
+ * frames o de bytes; un frame mas grande que el limite de bytes no se guarda.
+ */
+class ReplayBuffer {
+public:
+    ReplayBuffer(size_t maxFrames, size_t maxBytes)
+        : maxFrames_(maxFrames), maxBytes_(maxBytes) {}
+
+    void push(std::uint64_t seq, const std::string& frame) {
+        if (frame.size() > maxBytes_) {
+            // No cabe: el hueco obligara a un resync completo
+            clear();
+            return;
+        }
+        frames_.push_back(Frame{seq, frame});
+        bytes_ += frame.size();
+        while (frames_.size() > maxFrames_ || bytes_ > maxBytes_) {
+            bytes_ -= frames_.front().data.size();
+            frames_.pop_front();
+        }
+    }
+
+    void clear() {
+        frames_.clear();
+        bytes_ = 0;
+    }
+
+    // true si todos los frames con seq > afterSeq siguen en el buffer
+    bool covers(std::uint64_t afterSeq, std::uint64_t lastSeq) const {
+        if (afterSeq >= lastSeq) return true;            // no falta nada
+        if (frames_.empty()) return false;
+        return frames_.front().seq <= afterSeq + 1 && frames_.back().seq == lastSeq;
+    }
+
+    // Llama fn(frame) para cada frame con seq > afterSeq, en orden
+    template <class Fn>
+    bool forEachAfter(std::uint64_t afterSeq, Fn&& fn) const {
+        for (const auto& f : frames_) {
+            if (f.seq <= afterSeq) continue;
+            if (!fn(f.data)) return false;
+        }
+        return true;
+    }
+
+    std::uint64_t oldestSeq() const { return frames_.empty() ? 0 : frames_.front().seq; }
+
+private:
+    struct Frame {
+        std::uint64_t seq;
+        std::string   data; // incluye el '\n' final
+    };
+
+    std::deque<Frame> frames_;
+    size_t            bytes_ = 0;
+    size_t            maxFrames_;
+    size_t            maxBytes_;
+};
+
 // --------------------------- SocketClient impl ---------------------------
 
 class SocketClient::Impl {
 public:
-    Impl() = default;
+    Impl() : session_(makeSessionId()), replay_(kReplayMaxFrames, kReplayMaxBytes) {}
     ~Impl() { stop(); }
 
     void start(const std::string& host, uint16_t port) {
@@ -134,7 +216,19 @@ public:
 
     bool isRunning() const noexcept { return running_; }
 
+    const std::string& sessionId() const noexcept { return session_; }
+
+    void setMetricsIntervalMs(std::uint32_t ms) noexcept {
+        metrics_ms_.store(ms ? ms : 1, std::memory_order_relaxed);
+    }
+
 private:
+    static constexpr size_t kReplayMaxFrames = 1024;
+    static constexpr size_t kReplayMaxBytes  = 16 * 1024 * 1024;
+    static constexpr size_t kCompressMinBytes = 64 * 1024; // umbral por defecto
+    static constexpr unsigned long kStatsDefaultTop = 10;  // callsites en STATS sin argumento
+    static constexpr unsigned long kStatsMaxTop     = 1000;
+
     void closeSocket() {
         if (sock_ >= 0) {
             ::close(sock_);
@@ -142,37 +236,271 @@ private:
         }
     }
 
+    // Envia bytes crudos por el socket actual; cierra la conexion si falla
+    bool sendRaw(const std::string& data) {
+        if (sock_ < 0) return false;
+        if (!sendAll(sock_, data.data(), data.size())) {
+            closeSocket();
+            return false;
+        }
+        return true;
+    }
+
+    // Envia un frame de datos; si se negocio compresion y supera el umbral,
+    // va como cabecera COMPRESSED + bloque binario. Corre en el hilo del
+    // socket, nunca con el lock del tracker tomado.
+    bool sendFrame(const std::string& frame) {
+        if (codec_ == Codec::None || frame.size() < compress_min_) return sendRaw(frame);
+
+        const std::uint64_t t0 = thread_cpu_ns();
+        bool ok = compress_frame(codec_, frame.data(), frame.size(), zbuf_);
+        const std::uint64_t ns = thread_cpu_ns() - t0;
+        if (!ok || zbuf_.size() >= frame.size()) return sendRaw(frame); // no vale la pena
+        record_compression(frame.size(), zbuf_.size(), ns);
+
+        std::string header = make_message_json("COMPRESSED",
+            std::string("{\"codec\":\"") + codec_name(codec_) + "\"" +
+            ",\"raw\":" + std::to_string(frame.size()) +
+            ",\"size\":" + std::to_string(zbuf_.size()) + "}");
+        header.push_back('\n');
+        return sendRaw(header) && sendRaw(zbuf_);
+    }
+
+    // Numera un mensaje, lo guarda en el replay buffer y lo envia si hay conexion.
+    // Devuelve false solo si habia conexion y el envio fallo.
+    bool sendSequenced(const std::string& message) {
+        const std::uint64_t seq = ++last_seq_;
+        std::string frame = make_sequenced_message_json(message, session_, seq);
+        frame.push_back('\n');
+        replay_.push(seq, frame);
+        if (sock_ < 0) return true;
+        return sendFrame(frame);
+    }
+
+    // Frame de control (no numerado, no se guarda): HELLO, RESYNC, ERROR...
+    bool sendControl(const char* type, const std::string& payload) {
+        std::string frame = make_message_json(type, payload);
+        frame.push_back('\n');
+        return sendRaw(frame);
+    }
+
+    // Primer frame de cada conexion: anuncia la sesion y el rango reproducible
+    bool sendHello() {
+        std::string payload = "{\"session\":\"" + session_ + "\"" +
+                              ",\"last_seq\":" + std::to_string(last_seq_) +
+                              ",\"oldest_seq\":" + std::to_string(replay_.oldestSeq()) +
+                              ",\"resume\":true" +
+                              ",\"codecs\":" + available_codecs_json() +
+                              ",\"mode\":\"" + tracking_mode_name(tracking_mode()) + "\"" +
+                              ",\"modes\":" + tracking_modes_json() +
+                              ",\"timestamp\":\"" + mp::current_timestamp_source() + "\"}";
+        return sendControl("HELLO", payload);
+    }
+
+    bool sendSnapshot(std::uint64_t sinceId = 0) {
+        std::string json = mp::live_allocs_message_json(type_table_, sinceId);
+        std::cout << "[SocketClient] Enviando snapshot (" << json.size() << " bytes)...\n";
+        if (!sendSequenced(json)) {
+            std::cout << "[SocketClient] Error al enviar snapshot, reconectando...\n";
+            return false;
+        }
+        std::cout << "[SocketClient] Snapshot enviado exitosamente!\n";
+        return true;
+    }
+
+    // RESUME <session> <seq>: reenvia lo perdido o fuerza un resync completo
+    bool handleResume(const std::string& args) {
+        char sess[64] = {0};
+        unsigned long long seq = 0;
+        if (std::sscanf(args.c_str(), "%63s %llu", sess, &seq) != 2) {
+            return sendControl("ERROR", "{\"message\":\"usage: RESUME <session> <seq>\"}");
+        }
+
+        if (session_ == sess && seq <= last_seq_ && replay_.covers(seq, last_seq_)) {
+            const std::uint64_t missed = last_seq_ - seq;
+            std::cout << "[SocketClient] RESUME: reenviando " << missed << " frames\n";
+            std::string payload = "{\"from_seq\":" + std::to_string(seq + 1) +
+                                  ",\"to_seq\":" + std::to_string(last_seq_) + "}";
+            if (!sendControl("RESUMED", payload)) return false;
+            return replay_.forEachAfter(seq, [this](const std::string& f) { return sendFrame(f); });
+        }
+
+        // Otra sesion (proceso reiniciado) o hueco mayor que el buffer
+        std::cout << "[SocketClient] RESUME imposible, enviando resync completo\n";
+        std::string payload = "{\"session\":\"" + session_ + "\"" +
+                              ",\"last_seq\":" + std::to_string(last_seq_) + "}";
+        if (!sendControl("RESYNC", payload)) return false;
+        return sendSnapshot();
+    }
+
+    // COMPRESS <codec> [min_bytes]: activa compresion para esta conexion
+    bool handleCompress(const std::string& args) {
+        char name[16] = {0};
+        unsigned long long minBytes = kCompressMinBytes;
+        Codec c = Codec::None;
+        if (std::sscanf(args.c_str(), "%15s %llu", name, &minBytes) < 1 || !codec_from_name(name, c)) {
+            return sendControl("ERROR", "{\"message\":\"unsupported codec\",\"codecs\":" +
+                                        available_codecs_json() + "}");
+        }
+        codec_ = c;
+        compress_min_ = static_cast<size_t>(minBytes);
+        return sendControl("COMPRESS", std::string("{\"codec\":\"") + codec_name(codec_) + "\"" +
+                                       ",\"min_bytes\":" + std::to_string(compress_min_) + "}");
+    }
+
+    // TYPES <inline|table>: nombre de tipo en cada bloque, o por id con la
+    // tabla "types" una vez por snapshot
+    bool handleTypes(const std::string& args) {
+        if (args == "inline") type_table_ = false;
+        else if (args == "table") type_table_ = true;
+        else return sendControl("ERROR", "{\"message\":\"usage: TYPES <inline|table>\"}");
+        return sendControl("TYPES", std::string("{\"mode\":\"") + (type_table_ ? "table" : "inline") + "\"}");
+    }
+
+    // STATS [top_n]: agregados sin copiar los bloques vivos
+    bool handleStats(const std::string& args) {
+        unsigned long topN = kStatsDefaultTop;
+        if (!args.empty()) std::sscanf(args.c_str(), "%lu", &topN);
+        if (topN > kStatsMaxTop) topN = kStatsMaxTop;
+        return sendSequenced(mp::stats_message_json(static_cast<std::size_t>(topN)));
+    }
+
+    // SECTIONS: arbol de ScopedSection con bytes/conteos inclusivos y exclusivos
+    bool handleSections() {
+        return sendSequenced(mp::sections_message_json());
+    }
+
+    // THREADS: registro de hilos con nombre y contadores por hilo
+    bool handleThreads() {
+        return sendSequenced(mp::threads_message_json());
+    }
+
+    // OBSERVERS: observadores de asignaciones con llamadas y tiempo
+    bool handleObservers() {
+        return sendSequenced(mp::observers_message_json());
+    }
+
+    // PROFILER_OVERHEAD: tiempo en los hooks, en el lock del tracker y en
+    // snapshots (con MP_SELF_PROFILE)
+    bool handleOverhead() {
+        return sendSequenced(mp::overhead_message_json());
+    }
+
+    // MODE <off|counters|sampled|full>: cambia el backend de seguimiento
+    bool handleMode(const std::string& args) {
+        const std::string previous = tracking_mode_name(tracking_mode());
+        std::string err;
+        if (!mp::set_tracking_mode(args, &err)) {
+            return sendControl("ERROR", "{\"message\":\"" + err + "\",\"modes\":" +
+                                        tracking_modes_json() + "}");
+        }
+        return sendControl("MODE", std::string("{\"mode\":\"") + tracking_mode_name(tracking_mode()) + "\"" +
+                                   ",\"previous\":\"" + previous + "\"" +
+                                   ",\"version\":" + std::to_string(callbacks_version()) + "}");
+    }
+
+    bool handleCommand(const std::string& line) {
+        if (line == "SNAPSHOT") {
+            std::cout << "[SocketClient] Procesando comando SNAPSHOT...\n";
+            return sendSnapshot();
+        }
+        if (line.compare(0, 15, "SNAPSHOT SINCE ") == 0) {
+            // Solo bloques con alloc_id >= N (N = next_alloc_id de un snapshot previo)
+            unsigned long long since = 0;
+            if (std::sscanf(line.c_str() + 15, "%llu", &since) != 1) {
+                return sendControl("ERROR", "{\"message\":\"usage: SNAPSHOT SINCE <alloc_id>\"}");
+            }
+            return sendSnapshot(static_cast<std::uint64_t>(since));
+        }
+        if (line.compare(0, 7, "RESUME ") == 0) {
+            return handleResume(line.substr(7));
+        }
+        if (line == "STATS" || line.compare(0, 6, "STATS ") == 0) {
+            return handleStats(line.size() > 6 ? line.substr(6) : std::string());
+        }
+        if (line == "SECTIONS") {
+            return handleSections();
+        }
+        if (line == "THREADS") {
+            return handleThreads();
+        }
+        if (line == "OBSERVERS") {
+            return handleObservers();
+        }
+        if (line == "PROFILER_OVERHEAD") {
+            return handleOverhead();
+        }
+        if (line.compare(0, 5, "MODE ") == 0) {
+            return handleMode(line.substr(5));
+        }
+        if (line.compare(0, 9, "COMPRESS ") == 0) {
+            return handleCompress(line.substr(9));
+        }
+        if (line.compare(0, 6, "TYPES ") == 0) {
+            return handleTypes(line.substr(6));
+        }
+        return true; // comando desconocido: se ignora
+    }
+
+    std::chrono::milliseconds metricsInterval() const noexcept {
+        return std::chrono::milliseconds(metrics_ms_.load(std::memory_order_relaxed));
+    }
+
     void runLoop() {
+        mp::set_thread_name("mp-socket");
         constexpr int   kConnectTimeoutMs = 2000;
         constexpr int   kPollTickMs       = 50;
-        constexpr int   kMetricsMs        = 200;
         constexpr size_t kReadBuf         = 4096;
 
+        // Nada de lo que asigne este hilo debe aparecer en el profiler
+        AntiReentry guard;
+
         std::string rxBuffer;
         rxBuffer.reserve(8 * 1024);
 
         auto next_metrics = std::chrono::steady_clock::now();
+        auto next_connect = next_metrics;
 
         int backoff_ms = 200;
         while (true) {
             if (!running_) break;
 
+            auto now = std::chrono::steady_clock::now();
+
             // Asegurar conexión
             if (sock_ < 0) {
+                // Mientras no hay visor las metricas siguen numerandose en el
+                // replay buffer, para que un RESUME pueda recuperarlas
+                if (now >= next_metrics) {
+                    next_metrics = now + metricsInterval();
+                    sendSequenced(mp::api::getMetricsJson());
+                }
+                if (now < next_connect) {
+                    auto wake = std::min(next_connect, next_metrics);
+                    std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+                        wake - now, std::chrono::milliseconds(kPollTickMs)));
+                    continue;
+                }
+
                 std::cout << "[SocketClient] Intentando conectar a " << host_ << ":" << port_ << "...\n";
                 int s = connectToServer(host_, port_, kConnectTimeoutMs);
                 if (s < 0) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(backoff_ms));
+                    next_connect = std::chrono::steady_clock::now() + std::chrono::milliseconds(backoff_ms);
                     backoff_ms = std::min(backoff_ms * 2, 3000);
                     continue;
                 }
                 sock_ = s;
                 backoff_ms = 200;
+                rxBuffer.clear();
+                codec_ = Codec::None; // cada visor negocia de nuevo
+                compress_min_ = kCompressMinBytes;
+                type_table_ = false;
                 next_metrics = std::chrono::steady_clock::now();
-                std::cout << "[SocketClient] Conectado exitosamente!\n";
+                std::cout << "[SocketClient] Conectado exitosamente! (sesion " << session_ << ")\n";
+                if (!sendHello()) continue;
+                now = std::chrono::steady_clock::now();
             }
 
-            auto now = std::chrono::steady_clock::now();
             int timeout_ms = kPollTickMs;
             if (now < next_metrics) {
                 auto remain = std::chrono::duration_cast<std::chrono::milliseconds>(next_metrics - now).count();
@@ -211,37 +539,18 @@ private:
 
                     std::cout << "[SocketClient] Comando recibido: '" << line << "'\n";
 
-                    if (line == "SNAPSHOT") {
-                        std::cout << "[SocketClient] Procesando comando SNAPSHOT...\n";
-                        AntiReentry guard;
-                        std::string json = mp::api::getSnapshotJson();
-                        json.push_back('\n');
-
-                        std::cout << "[SocketClient] Enviando snapshot (" << json.size() << " bytes)...\n";
-
-                        if (!sendAll(sock_, json.data(), json.size())) {
-                            std::cout << "[SocketClient] Error al enviar snapshot, reconectando...\n";
-                            closeSocket();
-                            break;
-                        }
-
-                        std::cout << "[SocketClient] Snapshot enviado exitosamente!\n";
-                    }
+                    if (!handleCommand(line)) break; // el socket ya se cerro
                 }
+                if (sock_ < 0) continue;
             }
 
             // Enviar métricas periódicas
             now = std::chrono::steady_clock::now();
             if (now >= next_metrics) {
-                next_metrics = now + std::chrono::milliseconds(kMetricsMs);
+                next_metrics = now + metricsInterval();
 
-                AntiReentry guard;
-                std::string json = mp::api::getMetricsJson();
-                json.push_back('\n');
-
-                if (!sendAll(sock_, json.data(), json.size())) {
+                if (!sendSequenced(mp::api::getMetricsJson())) {
                     std::cout << "[SocketClient] Error al enviar métricas, reconectando...\n";
-                    closeSocket();
                     continue;
                 }
             }
@@ -255,10 +564,23 @@ private:
     mutable std::mutex m_;
     std::thread        worker_;
     std::atomic<bool>  running_{false};
+    std::atomic<std::uint32_t> metrics_ms_{200};
 
     std::string host_{"127.0.0.1"};
     uint16_t    port_{7777};
     int         sock_{-1};
+
+    // Sesion y numeracion de frames (solo los usa el hilo trabajador)
+    const std::string session_;
+    std::uint64_t     last_seq_{0};
+    ReplayBuffer      replay_;
+
+    // Compresion negociada con el visor actual
+    Codec       codec_{Codec::None};
+    size_t      compress_min_{kCompressMinBytes};
+    std::string zbuf_; // buffer reutilizado para el bloque comprimido
+
+    bool        type_table_{false}; // TYPES table: tipos por id en LIVE_ALLOCS
 };
 
 // --------------------------- SocketClient API ---------------------------
@@ -269,5 +591,7 @@ SocketClient::~SocketClient() { if (impl_) { impl_->stop(); delete impl_; } }
 void SocketClient::start(const std::string& host, uint16_t port) { impl_->start(host, port); }
 void SocketClient::stop()                                        { impl_->stop(); }
 bool SocketClient::isRunning() const noexcept                    { return impl_->isRunning(); }
+std::string SocketClient::sessionId() const                      { return impl_->sessionId(); }
+void SocketClient::setMetricsIntervalMs(std::uint32_t ms)        { impl_->setMetricsIntervalMs(ms); }
 
 } // namespace mp
\ No newline at end of file
@@ -0,0 +1,197 @@
+#include "../include/Stacks.hpp"
+
+#include <atomic>
+
+#include <pthread.h>
+#include <unwind.h>
+
+#ifndef MP_STACK_DEPTH
+#define MP_STACK_DEPTH 0
+#endif
+
+namespace mp {
+namespace stacks {
+
+namespace {
+
+  std::atomic<std::uint32_t> g_depth{MP_STACK_DEPTH < kMaxDepth ? MP_STACK_DEPTH : kMaxDepth};
+
+  // Slot i = pila del id i + 1. hash 0 = libre. desc = offset en el pool
+  // (32 bits altos) y profundidad (bajos); 0 = todavia copiando, kDead =
+  // el pool se lleno y el slot no se usa.
+  struct Slot {
+    std::atomic<std::uint64_t> hash{0};
+    std::atomic<std::uint64_t> desc{0};
+  };
+  constexpr std::uint64_t kDead = ~std::uint64_t(0);
+
+  Slot g_slots[kMaxStacks];
+  std::uintptr_t g_pool[kPoolFrames];
+  std::atomic<std::uint32_t> g_pool_used{0};
+  std::atomic<std::uint32_t> g_count{0};
+
+  constexpr std::uint32_t kMaxProbes = 64;
+  // Frames que se recorren buscando a quien llamo a new antes de
+  // rendirse y guardar la pila desde el principio
+  constexpr std::uint32_t kMaxSkip = 32;
+
+  std::uint64_t hash_frames(const std::uintptr_t* f, std::uint32_t n) noexcept {
+    std::uint64_t h = 0xCBF29CE484222325ull ^ n;
+    for (std::uint32_t i = 0; i < n; ++i) {
+      h ^= static_cast<std::uint64_t>(f[i]);
+      h *= 0x9E3779B97F4A7C15ull;
+      h ^= h >> 29;
+    }
+    return h ? h : 1;
+  }
+
+  bool same(std::uint64_t desc, const std::uintptr_t* f, std::uint32_t n) noexcept {
+    if (static_cast<std::uint32_t>(desc) != n) return false;
+    const std::uintptr_t* g = g_pool + (desc >> 32);
+    for (std::uint32_t i = 0; i < n; ++i) if (g[i] != f[i]) return false;
+    return true;
+  }
+
+  // Frames de la pila mientras se captura. Al encontrar `caller` se
+  // descarta todo lo anterior (frames del profiler).
+  struct Collector {
+    std::uintptr_t f[kMaxSkip + kMaxDepth];
+    std::uint32_t  n = 0;
+    std::uint32_t  limit;
+    std::uintptr_t caller;
+    bool           found;
+
+    Collector(std::uint32_t depth, const void* c) noexcept
+        : limit(depth), caller(reinterpret_cast<std::uintptr_t>(c)), found(c == nullptr) {}
+
+    // false = no hace falta seguir
+    bool push(std::uintptr_t pc) noexcept {
+      if (!pc) return false;
+      if (!found) {
+        if (pc == caller) { found = true; n = 0; }
+        else if (n == kMaxSkip + kMaxDepth) return false;
+      }
+      f[n++] = pc;
+      return !(found && n >= limit);
+    }
+
+    // Sin `caller` a la vista se guarda la pila desde el principio
+    std::uint32_t size() const noexcept { return n < limit ? n : limit; }
+  };
+
+#if MP_FRAME_POINTERS
+  // Limites de la pila del hilo, para no seguir un frame pointer roto
+  struct Bounds {
+    std::uintptr_t lo = 0, hi = 0;
+    bool init = false;
+  };
+  thread_local Bounds t_bounds;
+
+  const Bounds& bounds() noexcept {
+    Bounds& b = t_bounds;
+    if (!b.init) {
+      b.init = true;
+      pthread_attr_t attr;
+      if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+        void* addr = nullptr;
+        std::size_t size = 0;
+        if (pthread_attr_getstack(&attr, &addr, &size) == 0) {
+          b.lo = reinterpret_cast<std::uintptr_t>(addr);
+          b.hi = b.lo + size;
+        }
+        pthread_attr_destroy(&attr);
+      }
+    }
+    return b;
+  }
+
+  // Cada frame empieza con {frame pointer anterior, direccion de retorno}
+  // (x86-64 y AArch64)
+  __attribute__((noinline)) void walk(Collector& c) noexcept {
+    const Bounds& b = bounds();
+    auto fp = reinterpret_cast<std::uintptr_t>(__builtin_frame_address(0));
+    while (b.lo <= fp && fp + 2 * sizeof(std::uintptr_t) <= b.hi && (fp & (sizeof(std::uintptr_t) - 1)) == 0) {
+      const auto* frame = reinterpret_cast<const std::uintptr_t*>(fp);
+      if (!c.push(frame[1])) return;
+      const std::uintptr_t next = frame[0];
+      if (next <= fp) return; // la pila crece hacia abajo: el anterior esta mas arriba
+      fp = next;
+    }
+  }
+#else
+  _Unwind_Reason_Code on_frame(struct _Unwind_Context* ctx, void* arg) {
+    Collector& c = *static_cast<Collector*>(arg);
+    return c.push(static_cast<std::uintptr_t>(_Unwind_GetIP(ctx))) ? _URC_NO_REASON : _URC_END_OF_STACK;
+  }
+
+  __attribute__((noinline)) void walk(Collector& c) noexcept {
+    _Unwind_Backtrace(&on_frame, &c);
+  }
+#endif
+
+} // namespace
+
+void set_max_depth(std::uint32_t depth) noexcept {
+  g_depth.store(depth < kMaxDepth ? depth : kMaxDepth, std::memory_order_relaxed);
+}
+
+std::uint32_t max_depth() noexcept {
+  return g_depth.load(std::memory_order_relaxed);
+}
+
+std::uint32_t capture(const void* caller) noexcept {
+  const std::uint32_t depth = max_depth();
+  if (depth == 0) return 0;
+  Collector c(depth, caller);
+  walk(c);
+  return intern(c.f, c.size());
+}
+
+std::uint32_t intern(const std::uintptr_t* f, std::uint32_t n) noexcept {
+  if (n == 0) return 0;
+  if (n > kMaxDepth) n = kMaxDepth;
+  const std::uint64_t h = hash_frames(f, n);
+  std::uint32_t slot = static_cast<std::uint32_t>(h >> 32) & (kMaxStacks - 1);
+
+  for (std::uint32_t probe = 0; probe < kMaxProbes; ++probe, slot = (slot + 1) & (kMaxStacks - 1)) {
+    Slot& s = g_slots[slot];
+    std::uint64_t cur = s.hash.load(std::memory_order_acquire);
+    if (cur == 0) {
+      if (s.hash.compare_exchange_strong(cur, h, std::memory_order_acq_rel)) {
+        // Slot nuestro: copiar los frames y publicarlo
+        const std::uint32_t off = g_pool_used.fetch_add(n, std::memory_order_relaxed);
+        if (off > kPoolFrames - n) {
+          s.desc.store(kDead, std::memory_order_release);
+          return 0;
+        }
+        for (std::uint32_t i = 0; i < n; ++i) g_pool[off + i] = f[i];
+        s.desc.store((static_cast<std::uint64_t>(off) << 32) | n, std::memory_order_release);
+        g_count.fetch_add(1, std::memory_order_relaxed);
+        return slot + 1;
+      }
+      // Otro hilo tomo el slot: cur tiene su hash
+    }
+    if (cur != h) continue;
+
+    // Mismo hash: esperar a que el dueño termine de copiar y comparar
+    std::uint64_t d;
+    while ((d = s.desc.load(std::memory_order_acquire)) == 0) {}
+    if (d != kDead && same(d, f, n)) return slot + 1;
+  }
+  return 0;
+}
+
+std::vector<std::uintptr_t> frames(std::uint32_t id) {
+  if (id == 0 || id > kMaxStacks) return {};
+  const std::uint64_t d = g_slots[id - 1].desc.load(std::memory_order_acquire);
+  if (d == 0 || d == kDead) return {};
+  const std::uintptr_t* g = g_pool + (d >> 32);
+  return std::vector<std::uintptr_t>(g, g + static_cast<std::uint32_t>(d));
+}
+
+std::uint32_t count() noexcept {
+  return g_count.load(std::memory_order_relaxed);
+}
+
+} // namespace stacks
+} // namespace mp
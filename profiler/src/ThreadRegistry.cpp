@@ -0,0 +1,252 @@
+#include "../include/ThreadRegistry.hpp"
+#include "../include/ReentryGuard.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace mp {
+namespace threads {
+
+namespace {
+
+  enum : std::uint8_t { kFree = 0, kAlive = 1, kExited = 2 };
+
+  // Slot de un hilo. Identidad y nombre se tocan con g_mu; los contadores
+  // los mueve el tracker (el pico solo en el hilo dueño). Una linea de
+  // cache propia: cada hilo escribe los suyos en cada new.
+  struct alignas(64) Slot {
+    std::atomic<std::uint64_t> live_bytes{0};
+    std::atomic<std::uint64_t> peak_bytes{0};
+    std::atomic<std::uint64_t> live_count{0};
+    std::atomic<std::uint64_t> total_allocs{0};
+    std::atomic<std::uint64_t> total_frees{0};
+    std::atomic<std::uint64_t> total_bytes{0};
+    std::uint8_t  state    = kFree;
+    bool          named    = false;   // set_name: no se pisa con el del sistema
+    std::uint64_t os_tid   = 0;
+    std::uint32_t next_free = 0;      // lista de slots reciclados
+    char          name[kMaxName] = {};
+  };
+
+  Slot g_slots[kMaxThreads];        // el 0 junta lo de hilos sin id
+
+  // Registro y reciclado (camino lento, una vez por hilo)
+  std::mutex      g_mu;
+  std::atomic<std::uint32_t> g_count{1};   // se escribe con g_mu
+  std::uint32_t   g_free_head = 0;
+  std::uint64_t   g_exited_threads = 0;
+  ThreadCounters  g_exited;
+
+  pthread_key_t   g_key;
+  std::once_flag  g_key_once;
+
+  void load(ThreadCounters& out, const Slot& s) noexcept {
+    out.live_bytes   = s.live_bytes.load(std::memory_order_relaxed);
+    out.peak_bytes   = s.peak_bytes.load(std::memory_order_relaxed);
+    out.live_count   = s.live_count.load(std::memory_order_relaxed);
+    out.total_allocs = s.total_allocs.load(std::memory_order_relaxed);
+    out.total_frees  = s.total_frees.load(std::memory_order_relaxed);
+    out.total_bytes  = s.total_bytes.load(std::memory_order_relaxed);
+  }
+
+  void zero(Slot& s) noexcept {
+    s.live_bytes.store(0, std::memory_order_relaxed);
+    s.peak_bytes.store(0, std::memory_order_relaxed);
+    s.live_count.store(0, std::memory_order_relaxed);
+    s.total_allocs.store(0, std::memory_order_relaxed);
+    s.total_frees.store(0, std::memory_order_relaxed);
+    s.total_bytes.store(0, std::memory_order_relaxed);
+  }
+
+  // Nombre del sistema del hilo actual (prctl, sin asignar)
+  void own_system_name(char* out) noexcept {
+    char buf[kMaxName] = {};
+    if (pthread_getname_np(pthread_self(), buf, sizeof(buf)) == 0) {
+      std::memcpy(out, buf, kMaxName);
+      out[kMaxName - 1] = '\0';
+    }
+  }
+
+  // Nombre del sistema de otro hilo vivo: /proc/self/task/<tid>/comm.
+  // Con el tid no hay riesgo si el hilo ya termino (solo falla el open).
+  bool system_name_of(std::uint64_t tid, char* out) noexcept {
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/self/task/%llu/comm",
+                  static_cast<unsigned long long>(tid));
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    const ssize_t n = ::read(fd, out, kMaxName - 1);
+    ::close(fd);
+    if (n <= 0) return false;
+    out[n] = '\0';
+    if (out[n - 1] == '\n') out[n - 1] = '\0';
+    return true;
+  }
+
+  // Destructor de pthread_key: corre al salir el hilo, despues de sus
+  // thread_local de C++
+  void on_thread_exit(void* value) {
+    const auto id = static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(value));
+    if (id == kUnknown || id >= kMaxThreads) return;
+    Slot& s = g_slots[id];
+    std::lock_guard<std::mutex> lock(g_mu);
+    if (!s.named) own_system_name(s.name);
+    if (s.live_count.load(std::memory_order_relaxed) == 0) {
+      ThreadCounters c;
+      load(c, s);
+      g_exited.total_allocs += c.total_allocs;
+      g_exited.total_frees  += c.total_frees;
+      g_exited.total_bytes  += c.total_bytes;
+      if (c.peak_bytes > g_exited.peak_bytes) g_exited.peak_bytes = c.peak_bytes;
+      ++g_exited_threads;
+      s.state     = kFree;
+      s.next_free = g_free_head;
+      g_free_head = id;
+    } else {
+      s.state = kExited;
+    }
+    t_id = kUnknown; // un free posterior en este hilo vuelve a registrarse
+  }
+
+} // namespace
+
+std::uint32_t register_current() noexcept {
+  std::call_once(g_key_once, [] { pthread_key_create(&g_key, &on_thread_exit); });
+
+  std::uint32_t id = kUnknown;
+  {
+    std::lock_guard<std::mutex> lock(g_mu);
+    if (g_free_head != 0) {
+      id = g_free_head;
+      g_free_head = g_slots[id].next_free;
+    } else if (g_count < kMaxThreads) {
+      id = g_count++;
+    }
+    if (id != kUnknown) {
+      Slot& s = g_slots[id];
+      zero(s);
+      s.state  = kAlive;
+      s.named  = false;
+      s.os_tid = static_cast<std::uint64_t>(::syscall(SYS_gettid));
+      std::memset(s.name, 0, sizeof(s.name));
+      own_system_name(s.name);
+    }
+  }
+  if (id == kUnknown) return kUnknown; // tabla llena: se vuelve a intentar en la proxima
+  pthread_setspecific(g_key, reinterpret_cast<void*>(static_cast<std::uintptr_t>(id)));
+  t_id = id;
+  return id;
+}
+
+std::uint32_t slots_used() noexcept {
+  return g_count.load(std::memory_order_acquire);
+}
+
+void set_name(const char* name) noexcept {
+  const std::uint32_t id = current();
+  if (id == kUnknown || !name) return;
+  Slot& s = g_slots[id];
+  std::lock_guard<std::mutex> lock(g_mu);
+  std::strncpy(s.name, name, kMaxName - 1);
+  s.name[kMaxName - 1] = '\0';
+  s.named = true;
+}
+
+void onAlloc(std::uint32_t id, std::size_t sz) noexcept {
+  Slot& s = g_slots[id];
+  const std::uint64_t live = s.live_bytes.fetch_add(sz, std::memory_order_relaxed) + sz;
+  if (live > s.peak_bytes.load(std::memory_order_relaxed)) {
+    s.peak_bytes.store(live, std::memory_order_relaxed);
+  }
+  s.live_count.fetch_add(1, std::memory_order_relaxed);
+  s.total_allocs.fetch_add(1, std::memory_order_relaxed);
+  s.total_bytes.fetch_add(sz, std::memory_order_relaxed);
+}
+
+void onFree(std::uint32_t id, std::size_t sz) noexcept {
+  Slot& s = g_slots[id];
+  s.live_bytes.fetch_sub(sz, std::memory_order_relaxed);
+  s.live_count.fetch_sub(1, std::memory_order_relaxed);
+  s.total_frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+void clearLive() noexcept {
+  std::lock_guard<std::mutex> lock(g_mu);
+  for (std::uint32_t i = 0; i < g_count; ++i) {
+    g_slots[i].live_bytes.store(0, std::memory_order_relaxed);
+    g_slots[i].live_count.store(0, std::memory_order_relaxed);
+  }
+}
+
+ThreadCounters totals() noexcept {
+  ThreadCounters sum;
+  std::lock_guard<std::mutex> lock(g_mu);
+  for (std::uint32_t i = 0; i < g_count; ++i) {
+    if (i != kUnknown && g_slots[i].state == kFree) continue;
+    ThreadCounters c;
+    load(c, g_slots[i]);
+    sum.live_bytes   += c.live_bytes;
+    sum.live_count   += c.live_count;
+    sum.total_allocs += c.total_allocs;
+    sum.total_frees  += c.total_frees;
+    sum.total_bytes  += c.total_bytes;
+    if (c.peak_bytes > sum.peak_bytes) sum.peak_bytes = c.peak_bytes;
+  }
+  sum.total_allocs += g_exited.total_allocs;
+  sum.total_frees  += g_exited.total_frees;
+  sum.total_bytes  += g_exited.total_bytes;
+  if (g_exited.peak_bytes > sum.peak_bytes) sum.peak_bytes = g_exited.peak_bytes;
+  return sum;
+}
+
+ThreadsSnapshot snapshot() {
+  ScopedHookGuard guard;
+  ThreadsSnapshot out;
+
+  // Lo que hace falta de cada slot, copiado con g_mu; /proc se lee despues
+  struct Pending { std::uint32_t id; std::uint64_t tid; };
+  std::vector<Pending> unnamed;
+  {
+    std::lock_guard<std::mutex> lock(g_mu);
+    out.threads.reserve(g_count);
+    for (std::uint32_t i = 0; i < g_count; ++i) {
+      const Slot& s = g_slots[i];
+      ThreadInfo t;
+      load(t.counters, s);
+      if (i == kUnknown) {
+        if (t.counters.total_allocs == 0) continue; // el 0 solo si se lleno la tabla
+        t.name = "(unregistered)";
+      } else {
+        if (s.state == kFree) continue;
+        t.os_tid = s.os_tid;
+        t.name   = s.name;
+        t.alive  = s.state == kAlive;
+        if (t.alive && !s.named) unnamed.push_back({i, s.os_tid});
+      }
+      t.id = i;
+      out.threads.push_back(std::move(t));
+    }
+    out.exited_threads = g_exited_threads;
+    out.exited         = g_exited;
+  }
+
+  // Los nombres del sistema pueden cambiar despues del registro
+  std::size_t k = 0;
+  for (const Pending& p : unnamed) {
+    char name[kMaxName];
+    if (!system_name_of(p.tid, name)) continue;
+    while (out.threads[k].id != p.id) ++k;
+    out.threads[k].name = name;
+  }
+  return out;
+}
+
+} // namespace threads
+} // namespace mp
@@ -0,0 +1,142 @@
+#include "../include/Timestamp.hpp"
+
+#include <algorithm>
+#include <thread>
+
+#if MP_HAVE_RDTSC
+#include <cpuid.h>
+#endif
+
+namespace mp {
+
+const char* timestamp_source_name(TimestampSource s) noexcept {
+  switch (s) {
+  case TimestampSource::Steady: return "steady";
+  case TimestampSource::Tsc:    return "tsc";
+  case TimestampSource::Coarse: return "coarse";
+  case TimestampSource::None:   return "none";
+  }
+  return "steady";
+}
+
+bool timestamp_source_from_name(const std::string& name, TimestampSource& out) noexcept {
+  for (TimestampSource s : {TimestampSource::Steady, TimestampSource::Tsc,
+                            TimestampSource::Coarse, TimestampSource::None}) {
+    if (name == timestamp_source_name(s)) { out = s; return true; }
+  }
+  return false;
+}
+
+namespace timestamps {
+
+namespace {
+
+  std::uint64_t steady_ns() noexcept {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+  }
+
+  std::uint64_t read_tsc() noexcept {
+#if MP_HAVE_RDTSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+  }
+
+  // Par (tsc, steady) de referencia, tomado al cargar la biblioteca. Los
+  // registros anteriores (asignaciones de otros inicializadores) quedan
+  // con delta negativo, que la conversion admite.
+  struct Anchor {
+    std::uint64_t tsc;
+    std::uint64_t ns;
+  };
+  Anchor take_anchor() noexcept {
+    // steady entre dos lecturas del TSC: el punto medio empareja mejor
+    const std::uint64_t a  = read_tsc();
+    const std::uint64_t ns = steady_ns();
+    const std::uint64_t b  = read_tsc();
+    return Anchor{a + (b - a) / 2, ns};
+  }
+  const Anchor g_anchor = take_anchor();
+
+  constexpr std::uint64_t kMinCalibrationNs = 10000000; // 10 ms
+
+  // La fuente de CMake se valida una vez: sin TSC invariante queda steady
+  [[maybe_unused]] const bool g_checked = [] {
+    if (static_cast<TimestampSource>(g_source.load()) == TimestampSource::Tsc && !tsc_invariant()) {
+      g_source.store(static_cast<std::uint8_t>(TimestampSource::Steady));
+    }
+    return true;
+  }();
+
+  // Picosegundos por tick, fijado por elapsed_ns (0 = sin calibrar)
+  std::atomic<std::uint64_t> g_ps_per_tick{0};
+
+  std::uint64_t ps_per_tick() noexcept {
+    const std::uint64_t cached = g_ps_per_tick.load(std::memory_order_relaxed);
+    if (cached) return cached;
+    const Anchor now = take_anchor();
+    if (now.tsc <= g_anchor.tsc) return 0;
+    const std::uint64_t ps = std::max<std::uint64_t>(
+        1, (now.ns - g_anchor.ns) * 1000 / (now.tsc - g_anchor.tsc));
+    if (now.ns - g_anchor.ns >= kMinCalibrationNs) g_ps_per_tick.store(ps, std::memory_order_relaxed);
+    return ps;
+  }
+
+} // namespace
+
+std::uint64_t elapsed_ns(std::uint64_t from, std::uint64_t to) noexcept {
+  if (!from || !to || ((from ^ to) & kTscTag)) return 0;
+  if (to <= from) return 0;
+  if (!(to & kTscTag)) return to - from;
+  return (to - from) * ps_per_tick() / 1000;
+}
+
+bool tsc_invariant() noexcept {
+#if MP_HAVE_RDTSC
+  unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+  if (!__get_cpuid(0x80000000u, &eax, &ebx, &ecx, &edx) || eax < 0x80000007u) return false;
+  if (!__get_cpuid(0x80000007u, &eax, &ebx, &ecx, &edx)) return false;
+  return (edx & (1u << 8)) != 0;
+#else
+  return false;
+#endif
+}
+
+TimestampSource source() noexcept {
+  return static_cast<TimestampSource>(g_source.load(std::memory_order_relaxed));
+}
+
+bool set_source(TimestampSource s, std::string* err) {
+  if (s == TimestampSource::Tsc && !tsc_invariant()) {
+    if (err) *err = "invariant TSC not available";
+    return false;
+  }
+  g_source.store(static_cast<std::uint8_t>(s), std::memory_order_relaxed);
+  return true;
+}
+
+Converter::Converter() noexcept : tsc0_(g_anchor.tsc), ns0_(g_anchor.ns) {
+#if MP_HAVE_RDTSC
+  Anchor now = take_anchor();
+  if (now.ns - ns0_ < kMinCalibrationNs) {
+    std::this_thread::sleep_for(std::chrono::nanoseconds(kMinCalibrationNs - (now.ns - ns0_)));
+    now = take_anchor();
+  }
+  if (now.tsc > tsc0_) {
+    ns_per_tick_ = static_cast<double>(now.ns - ns0_) / static_cast<double>(now.tsc - tsc0_);
+  }
+#endif
+}
+
+std::uint64_t Converter::operator()(std::uint64_t raw) const noexcept {
+  if (!(raw & kTscTag)) return raw; // ya en ns (steady/coarse) o 0 (none)
+  const auto dt = static_cast<std::int64_t>((raw & ~kTscTag) - tsc0_);
+  const auto ns = static_cast<std::int64_t>(ns0_) +
+                  static_cast<std::int64_t>(static_cast<double>(dt) * ns_per_tick_);
+  return ns > 0 ? static_cast<std::uint64_t>(ns) : 0;
+}
+
+} // namespace timestamps
+} // namespace mp
@@ -0,0 +1,298 @@
+#include "../include/TrackingMode.hpp"
+#include "../include/TrackingPolicies.hpp"
+#include "../include/BootRecorder.hpp"
+#include "../include/CallbacksRegistration.hpp"
+#include "../include/Epoch.hpp"
+#include "../include/MemoryTracker.hpp"
+#include "../include/ReentryGuard.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+namespace mp {
+
+namespace {
+
+  using policy::Counters;
+
+  // === Hooks de cada modo (rawAlloc/rawFree de la tabla) ===
+  //
+  // A diferencia de las politicas estaticas, aqui los contadores respetan
+  // in_hook: no arrancan con el proceso, asi que contar lo interno del
+  // profiler (nodos del tracker, buffers del socket) solo agregaria frees
+  // de bloques que nunca se sumaron.
+
+  std::size_t usable(void* p) noexcept { return malloc_usable_size(p); }
+
+  void countersAlloc(void* p, std::size_t, bool) {
+    if (!in_hook) Counters::add(usable(p));
+  }
+  void countersFree(void* p, bool) noexcept {
+    if (!in_hook) Counters::sub(usable(p));
+  }
+
+  // Mientras se vacia el tracker (full -> counters) un free puede ser de un
+  // bloque que todavia esta en el tracker: ese no se resta de los contadores,
+  // porque entra a ellos recien con drain()
+  void drainingFree(void* p, bool isArray) noexcept {
+    if (in_hook) return;
+    in_hook = true;
+    const bool owned = MemoryTracker::instance().onFree(p, isArray);
+    in_hook = false;
+    if (!owned) Counters::sub(usable(p));
+  }
+
+  // Muestreo con contadores que respetan in_hook (ver arriba)
+  void sampledAlloc(void* p, std::size_t sz, bool isArray) {
+    if (in_hook) return;
+    Counters::add(usable(p));
+    policy::Sampled::until_sample -= static_cast<std::int64_t>(sz);
+    if (policy::Sampled::until_sample > 0) return;
+    policy::Sampled::until_sample = policy::Sampled::kSampleBytes;
+
+    in_hook = true;
+    MemoryTracker::instance().onAlloc(p, sz, current_callsite_id(), isArray);
+    policy::Sampled::bump(policy::Sampled::slot(p, 0), 1);
+    policy::Sampled::bump(policy::Sampled::slot(p, 1), 1);
+    clearCallsite();
+    in_hook = false;
+  }
+  void sampledFree(void* p, bool isArray) noexcept {
+    if (in_hook) return;
+    Counters::sub(usable(p));
+    if (!policy::Sampled::maybeSampled(p)) return;
+    in_hook = true;
+    if (MemoryTracker::instance().onFree(p, isArray)) {
+      policy::Sampled::bump(policy::Sampled::slot(p, 0), -1);
+      policy::Sampled::bump(policy::Sampled::slot(p, 1), -1);
+    }
+    in_hook = false;
+  }
+
+  // Full: el tracker registra todo; un free desconocido puede ser de un
+  // bloque contado antes en modo counters, y se descuenta de esa base
+  // mientras le queden bloques
+  void fullFree(void* p, bool isArray) noexcept {
+    if (in_hook) return;
+    in_hook = true;
+    const bool late = boot::latePending(); // antes de buscar (BootRecorder.hpp)
+    MemoryTracker& t = MemoryTracker::instance();
+    bool known = t.hasLive() && t.onFree(p, isArray); // vacio: ni se busca
+    if (!known && late) known = boot::lateFree(t, p);
+    in_hook = false;
+    if (!known && Counters::in_use.load(std::memory_order_relaxed) > 0) {
+      Counters::subShared(usable(p));
+    }
+  }
+
+  std::size_t baselineBytes() { return Counters::bytesInUse(); }
+
+  // === Consultas segun de donde salen los totales ===
+
+  void countersTotals(Callbacks& cb) {
+    cb.bytesInUse = [] { return Counters::bytesInUse(); };
+    cb.peakBytes  = [] { return Counters::peakBytes();  };
+    cb.allocCount = [] { return Counters::allocCount(); };
+    cb.aggregate  = [](std::size_t topCallsites) {
+      auto s = MemoryTracker::instance().aggregateStats(topCallsites);
+      Counters::fillTotals(s);
+      return s;
+    };
+  }
+
+  // Tracker + base heredada de counters (cero si nunca hubo counters)
+  void fullTotals(Callbacks& cb) {
+    cb.bytesInUse = [] { return MemoryTracker::instance().activeBytes() + Counters::bytesInUse(); };
+    cb.peakBytes  = [] { return std::max(MemoryTracker::instance().peakBytes(), Counters::peakBytes()); };
+    cb.allocCount = [] { return MemoryTracker::instance().totalAllocs() + Counters::allocCount(); };
+    cb.aggregate  = [](std::size_t topCallsites) {
+      auto s = MemoryTracker::instance().aggregateStats(topCallsites);
+      AggregateStats base;
+      Counters::fillTotals(base);
+      s.bytes_in_use += base.bytes_in_use;
+      s.live_count   += base.live_count;
+      s.total_allocs += base.total_allocs;
+      s.total_frees  += base.total_frees;
+      s.total_bytes  += base.total_bytes;
+      s.peak          = std::max(s.peak, base.peak);
+      return s;
+    };
+  }
+
+  // Tabla para un modo. dataMode = modo cuyos totales se reportan
+  // (para Off, el modo anterior).
+  Callbacks makeTable(TrackingMode m, TrackingMode dataMode) {
+    Callbacks cb = make_memorytracker_callbacks();
+    if (dataMode == TrackingMode::Full) fullTotals(cb);
+    else countersTotals(cb);
+
+    switch (m) {
+      // Con mp::stop(): off y full no hacen nada en new (una rama en el
+      // hook); counters y sampled siguen contando, sin muestrear
+      case TrackingMode::Off:
+        cb.rawAlloc = &policy::NoTracking::onAlloc;
+        cb.rawFree  = &policy::NoTracking::onFree;
+        break;
+      case TrackingMode::Counters:
+        cb.rawAlloc        = &countersAlloc;
+        cb.rawFree         = &countersFree;
+        cb.rawAllocStopped = &countersAlloc;
+        cb.rawFreeStopped  = &countersFree;
+        break;
+      case TrackingMode::Sampled:
+        cb.rawAlloc        = &sampledAlloc;
+        cb.rawFree         = &sampledFree;
+        cb.rawAllocStopped = &countersAlloc;
+        cb.rawFreeStopped  = &sampledFree;
+        break;
+      case TrackingMode::Full:
+      case TrackingMode::Custom:
+      case TrackingMode::Header:   // no se publica (ver set_tracking_mode)
+        cb.rawAlloc       = &policy::FullTracking::onAlloc;
+        cb.rawFree        = &fullFree;
+        cb.rawFreeStopped = &fullFree;
+        break;
+    }
+    return cb;
+  }
+
+  // === Estado del selector (solo se toca con switch_mutex() tomado) ===
+
+  std::mutex& switch_mutex() {
+    static std::mutex m;
+    return m;
+  }
+  TrackingMode  g_current = TrackingMode::Off;   // ultimo modo publicado aqui
+  TrackingMode  g_data    = TrackingMode::Counters; // donde viven los datos (Off lo hereda)
+  std::uint32_t g_version = 0;                   // version de la tabla que publicamos
+  bool          g_stale   = false;               // el tracker paso por off: puede tener
+                                                 // registros de bloques ya liberados
+
+  void publish(TrackingMode m, TrackingMode dataMode) {
+    register_callbacks(makeTable(m, dataMode));
+    g_version = callbacks_version();
+  }
+
+} // namespace
+
+const char* tracking_mode_name(TrackingMode m) noexcept {
+  switch (m) {
+    case TrackingMode::Off:      return "off";
+    case TrackingMode::Counters: return "counters";
+    case TrackingMode::Sampled:  return "sampled";
+    case TrackingMode::Full:     return "full";
+    case TrackingMode::Custom:   return "custom";
+    case TrackingMode::Header:   return "header";
+  }
+  return "custom";
+}
+
+bool tracking_mode_from_name(const std::string& name, TrackingMode& out) noexcept {
+  if (name == "off")      { out = TrackingMode::Off;      return true; }
+  if (name == "counters") { out = TrackingMode::Counters; return true; }
+  if (name == "sampled")  { out = TrackingMode::Sampled;  return true; }
+  if (name == "full")     { out = TrackingMode::Full;     return true; }
+  if (name == "header")   { out = TrackingMode::Header;   return true; }
+  return false;
+}
+
+std::string tracking_modes_json() {
+  if constexpr (kDynamicPolicy) {
+    return "[\"off\",\"counters\",\"sampled\",\"full\"]";
+  }
+  return std::string("[\"") + tracking_mode_name(tracking_mode()) + "\"]";
+}
+
+TrackingMode tracking_mode() noexcept {
+  if constexpr (std::is_same<ActivePolicy, policy::NoTracking>::value)   return TrackingMode::Off;
+  if constexpr (std::is_same<ActivePolicy, policy::CountersOnly>::value) return TrackingMode::Counters;
+  if constexpr (std::is_same<ActivePolicy, policy::Sampled>::value)      return TrackingMode::Sampled;
+  if constexpr (std::is_same<ActivePolicy, policy::FullTracking>::value) return TrackingMode::Full;
+  if constexpr (std::is_same<ActivePolicy, policy::HeaderPrefix>::value) return TrackingMode::Header;
+
+  std::lock_guard<std::mutex> lock(switch_mutex());
+  const std::uint32_t v = callbacks_version();
+  if (v == 0) return TrackingMode::Off;
+  return v == g_version ? g_current : TrackingMode::Custom;
+}
+
+bool set_tracking_mode(TrackingMode target, std::string* err) {
+  if constexpr (!kDynamicPolicy) {
+    if (err) *err = "tracking policy fixed at compile time (MP_TRACKING_POLICY)";
+    return false;
+  }
+  if (target == TrackingMode::Custom) {
+    if (err) *err = "custom is not a selectable mode";
+    return false;
+  }
+  if (target == TrackingMode::Header) {
+    if (err) *err = "header mode requires MP_TRACKING_POLICY=Header";
+    return false;
+  }
+
+  ScopedHookGuard guard;
+  std::lock_guard<std::mutex> lock(switch_mutex());
+
+  // Si alguien publico su propia tabla no sabemos que datos hay: se parte
+  // de los contadores tal como esten
+  const std::uint32_t v = callbacks_version();
+  TrackingMode from = (v != 0 && v == g_version) ? g_current : TrackingMode::Custom;
+  if (from == TrackingMode::Off) from = g_data;
+  if (from == TrackingMode::Custom) from = TrackingMode::Counters;
+
+  if (target == TrackingMode::Off) {
+    publish(TrackingMode::Off, g_data == TrackingMode::Full ? TrackingMode::Full : TrackingMode::Counters);
+    g_current = TrackingMode::Off;
+    if (g_data != TrackingMode::Counters) g_stale = true;
+    return true;
+  }
+
+  if (from == target && g_current == target) return true;
+
+  if (from != target) {
+    if (from == TrackingMode::Full) {
+      // full -> counters: primero una tabla cuyos frees consultan al tracker,
+      // luego (sin lectores de la tabla full) el tracker pasa a los contadores
+      Callbacks drainTable = makeTable(TrackingMode::Counters, TrackingMode::Full);
+      drainTable.rawFree        = &drainingFree;
+      drainTable.rawFreeStopped = &drainingFree;
+      register_callbacks(drainTable);
+      g_version = callbacks_version();
+      epoch::synchronize();
+
+      MemoryTracker& t = MemoryTracker::instance();
+      // Con registros viejos no se puede pedir malloc_usable_size (el bloque
+      // pudo liberarse mientras estaba en off): se usa el tamaño pedido
+      const MemoryTracker::Handoff h = t.drain(g_stale ? nullptr : &usable);
+      g_stale = false;
+      t.setBaseline(nullptr);
+      Counters::in_use.fetch_add(static_cast<std::int64_t>(h.live_usable_bytes), std::memory_order_relaxed);
+      Counters::allocs.fetch_add(h.total_allocs, std::memory_order_relaxed);
+      Counters::frees.fetch_add(h.total_frees, std::memory_order_relaxed);
+      Counters::total_bytes.fetch_add(h.total_bytes, std::memory_order_relaxed);
+      Counters::raisePeak(std::max<std::int64_t>(static_cast<std::int64_t>(h.peak),
+                                                 Counters::totals().in_use));
+    } else if (from == TrackingMode::Sampled) {
+      // sampled -> counters: las muestras se descartan; los totales ya
+      // estaban en los contadores
+      publish(TrackingMode::Counters, TrackingMode::Counters);
+      epoch::synchronize();
+      MemoryTracker::instance().resetForTesting();
+      policy::Sampled::clearFilter();
+      g_stale = false;
+    }
+  }
+
+  if (target == TrackingMode::Full && from != TrackingMode::Full) {
+    // La base que descuenta fullFree vive en el global, no en los shards
+    Counters::flushAll();
+    MemoryTracker::instance().setBaseline(&baselineBytes);
+  }
+  publish(target, target == TrackingMode::Full ? TrackingMode::Full : TrackingMode::Counters);
+  g_current = target;
+  g_data    = target;
+  epoch::try_reclaim();
+  return true;
+}
+
+} // namespace mp
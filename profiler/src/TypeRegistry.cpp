@@ -0,0 +1,67 @@
+#include "../include/TypeRegistry.hpp"
+#include "../include/ReentryGuard.hpp"
+
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+
+#include <cxxabi.h>
+
+namespace mp {
+namespace types {
+
+namespace {
+
+  struct Registry {
+    std::mutex mu;
+    std::unordered_map<const char*, std::uint32_t> by_ptr;    // camino rapido
+    std::unordered_map<std::string, std::uint32_t>  by_raw;   // mismo texto, otro puntero
+    std::vector<std::string> names{"unknown"};
+  };
+  Registry& registry() {
+    static Registry* r = new Registry(); // nunca se destruye
+    return *r;
+  }
+
+  // Los nombres de typeid vienen mangleados ("N3app4BlobE"); los de
+  // type_name<T>() ya son legibles y __cxa_demangle los rechaza
+  std::string demangle(const char* raw) {
+    int status = 0;
+    char* dem = abi::__cxa_demangle(raw, nullptr, nullptr, &status);
+    std::string out = (status == 0 && dem) ? dem : raw;
+    std::free(dem);
+    return out;
+  }
+
+} // namespace
+
+std::uint32_t intern(const char* raw) {
+  if (!raw || !*raw) return kUnknown;
+  ScopedHookGuard guard; // la tabla no se atribuye a nadie
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mu);
+  auto it = r.by_ptr.find(raw);
+  if (it != r.by_ptr.end()) return it->second;
+
+  auto ins = r.by_raw.emplace(raw, static_cast<std::uint32_t>(r.names.size()));
+  if (ins.second) r.names.push_back(demangle(raw));
+  r.by_ptr.emplace(raw, ins.first->second);
+  return ins.first->second;
+}
+
+std::string name(std::uint32_t id) {
+  ScopedHookGuard guard;
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mu);
+  return id < r.names.size() ? r.names[id] : r.names[kUnknown];
+}
+
+std::vector<std::string> names() {
+  ScopedHookGuard guard;
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mu);
+  return r.names;
+}
+
+} // namespace types
+} // namespace mp
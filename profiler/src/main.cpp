@@ -12,6 +12,7 @@
 #include "ProfilerNew.hpp"
 #include "SocketClient.hpp"
 #include "CallbacksRegistration.hpp"
+#include "Sections.hpp"
 
 // Conditional profiler API inclusion
 #ifdef MP_USE_API
@@ -33,6 +34,7 @@ namespace mp {
     ModuleResult runFragmenter(const WorkloadConfig& config, uint32_t thread_id, uint64_t duration_ms);
     ModuleResult runVectorChurn(const WorkloadConfig& config, uint32_t thread_id, uint64_t duration_ms);
     ModuleResult runTreeFactory(const WorkloadConfig& config, uint32_t thread_id, uint64_t duration_ms);
+    ModuleResult runAlignedChurn(const WorkloadConfig& config, uint32_t thread_id, uint64_t duration_ms);
 }
 
 namespace mp {
@@ -44,14 +46,22 @@ void workerThread(const WorkloadConfig& config, uint32_t thread_id,
                   std::atomic<bool>& should_stop, std::vector<ModuleResult>& results, std::mutex& results_mutex) {
     Timer thread_timer;
     RNG rng(config.seed + thread_id);
+
+    // Shows up as "worker-<index>" in THREADS and STATS
+    mp::set_thread_name(("worker-" + std::to_string(thread_id)).c_str());
+
+    // Everything this thread allocates is attributed to "worker", and each
+    // module to its own child section
+    ScopedSection worker_section("worker");
     
     // Module execution sequence
     std::vector<std::function<ModuleResult()>> modules = {
-        [&]() { return runAllocStorm(config, thread_id, 1000); },
-        [&]() { return runVectorChurn(config, thread_id, 1000); },
-        [&]() { return runFragmenter(config, thread_id, 1000); },
-        [&]() { return runTreeFactory(config, thread_id, 1000); },
-        [&]() { return runLeakFactory(config, thread_id, 1000); }
+        [&]() { ScopedSection s("AllocStorm");  return runAllocStorm(config, thread_id, 1000); },
+        [&]() { ScopedSection s("VectorChurn"); return runVectorChurn(config, thread_id, 1000); },
+        [&]() { ScopedSection s("Fragmenter");  return runFragmenter(config, thread_id, 1000); },
+        [&]() { ScopedSection s("TreeFactory"); return runTreeFactory(config, thread_id, 1000); },
+        [&]() { ScopedSection s("AlignedChurn"); return runAlignedChurn(config, thread_id, 1000); },
+        [&]() { ScopedSection s("LeakFactory"); return runLeakFactory(config, thread_id, 1000); }
     };
     
     uint32_t cycle_count = 0;
@@ -90,6 +100,7 @@ void workerThread(const WorkloadConfig& config, uint32_t thread_id,
  * Snapshot thread for periodic profiler API calls
  */
 void snapshotThread(const WorkloadConfig& config, std::atomic<bool>& should_stop) {
+    mp::set_thread_name("snapshot");
 #if MP_HAVE_API
     while (!should_stop.load()) {
         try {
@@ -162,6 +173,28 @@ void printSummary(const WorkloadConfig& config, const std::vector<std::vector<Mo
                   << formatBytes(stats.bytes_allocated) << " bytes, "
                   << stats.duration_ms << "ms\n";
     }
+
+#if MP_HAVE_API
+    // Same breakdown as seen by the profiler (inclusive, per section)
+    const std::vector<SectionUsage> sections = sections::snapshot();
+    if (sections.size() > 1) {
+        std::cout << "\nProfiler Sections (inclusive):\n";
+        std::vector<std::vector<uint32_t>> children(sections.size());
+        for (size_t i = 1; i < sections.size(); ++i) children[sections[i].parent].push_back(static_cast<uint32_t>(i));
+
+        std::function<void(uint32_t, int)> print = [&](uint32_t id, int depth) {
+            for (uint32_t child : children[id]) {
+                const SectionCounters& c = sections[child].inclusive;
+                std::cout << std::string(2 + depth * 2, ' ') << sections[child].name << ": "
+                          << c.total_allocs << " allocs, "
+                          << formatBytes(c.total_bytes) << " bytes, "
+                          << formatBytes(c.live_bytes) << " live\n";
+                print(child, depth + 1);
+            }
+        };
+        print(sections::kRoot, 0);
+    }
+#endif
     
     std::cout << "========================\n";
 }
@@ -0,0 +1,233 @@
+#include "WorkloadConfig.hpp"
+#include "Utilities.hpp"
+#include "Types.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace mp {
+
+namespace {
+
+/**
+ * Per-thread counter padded to its own cache line (alignas(64))
+ */
+struct alignas(64) CacheLineCounter {
+    uint64_t value = 0;
+    uint64_t hits = 0;
+};
+
+/**
+ * Page-aligned buffer, as used for DMA or mmap-style I/O (alignas(4096))
+ */
+struct alignas(4096) PageBuffer {
+    char bytes[4096];
+    explicit PageBuffer(char fill) { bytes[0] = fill; bytes[4095] = fill; }
+};
+
+bool isAligned(const void* p, size_t alignment) {
+    return (reinterpret_cast<uintptr_t>(p) & (alignment - 1)) == 0;
+}
+
+} // namespace
+
+/**
+ * AlignedChurn module - Stresses the over-aligned and nothrow new/delete forms
+ *
+ * This module creates memory patterns by:
+ * - Allocating alignas(64) and alignas(4096) objects one by one
+ *   (operator new(size_t, align_val_t) and its sized delete)
+ * - Allocating arrays of over-aligned types (operator new[] with alignment)
+ * - Using new (std::nothrow) for plain and over-aligned objects
+ * - Growing std::vector of over-aligned elements (allocator path)
+ * - Freeing in shuffled order, and verifying every returned alignment
+ */
+class AlignedChurn {
+public:
+    explicit AlignedChurn(const WorkloadConfig& config) : config_(config) {}
+
+    ModuleResult execute(uint32_t thread_id, uint64_t duration_ms) {
+        ModuleResult result("AlignedChurn");
+        Timer timer;
+        RNG rng(config_.seed + thread_id + 5000);  // Different seed offset
+
+        uint64_t end_time = currentTimeMillis() + duration_ms;
+        uint32_t churn_cycles = 0;
+
+        while (currentTimeMillis() < end_time) {
+            // Pattern 1: Single over-aligned objects, shuffled frees
+            executeSingleObjectPattern(rng, result);
+
+            // Pattern 2: Arrays of over-aligned objects
+            executeArrayPattern(rng, result);
+
+            // Pattern 3: nothrow forms
+            executeNothrowPattern(rng, result);
+
+            // Pattern 4: Vector of over-aligned elements
+            executeVectorPattern(rng, result);
+
+            churn_cycles++;
+
+            // Small delay between cycles
+            if (rng.randBool(0.2)) {
+                sleepMillis(rng.randInt(1, 3));
+            }
+        }
+
+        result.stats.duration_ms = timer.elapsedMillis();
+        if (misaligned_ != 0) {
+            result.success = false;
+            result.error_message = std::to_string(misaligned_) + " misaligned blocks";
+        }
+
+        if (!config_.quiet) {
+            std::cout << "Thread " << thread_id << " AlignedChurn: "
+                      << churn_cycles << " cycles, "
+                      << result.stats.allocations << " allocs, "
+                      << misaligned_ << " misaligned\n";
+        }
+
+        return result;
+    }
+
+private:
+    const WorkloadConfig& config_;
+    uint64_t misaligned_ = 0;
+
+    void check(const void* p, size_t alignment) {
+        if (!isAligned(p, alignment)) misaligned_++;
+    }
+
+    /**
+     * Pattern 1: Single alignas(64) and alignas(4096) objects
+     */
+    void executeSingleObjectPattern(RNG& rng, ModuleResult& result) {
+        uint32_t count = rng.randInt(50, config_.getScaled(400));
+        std::vector<CacheLineCounter*> counters;
+        std::vector<PageBuffer*> pages;
+        counters.reserve(count);
+
+        for (uint32_t i = 0; i < count; ++i) {
+            auto* c = new CacheLineCounter();
+            check(c, alignof(CacheLineCounter));
+            c->value = i;
+            counters.push_back(c);
+            result.stats.allocations++;
+            result.stats.bytes_allocated += sizeof(CacheLineCounter);
+
+            // Pages are rarer and larger
+            if (rng.randBool(0.1)) {
+                auto* p = new PageBuffer(static_cast<char>(i));
+                check(p, alignof(PageBuffer));
+                pages.push_back(p);
+                result.stats.allocations++;
+                result.stats.bytes_allocated += sizeof(PageBuffer);
+            }
+        }
+
+        // Non-ordered deallocation
+        while (!counters.empty()) {
+            uint32_t index = rng.randInt(0, static_cast<uint32_t>(counters.size() - 1));
+            std::swap(counters[index], counters.back());
+            delete counters.back();
+            counters.pop_back();
+            result.stats.deallocations++;
+            result.stats.bytes_deallocated += sizeof(CacheLineCounter);
+        }
+        for (PageBuffer* p : pages) {
+            delete p;
+            result.stats.deallocations++;
+            result.stats.bytes_deallocated += sizeof(PageBuffer);
+        }
+
+        result.stats.peak_memory = std::max<uint64_t>(result.stats.peak_memory,
+            count * sizeof(CacheLineCounter) + pages.size() * sizeof(PageBuffer));
+    }
+
+    /**
+     * Pattern 2: new[]/delete[] of over-aligned types
+     */
+    void executeArrayPattern(RNG& rng, ModuleResult& result) {
+        uint32_t arrays = rng.randInt(5, config_.getScaled(30));
+        for (uint32_t i = 0; i < arrays; ++i) {
+            uint32_t n = rng.randInt(1, 64);
+            auto* line_array = new CacheLineCounter[n];
+            check(line_array, alignof(CacheLineCounter));
+            line_array[n - 1].hits = n;
+            result.stats.allocations++;
+            result.stats.bytes_allocated += n * sizeof(CacheLineCounter);
+
+            uint32_t pages = rng.randInt(1, 4);
+            auto* page_array = static_cast<PageBuffer*>(
+                ::operator new[](pages * sizeof(PageBuffer), std::align_val_t{alignof(PageBuffer)}));
+            check(page_array, alignof(PageBuffer));
+            page_array[0].bytes[0] = 1;
+            result.stats.allocations++;
+            result.stats.bytes_allocated += pages * sizeof(PageBuffer);
+
+            delete[] line_array;
+            ::operator delete[](page_array, std::align_val_t{alignof(PageBuffer)});
+            result.stats.deallocations += 2;
+            result.stats.bytes_deallocated += n * sizeof(CacheLineCounter) + pages * sizeof(PageBuffer);
+        }
+    }
+
+    /**
+     * Pattern 3: new (std::nothrow), plain and over-aligned
+     */
+    void executeNothrowPattern(RNG& rng, ModuleResult& result) {
+        uint32_t count = rng.randInt(20, config_.getScaled(200));
+        for (uint32_t i = 0; i < count; ++i) {
+            size_t size = rng.randSize(16, 2048, config_.scale);
+            char* buffer = new (std::nothrow) char[size];
+            auto* counter = new (std::nothrow) CacheLineCounter();
+            if (!buffer || !counter) {
+                delete[] buffer;
+                delete counter;
+                continue;
+            }
+            check(counter, alignof(CacheLineCounter));
+            buffer[0] = static_cast<char>(i);
+            counter->hits++;
+            result.stats.allocations += 2;
+            result.stats.bytes_allocated += size + sizeof(CacheLineCounter);
+
+            delete[] buffer;
+            delete counter;
+            result.stats.deallocations += 2;
+            result.stats.bytes_deallocated += size + sizeof(CacheLineCounter);
+        }
+    }
+
+    /**
+     * Pattern 4: std::vector growth with over-aligned elements
+     */
+    void executeVectorPattern(RNG& rng, ModuleResult& result) {
+        std::vector<CacheLineCounter> counters;
+        uint32_t pushes = rng.randInt(100, config_.getScaled(2000));
+        for (uint32_t i = 0; i < pushes; ++i) {
+            size_t before = counters.capacity();
+            counters.emplace_back();
+            if (counters.capacity() != before) {
+                check(counters.data(), alignof(CacheLineCounter));
+                result.stats.allocations++;
+                result.stats.bytes_allocated += counters.capacity() * sizeof(CacheLineCounter);
+            }
+        }
+        result.stats.deallocations++;
+    }
+};
+
+/**
+ * Factory function to create and execute AlignedChurn
+ */
+ModuleResult runAlignedChurn(const WorkloadConfig& config, uint32_t thread_id, uint64_t duration_ms) {
+    AlignedChurn churn(config);
+    return churn.execute(thread_id, duration_ms);
+}
+
+} // namespace mp
@@ -124,16 +124,16 @@ private:
             } catch (const std::runtime_error& e) {
                 // Exception caught - ensure no memory leaks
                 if (root != nullptr) {
-                    Node::deleteTree(root);
                     result.stats.deallocations += Node::countNodes(root);
+                    Node::deleteTree(root);
                 }
                 // Continue execution - this is expected behavior
             }
             
             // If no exception occurred, clean up normally
             if (root != nullptr) {
-                Node::deleteTree(root);
                 result.stats.deallocations += Node::countNodes(root);
+                Node::deleteTree(root);
             }
         }
     }
@@ -161,16 +161,16 @@ private:
             trees.erase(trees.begin() + index);
             
             if (tree != nullptr) {
-                Node::deleteTree(tree);
                 result.stats.deallocations += Node::countNodes(tree);
+                Node::deleteTree(tree);
             }
         }
         
         // Clean up remaining trees
         for (Node* tree : trees) {
             if (tree != nullptr) {
-                Node::deleteTree(tree);
                 result.stats.deallocations += Node::countNodes(tree);
+                Node::deleteTree(tree);
             }
         }
         trees.clear();
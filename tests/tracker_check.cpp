@@ -0,0 +1,189 @@
+// mp_tracker_check: regresiones del seguimiento en modo full y en modo
+// counters (ctest).
+//
+// Cada caso corre con el tracker vacio (resetForTesting) y el modo full en
+// marcha, salvo los de counters, que cambian de modo y lo devuelven; imprime FAIL con lo esperado y lo obtenido y el programa sale con
+// 1 si alguno fallo. Cada bloque pasa por g_sink para que el compilador no
+// elimine el par new/delete.
+
+#include "CallbacksRegistration.hpp"
+#include "CallerPc.hpp"
+#include "MemoryTracker.hpp"
+#include "ProfilerAPI.hpp"
+#include "ProfilerNew.hpp"
+#include "TrackingPolicies.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace {
+
+int g_failures = 0;
+void* volatile g_sink = nullptr;
+
+void expect(bool ok, const char* test, const std::string& detail) {
+    if (ok) return;
+    std::printf("FAIL %s: %s\n", test, detail.c_str());
+    ++g_failures;
+}
+
+void resetTracker() {
+    mp::MemoryTracker::instance().resetForTesting();
+}
+
+// Bloques que nacen y mueren en el buffer de recientes del hilo tambien
+// mueven el pico
+void peakCountsRecentBlocks() {
+    constexpr int         kBlocks = 20;
+    constexpr std::size_t kSize   = 1 << 20;
+    resetTracker();
+    char* blocks[kBlocks];
+    for (char*& b : blocks) g_sink = b = new char[kSize];
+    for (char* b : blocks) delete[] b;
+
+    const std::size_t peak = mp::MemoryTracker::instance().peakBytes();
+    expect(peak >= kBlocks * kSize, "peak_counts_recent_blocks",
+           "peak " + std::to_string(peak) + " < " + std::to_string(kBlocks * kSize));
+}
+
+// Los bloques cancelados en el buffer cuentan en el total_allocs de su
+// callsite: la suma por callsite da el total
+void callsiteTotalsCountRecentBlocks() {
+    resetTracker();
+    for (int i = 0; i < 100; ++i) {
+        int* p = new int(i);
+        g_sink = p;
+        delete p;
+    }
+
+    const mp::AggregateStats st = mp::MemoryTracker::instance().aggregateStats(SIZE_MAX);
+    std::uint64_t sum = 0;
+    for (const mp::CallsiteUsage& c : st.top_callsites) sum += c.total_allocs;
+    expect(st.total_allocs >= 100 && sum == st.total_allocs, "callsite_totals_count_recent_blocks",
+           "sum of callsites " + std::to_string(sum) + ", total_allocs " + std::to_string(st.total_allocs));
+}
+
+struct Tagged { int v = 0; };
+
+// El tag de MP_NEW_FT es solo para su asignacion, aunque esta no se
+// registre (profiler detenido)
+void callsiteTagIsNotSticky() {
+    resetTracker();
+    mp::stop();
+    Tagged* t = MP_NEW_FT(Tagged);
+    mp::start();
+    char* big = new char[1 << 20];
+    g_sink = big;
+
+    const char* type = nullptr;
+    for (const mp::AllocationRecord& r : mp::MemoryTracker::instance().snapshotLive()) {
+        if (r.ptr != big) continue;
+        if (const mp::CallsiteDescriptor* d = mp::callsite_descriptor(r.callsite_id)) type = d->type_name;
+    }
+    expect(!type || std::strcmp(type, mp::type_name<Tagged>()) != 0, "callsite_tag_is_not_sticky",
+           std::string("untagged block recorded as ") + (type ? type : "(null)"));
+    delete[] big;
+    delete t;
+}
+
+// Un ScopedCallsite (sin descriptor estatico) queda en el registro como
+// id de callsite, y los agregados lo nombran "file:line"
+void scopedCallsiteIsRecorded() {
+    resetTracker();
+    char* big = nullptr;
+    {
+        mp::ScopedCallsite cs("scoped_check.cpp", 42, "ScopedType");
+        g_sink = big = new char[1 << 20];
+    }
+
+    const mp::CallsiteDescriptor* d = nullptr;
+    for (const mp::AllocationRecord& r : mp::MemoryTracker::instance().snapshotLive()) {
+        if (r.ptr == big) d = mp::callsite_descriptor(r.callsite_id);
+    }
+    expect(d && d->file && std::strcmp(d->file, "scoped_check.cpp") == 0 && d->line == 42 &&
+               d->type_name && std::strcmp(d->type_name, "ScopedType") == 0,
+           "scoped_callsite_is_recorded", "block has no scoped_check.cpp:42 ScopedType descriptor");
+
+    bool named = false;
+    for (const mp::CallsiteUsage& c : mp::MemoryTracker::instance().aggregateStats(SIZE_MAX).top_callsites) {
+        named = named || c.callsite == "scoped_check.cpp:42";
+    }
+    expect(named, "scoped_callsite_is_recorded", "no scoped_check.cpp:42 in top callsites");
+    delete[] big;
+}
+
+// Los ids de PC son densos: cada id registrado esta en 1..count() y tiene
+// su PC (sin MP_CALLER_PC no hay ids y no se comprueba nada)
+void callerPcIdsAreDense() {
+    resetTracker();
+    char* big = new char[1 << 20];
+    g_sink = big;
+    const std::uint32_t count = mp::pcs::count();
+    for (const mp::AllocationRecord& r : mp::MemoryTracker::instance().snapshotLive()) {
+        if (r.pc_id == 0) continue;
+        expect(r.pc_id <= count && mp::pcs::address(r.pc_id) != 0, "caller_pc_ids_are_dense",
+               "pc id " + std::to_string(r.pc_id) + " with " + std::to_string(count) + " PCs");
+    }
+    delete[] big;
+}
+
+// Tamaños mezclados con sized delete: glibc a veces entrega un chunk sin
+// partir (malloc(564) con 584 utilizables), y el free tiene que restar lo
+// mismo que sumo el alloc
+void countersChurnReturnsToBaseline() {
+    constexpr int kSlots = 256;
+    constexpr int kRounds = 200000;
+    std::string err;
+    if (!mp::set_tracking_mode("counters", &err)) {
+        expect(false, "counters_churn_returns_to_baseline", "MODE counters: " + err);
+        return;
+    }
+    void*       blocks[kSlots] = {};
+    std::size_t sizes[kSlots]  = {};
+    const std::size_t baseline = mp::policy::Counters::bytesInUse();
+
+    std::uint32_t seed = 12345;
+    for (int i = 0; i < kRounds; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        const int slot = static_cast<int>((seed >> 8) % kSlots);
+        if (blocks[slot]) ::operator delete(blocks[slot], sizes[slot]);
+        sizes[slot]  = 16 + (seed >> 20) % 2048;
+        g_sink = blocks[slot] = ::operator new(sizes[slot]);
+    }
+    for (int i = 0; i < kSlots; ++i) ::operator delete(blocks[i], sizes[i]);
+
+    const std::size_t after = mp::policy::Counters::bytesInUse();
+    expect(after == baseline, "counters_churn_returns_to_baseline",
+           "bytes in use " + std::to_string(after) + ", baseline " + std::to_string(baseline));
+    if (!mp::set_tracking_mode("full", &err)) {
+        expect(false, "counters_churn_returns_to_baseline", "MODE full: " + err);
+    }
+}
+
+} // namespace
+
+int main() {
+    if constexpr (!mp::kDynamicPolicy) {
+        std::printf("skipped: needs MP_TRACKING_POLICY=Dynamic\n");
+        return 0;
+    }
+    mp::install_callbacks_with_memorytracker();
+    mp::start();
+    std::string err;
+    if (!mp::set_tracking_mode("full", &err)) {
+        std::printf("FAIL: MODE full: %s\n", err.c_str());
+        return 1;
+    }
+
+    peakCountsRecentBlocks();
+    callsiteTotalsCountRecentBlocks();
+    callsiteTagIsNotSticky();
+    scopedCallsiteIsRecorded();
+    callerPcIdsAreDense();
+    countersChurnReturnsToBaseline();
+
+    if (g_failures == 0) std::printf("all checks passed\n");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mp {
+namespace tools {
+
+    /**
+     * @brief Valor JSON minimo (DOM) para las herramientas que leen el protocolo.
+     *
+     * Solo lo necesario para los frames del profiler: objetos, arreglos,
+     * strings, numeros (double), booleanos y null. Los objetos conservan el
+     * orden de las claves.
+     */
+    struct JsonValue {
+        enum class Kind { Null, Bool, Number, String, Array, Object };
+
+        Kind        kind    = Kind::Null;
+        bool        boolean = false;
+        double      number  = 0.0;
+        std::string text;
+        std::vector<JsonValue>                          items;   // Array
+        std::vector<std::pair<std::string, JsonValue>>  members; // Object
+
+        bool isObject() const { return kind == Kind::Object; }
+        bool isArray()  const { return kind == Kind::Array; }
+
+        // Miembro de un objeto; nullptr si no existe o no es objeto
+        const JsonValue* get(const char* key) const;
+
+        // Acceso con valor por defecto
+        double             num(const char* key, double def = 0.0) const;
+        std::uint64_t      u64(const char* key, std::uint64_t def = 0) const;
+        std::string        str(const char* key, const std::string& def = "") const;
+    };
+
+    /**
+     * @brief Parsea un documento JSON completo.
+     * @return false (y err con la posicion) si el texto no es JSON valido
+     */
+    bool json_parse(const std::string& text, JsonValue& out, std::string* err = nullptr);
+
+} // namespace tools
+} // namespace mp
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mp {
+namespace tools {
+
+    /**
+     * @brief Mapeo ejecutable del proceso perfilado (campo "modules" de
+     *        LIVE_ALLOCS, copiado de /proc/self/maps).
+     */
+    struct ModuleMap {
+        std::uint64_t start  = 0;
+        std::uint64_t end    = 0;
+        std::uint64_t offset = 0;
+        std::string   path;
+        std::string   build_id;
+    };
+
+    /**
+     * @brief Resultado de simbolizar un PC.
+     */
+    struct SymbolInfo {
+        std::uint64_t pc = 0;
+        std::string   module;          // nombre del archivo ("" si el PC no cae en ningun mapeo)
+        std::string   function;        // demangleado ("" si no hay simbolo)
+        std::uint64_t fn_offset = 0;   // pc - inicio de la funcion
+        std::string   file;            // de .debug_line ("" si no hay DWARF)
+        int           line = 0;
+    };
+
+    class ElfModule;
+
+    /**
+     * @brief Traduce PCs crudos a funcion y archivo:linea fuera del proceso.
+     *
+     * Lee la tabla de simbolos ELF (.symtab, o .dynsym) y el programa de
+     * lineas DWARF (.debug_line, versiones 2 a 5, comprimido con zlib si
+     * MP_HAVE_ZLIB). Si el binario no trae DWARF se busca el archivo de
+     * depuracion por build id en cada debug dir (.build-id/xx/resto.debug).
+     * Cada modulo se carga una sola vez y queda en cache; distintos
+     * modulos se cargan en paralelo.
+     */
+    class Symbolizer {
+    public:
+        explicit Symbolizer(std::vector<std::string> debugDirs);
+        ~Symbolizer();
+
+        Symbolizer(const Symbolizer&) = delete;
+        Symbolizer& operator=(const Symbolizer&) = delete;
+
+        /**
+         * @brief Simboliza pcs con `jobs` hilos. Los PCs son direcciones de
+         *        retorno: se busca pc - 1 para caer en la instruccion call.
+         * @return un SymbolInfo por PC, en el mismo orden
+         */
+        std::vector<SymbolInfo> resolve(const std::vector<std::uint64_t>& pcs,
+                                        const std::vector<ModuleMap>& maps,
+                                        unsigned jobs);
+
+        /**
+         * @brief Avisos acumulados (modulo ilegible, build id distinto...)
+         */
+        std::vector<std::string> warnings() const;
+
+        std::size_t modulesLoaded() const;
+
+    private:
+        struct Entry;
+
+        SymbolInfo resolveOne(std::uint64_t pc, const std::vector<ModuleMap>& maps);
+        const ElfModule* module(const ModuleMap& m);
+        void warn(const std::string& w);
+
+        std::vector<std::string> debug_dirs_;
+        mutable std::mutex mu_;
+        std::map<std::string, std::shared_ptr<Entry>> cache_;   // por build id, o path si no hay
+        std::vector<std::string> warnings_;
+    };
+
+} // namespace tools
+} // namespace mp
@@ -0,0 +1,51 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace mp {
+namespace tools {
+
+    /**
+     * @brief Resumen de una serie de muestras (latencias, tiempos de parseo...).
+     */
+    struct SampleSummary {
+        std::size_t count = 0;
+        double mean = 0.0;
+        double p50  = 0.0;
+        double p90  = 0.0;
+        double p99  = 0.0;
+        double max  = 0.0;
+    };
+
+    // Percentil por rango mas cercano; v debe estar ordenado
+    inline double percentile_sorted(const std::vector<double>& v, double p) {
+        if (v.empty()) return 0.0;
+        std::size_t idx = static_cast<std::size_t>(p / 100.0 * static_cast<double>(v.size() - 1) + 0.5);
+        return v[std::min(idx, v.size() - 1)];
+    }
+
+    inline SampleSummary summarize(std::vector<double> v) {
+        SampleSummary s;
+        s.count = v.size();
+        if (v.empty()) return s;
+        std::sort(v.begin(), v.end());
+        double sum = 0.0;
+        for (double x : v) sum += x;
+        s.mean = sum / static_cast<double>(v.size());
+        s.p50  = percentile_sorted(v, 50);
+        s.p90  = percentile_sorted(v, 90);
+        s.p99  = percentile_sorted(v, 99);
+        s.max  = v.back();
+        return s;
+    }
+
+    // "n=.. mean=.. p50=.. p90=.. p99=.. max=.." con la unidad indicada
+    std::string format_summary(const SampleSummary& s, const char* unit);
+
+    // {"count":..,"mean":..,"p50":..,"p90":..,"p99":..,"max":..}
+    std::string summary_json(const SampleSummary& s);
+
+} // namespace tools
+} // namespace mp
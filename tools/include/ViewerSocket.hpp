@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "Compression.hpp"
+
+namespace mp {
+namespace tools {
+
+    /**
+     * @brief Frame recibido del profiler, ya descomprimido.
+     */
+    struct ReceivedFrame {
+        std::string   json;            // frame JSON sin el '\n' final
+        std::size_t   wire_bytes = 0;  // bytes leidos del socket (cabecera incluida)
+        bool          compressed = false;
+        std::uint64_t decode_ns  = 0;  // tiempo descomprimiendo (0 si no aplica)
+        std::uint64_t recv_ns    = 0;  // steady_clock al completar el frame
+    };
+
+    /**
+     * @brief Lado "GUI" del protocolo: escucha en el puerto al que se conecta
+     *        mp::SocketClient, acepta una conexion y lee frames.
+     *
+     * Se usa en las herramientas (mp_gui_stub, mp_top, benchmarks); no
+     * forma parte de la libreria del profiler.
+     */
+    class ViewerSocket {
+    public:
+        ViewerSocket() = default;
+        ~ViewerSocket();
+
+        ViewerSocket(const ViewerSocket&) = delete;
+        ViewerSocket& operator=(const ViewerSocket&) = delete;
+
+        /**
+         * @brief Abre el socket de escucha (SO_REUSEADDR) en host:port.
+         * @return false si bind/listen falla
+         */
+        bool listen(const std::string& host, std::uint16_t port);
+
+        /**
+         * @brief Espera una conexion entrante hasta timeout_ms (-1 = sin limite).
+         *        Cierra la conexion anterior si la habia.
+         */
+        bool accept(int timeout_ms);
+
+        bool connected() const noexcept { return conn_ >= 0; }
+
+        /**
+         * @brief Envia un comando (se agrega '\n').
+         */
+        bool sendLine(const std::string& line);
+
+        /**
+         * @brief Lee el siguiente frame completo.
+         * @return 1 si hay frame, 0 si vencio el timeout, -1 si la conexion se
+         *         cerro o el frame es invalido (la conexion queda cerrada)
+         */
+        int readFrame(ReceivedFrame& out, int timeout_ms);
+
+        void closeConnection();
+
+        // Totales de la conexion actual y anteriores
+        std::uint64_t totalWireBytes() const noexcept { return wire_total_; }
+
+    private:
+        // Intenta sacar un frame completo de rx_; true si lo consiguio
+        bool extractFrame(ReceivedFrame& out, bool& bad);
+
+        int listen_fd_ = -1;
+        int conn_      = -1;
+        std::string rx_;
+        std::size_t rx_pos_ = 0;     // inicio de los datos aun no consumidos
+        std::uint64_t wire_total_ = 0;
+    };
+
+    // Reloj monotono en ns (mismo origen que steady_clock)
+    std::uint64_t now_ns();
+
+} // namespace tools
+} // namespace mp
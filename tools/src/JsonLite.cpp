@@ -0,0 +1,187 @@
+#include "JsonLite.hpp"
+#include <cstdlib>
+#include <cstring>
+
+namespace mp {
+namespace tools {
+
+// --------------------------- acceso ---------------------------
+
+const JsonValue* JsonValue::get(const char* key) const {
+    if (kind != Kind::Object) return nullptr;
+    for (const auto& m : members) {
+        if (m.first == key) return &m.second;
+    }
+    return nullptr;
+}
+
+double JsonValue::num(const char* key, double def) const {
+    const JsonValue* v = get(key);
+    return (v && v->kind == Kind::Number) ? v->number : def;
+}
+
+std::uint64_t JsonValue::u64(const char* key, std::uint64_t def) const {
+    const JsonValue* v = get(key);
+    if (!v) return def;
+    if (v->kind == Kind::Number) return static_cast<std::uint64_t>(v->number);
+    if (v->kind == Kind::String) return std::strtoull(v->text.c_str(), nullptr, 10);
+    return def;
+}
+
+std::string JsonValue::str(const char* key, const std::string& def) const {
+    const JsonValue* v = get(key);
+    return (v && v->kind == Kind::String) ? v->text : def;
+}
+
+// --------------------------- parser ---------------------------
+
+namespace {
+
+class Parser {
+public:
+    explicit Parser(const std::string& s) : s_(s) {}
+
+    bool parseDocument(JsonValue& out) {
+        skipWs();
+        if (!parseValue(out, 0)) return false;
+        skipWs();
+        return pos_ == s_.size() || fail();
+    }
+
+    size_t pos() const { return pos_; }
+
+private:
+    static constexpr int kMaxDepth = 64;
+
+    bool fail() { return false; }
+
+    void skipWs() {
+        while (pos_ < s_.size() &&
+               (s_[pos_] == ' ' || s_[pos_] == '\t' || s_[pos_] == '\r' || s_[pos_] == '\n')) ++pos_;
+    }
+
+    bool consume(const char* lit) {
+        size_t n = std::strlen(lit);
+        if (s_.compare(pos_, n, lit) != 0) return false;
+        pos_ += n;
+        return true;
+    }
+
+    bool parseValue(JsonValue& v, int depth) {
+        if (depth > kMaxDepth || pos_ >= s_.size()) return fail();
+        switch (s_[pos_]) {
+            case '{': return parseObject(v, depth);
+            case '[': return parseArray(v, depth);
+            case '"': v.kind = JsonValue::Kind::String; return parseString(v.text);
+            case 't': v.kind = JsonValue::Kind::Bool; v.boolean = true;  return consume("true");
+            case 'f': v.kind = JsonValue::Kind::Bool; v.boolean = false; return consume("false");
+            case 'n': v.kind = JsonValue::Kind::Null; return consume("null");
+            default:  return parseNumber(v);
+        }
+    }
+
+    bool parseObject(JsonValue& v, int depth) {
+        v.kind = JsonValue::Kind::Object;
+        ++pos_; // '{'
+        skipWs();
+        if (pos_ < s_.size() && s_[pos_] == '}') { ++pos_; return true; }
+        for (;;) {
+            skipWs();
+            if (pos_ >= s_.size() || s_[pos_] != '"') return fail();
+            v.members.emplace_back();
+            if (!parseString(v.members.back().first)) return false;
+            skipWs();
+            if (pos_ >= s_.size() || s_[pos_] != ':') return fail();
+            ++pos_;
+            skipWs();
+            if (!parseValue(v.members.back().second, depth + 1)) return false;
+            skipWs();
+            if (pos_ >= s_.size()) return fail();
+            if (s_[pos_] == ',') { ++pos_; continue; }
+            if (s_[pos_] == '}') { ++pos_; return true; }
+            return fail();
+        }
+    }
+
+    bool parseArray(JsonValue& v, int depth) {
+        v.kind = JsonValue::Kind::Array;
+        ++pos_; // '['
+        skipWs();
+        if (pos_ < s_.size() && s_[pos_] == ']') { ++pos_; return true; }
+        for (;;) {
+            skipWs();
+            v.items.emplace_back();
+            if (!parseValue(v.items.back(), depth + 1)) return false;
+            skipWs();
+            if (pos_ >= s_.size()) return fail();
+            if (s_[pos_] == ',') { ++pos_; continue; }
+            if (s_[pos_] == ']') { ++pos_; return true; }
+            return fail();
+        }
+    }
+
+    bool parseString(std::string& out) {
+        ++pos_; // '"'
+        out.clear();
+        while (pos_ < s_.size()) {
+            char c = s_[pos_++];
+            if (c == '"') return true;
+            if (c != '\\') { out.push_back(c); continue; }
+            if (pos_ >= s_.size()) return fail();
+            char e = s_[pos_++];
+            switch (e) {
+                case '"': case '\\': case '/': out.push_back(e); break;
+                case 'n': out.push_back('\n'); break;
+                case 't': out.push_back('\t'); break;
+                case 'r': out.push_back('\r'); break;
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'u': {
+                    if (pos_ + 4 > s_.size()) return fail();
+                    unsigned cp = static_cast<unsigned>(std::strtoul(s_.substr(pos_, 4).c_str(), nullptr, 16));
+                    pos_ += 4;
+                    // Solo BMP; suficiente para nombres de archivo y tipos
+                    if (cp < 0x80) {
+                        out.push_back(static_cast<char>(cp));
+                    } else if (cp < 0x800) {
+                        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+                        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                    } else {
+                        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+                        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                    }
+                    break;
+                }
+                default: return fail();
+            }
+        }
+        return fail();
+    }
+
+    bool parseNumber(JsonValue& v) {
+        const char* begin = s_.c_str() + pos_;
+        char* end = nullptr;
+        v.kind = JsonValue::Kind::Number;
+        v.number = std::strtod(begin, &end);
+        if (end == begin) return fail();
+        pos_ += static_cast<size_t>(end - begin);
+        return true;
+    }
+
+    const std::string& s_;
+    size_t pos_ = 0;
+};
+
+} // namespace
+
+bool json_parse(const std::string& text, JsonValue& out, std::string* err) {
+    out = JsonValue{};
+    Parser p(text);
+    if (p.parseDocument(out)) return true;
+    if (err) *err = "invalid JSON near offset " + std::to_string(p.pos());
+    return false;
+}
+
+} // namespace tools
+} // namespace mp
@@ -0,0 +1,642 @@
+#include "Symbolizer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include <cxxabi.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if MP_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace mp {
+namespace tools {
+
+namespace {
+
+// Archivo mapeado en memoria, solo lectura
+struct MappedFile {
+    const unsigned char* data = nullptr;
+    std::size_t size = 0;
+
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() {
+        if (data) munmap(const_cast<unsigned char*>(data), size);
+    }
+
+    bool open(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        void* p = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        data = static_cast<const unsigned char*>(p);
+        size = static_cast<std::size_t>(st.st_size);
+        return true;
+    }
+};
+
+// Lector little-endian con limites; al pasarse queda en !ok
+struct Reader {
+    const unsigned char* p;
+    const unsigned char* end;
+    bool ok = true;
+
+    Reader(const unsigned char* b, const unsigned char* e) : p(b), end(e) {}
+
+    bool has(std::size_t n) {
+        if (static_cast<std::size_t>(end - p) < n) ok = false;
+        return ok;
+    }
+    std::uint64_t fixed(std::size_t n) {
+        if (!has(n)) return 0;
+        std::uint64_t v = 0;
+        for (std::size_t i = 0; i < n; ++i) v |= static_cast<std::uint64_t>(p[i]) << (8 * i);
+        p += n;
+        return v;
+    }
+    std::uint8_t  u8()  { return static_cast<std::uint8_t>(fixed(1)); }
+    std::uint16_t u16() { return static_cast<std::uint16_t>(fixed(2)); }
+    std::uint32_t u32() { return static_cast<std::uint32_t>(fixed(4)); }
+    std::uint64_t u64() { return fixed(8); }
+    std::uint64_t uleb() {
+        std::uint64_t v = 0;
+        for (unsigned shift = 0; has(1); shift += 7) {
+            const std::uint8_t b = *p++;
+            if (shift < 64) v |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) break;
+        }
+        return v;
+    }
+    std::int64_t sleb() {
+        std::int64_t v = 0;
+        unsigned shift = 0;
+        std::uint8_t b = 0;
+        do {
+            if (!has(1)) return 0;
+            b = *p++;
+            if (shift < 64) v |= static_cast<std::int64_t>(b & 0x7f) << shift;
+            shift += 7;
+        } while (b & 0x80);
+        if (shift < 64 && (b & 0x40)) v |= -(static_cast<std::int64_t>(1) << shift);
+        return v;
+    }
+    const char* cstr() {
+        const void* z = std::memchr(p, 0, static_cast<std::size_t>(end - p));
+        if (!z) { ok = false; return ""; }
+        const char* s = reinterpret_cast<const char*>(p);
+        p = static_cast<const unsigned char*>(z) + 1;
+        return s;
+    }
+    void skip(std::uint64_t n) {
+        if (has(n)) p += n;
+    }
+};
+
+// Bytes de una seccion: apuntan al archivo mapeado o a `owned` si venia comprimida
+struct Bytes {
+    const unsigned char* data = nullptr;
+    std::size_t size = 0;
+    std::string owned;
+};
+
+std::string basename_of(const std::string& path) {
+    const std::size_t slash = path.rfind('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+std::string to_hex(const unsigned char* p, std::size_t n) {
+    static const char kHex[] = "0123456789abcdef";
+    std::string out;
+    for (std::size_t i = 0; i < n; ++i) {
+        out += kHex[p[i] >> 4];
+        out += kHex[p[i] & 15];
+    }
+    return out;
+}
+
+/**
+ * Un ELF de 64 bits little-endian ya mapeado: secciones, segmentos y notas.
+ */
+class ElfImage {
+public:
+    bool open(const std::string& path, std::string& err) {
+        if (!file_.open(path)) { err = "cannot open " + path; return false; }
+        if (file_.size < sizeof(Elf64_Ehdr) || std::memcmp(file_.data, ELFMAG, SELFMAG) != 0) {
+            err = path + " is not an ELF file";
+            return false;
+        }
+        ehdr_ = reinterpret_cast<const Elf64_Ehdr*>(file_.data);
+        if (ehdr_->e_ident[EI_CLASS] != ELFCLASS64 || ehdr_->e_ident[EI_DATA] != ELFDATA2LSB) {
+            err = path + ": only 64-bit little-endian ELF is supported";
+            return false;
+        }
+        if (!inFile(ehdr_->e_shoff, std::uint64_t(ehdr_->e_shnum) * sizeof(Elf64_Shdr)) ||
+            !inFile(ehdr_->e_phoff, std::uint64_t(ehdr_->e_phnum) * sizeof(Elf64_Phdr))) {
+            err = path + ": truncated ELF headers";
+            return false;
+        }
+        shdrs_ = reinterpret_cast<const Elf64_Shdr*>(file_.data + ehdr_->e_shoff);
+        phdrs_ = reinterpret_cast<const Elf64_Phdr*>(file_.data + ehdr_->e_phoff);
+        return true;
+    }
+
+    // Seccion por nombre (descomprimida si hace falta); false si no esta
+    bool section(const char* name, Bytes& out) const {
+        const Elf64_Shdr* sh = findSection(name);
+        if (!sh || sh->sh_type == SHT_NOBITS || !inFile(sh->sh_offset, sh->sh_size)) return false;
+        const unsigned char* p = file_.data + sh->sh_offset;
+        if (!(sh->sh_flags & SHF_COMPRESSED)) {
+            out.data = p;
+            out.size = sh->sh_size;
+            return true;
+        }
+#if MP_HAVE_ZLIB
+        if (sh->sh_size < sizeof(Elf64_Chdr)) return false;
+        const auto* ch = reinterpret_cast<const Elf64_Chdr*>(p);
+        if (ch->ch_type != ELFCOMPRESS_ZLIB) return false;
+        out.owned.resize(ch->ch_size);
+        uLongf len = static_cast<uLongf>(ch->ch_size);
+        if (uncompress(reinterpret_cast<Bytef*>(&out.owned[0]), &len, p + sizeof(Elf64_Chdr),
+                       static_cast<uLong>(sh->sh_size - sizeof(Elf64_Chdr))) != Z_OK) {
+            return false;
+        }
+        out.owned.resize(len);
+        out.data = reinterpret_cast<const unsigned char*>(out.owned.data());
+        out.size = out.owned.size();
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    const Elf64_Shdr* findSection(const char* name) const {
+        if (ehdr_->e_shstrndx >= ehdr_->e_shnum) return nullptr;
+        const Elf64_Shdr& strtab = shdrs_[ehdr_->e_shstrndx];
+        if (!inFile(strtab.sh_offset, strtab.sh_size)) return nullptr;
+        const char* names = reinterpret_cast<const char*>(file_.data + strtab.sh_offset);
+        for (std::uint16_t i = 0; i < ehdr_->e_shnum; ++i) {
+            if (shdrs_[i].sh_name < strtab.sh_size && std::strcmp(names + shdrs_[i].sh_name, name) == 0) {
+                return &shdrs_[i];
+            }
+        }
+        return nullptr;
+    }
+
+    const Elf64_Shdr* sectionAt(std::uint32_t i) const { return i < ehdr_->e_shnum ? &shdrs_[i] : nullptr; }
+
+    std::string buildId() const {
+        for (std::uint16_t i = 0; i < ehdr_->e_phnum; ++i) {
+            const Elf64_Phdr& ph = phdrs_[i];
+            if (ph.p_type != PT_NOTE || !inFile(ph.p_offset, ph.p_filesz)) continue;
+            Reader r(file_.data + ph.p_offset, file_.data + ph.p_offset + ph.p_filesz);
+            while (r.ok && r.p < r.end) {
+                const std::uint32_t namesz = r.u32(), descsz = r.u32(), type = r.u32();
+                const unsigned char* name = r.p;
+                r.skip((namesz + 3) & ~3u);
+                const unsigned char* desc = r.p;
+                r.skip((descsz + 3) & ~3u);
+                if (r.ok && type == NT_GNU_BUILD_ID && namesz == 4 && std::memcmp(name, "GNU", 4) == 0) {
+                    return to_hex(desc, descsz);
+                }
+            }
+        }
+        return "";
+    }
+
+    // Offset en el archivo -> direccion virtual del ELF (segmentos PT_LOAD)
+    bool toVaddr(std::uint64_t off, std::uint64_t& vaddr) const {
+        for (std::uint16_t i = 0; i < ehdr_->e_phnum; ++i) {
+            const Elf64_Phdr& ph = phdrs_[i];
+            if (ph.p_type == PT_LOAD && ph.p_offset <= off && off < ph.p_offset + ph.p_filesz) {
+                vaddr = off - ph.p_offset + ph.p_vaddr;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool inFile(std::uint64_t off, std::uint64_t len) const {
+        return off <= file_.size && len <= file_.size - off;
+    }
+
+    const unsigned char* data() const { return file_.data; }
+
+private:
+    MappedFile file_;
+    const Elf64_Ehdr* ehdr_ = nullptr;
+    const Elf64_Shdr* shdrs_ = nullptr;
+    const Elf64_Phdr* phdrs_ = nullptr;
+};
+
+// DW_FORM_* usados en las cabeceras de .debug_line v5
+enum : std::uint64_t {
+    kFormBlock = 0x09, kFormData1 = 0x0b, kFormData2 = 0x05, kFormData4 = 0x06, kFormData8 = 0x07,
+    kFormData16 = 0x1e, kFormString = 0x08, kFormStrp = 0x0e, kFormLineStrp = 0x1f, kFormUdata = 0x0f,
+    kFormStrx = 0x1a, kFormStrx1 = 0x25, kFormStrx2 = 0x26, kFormStrx3 = 0x27, kFormStrx4 = 0x28,
+};
+
+} // namespace
+
+/**
+ * Simbolos y tabla de lineas de un modulo (el ELF y, si hace falta, su
+ * archivo de depuracion).
+ */
+class ElfModule {
+public:
+    struct Sym {
+        std::uint64_t addr, size;
+        const char*   name;   // dentro del archivo mapeado
+    };
+    struct LineRange {
+        std::uint64_t start, end;
+        std::uint32_t file;
+        int           line;
+    };
+
+    bool open(const std::string& path, std::string& err) {
+        if (!main_.open(path, err)) return false;
+        build_id_ = main_.buildId();
+        loadSymbols(main_);
+        loadLines(main_);
+        return true;
+    }
+
+    // Completa con un archivo de depuracion separado
+    bool addDebugFile(const std::string& path) {
+        std::string err;
+        debug_.reset(new ElfImage());
+        if (!debug_->open(path, err)) { debug_.reset(); return false; }
+        if (syms_.empty()) loadSymbols(*debug_);
+        if (ranges_.empty()) loadLines(*debug_);
+        return true;
+    }
+
+    bool hasLines() const { return !ranges_.empty(); }
+    const std::string& buildId() const { return build_id_; }
+    bool toVaddr(std::uint64_t off, std::uint64_t& v) const { return main_.toVaddr(off, v); }
+
+    const Sym* symbolAt(std::uint64_t a) const {
+        auto it = std::upper_bound(syms_.begin(), syms_.end(), a,
+                                   [](std::uint64_t x, const Sym& s) { return x < s.addr; });
+        if (it == syms_.begin()) return nullptr;
+        --it;
+        if (it->size && a >= it->addr + it->size) return nullptr;
+        return &*it;
+    }
+
+    bool lineAt(std::uint64_t a, std::string& file, int& line) const {
+        auto it = std::upper_bound(ranges_.begin(), ranges_.end(), a,
+                                   [](std::uint64_t x, const LineRange& r) { return x < r.start; });
+        if (it == ranges_.begin()) return false;
+        --it;
+        if (a >= it->end) return false;
+        file = files_[it->file];
+        line = it->line;
+        return true;
+    }
+
+private:
+    void loadSymbols(const ElfImage& img) {
+        const Elf64_Shdr* tab = img.findSection(".symtab");
+        if (!tab) tab = img.findSection(".dynsym");
+        if (!tab || tab->sh_entsize != sizeof(Elf64_Sym) || !img.inFile(tab->sh_offset, tab->sh_size)) return;
+        const Elf64_Shdr* str = img.sectionAt(tab->sh_link);
+        if (!str || !img.inFile(str->sh_offset, str->sh_size)) return;
+
+        const auto* s = reinterpret_cast<const Elf64_Sym*>(img.data() + tab->sh_offset);
+        const char* names = reinterpret_cast<const char*>(img.data() + str->sh_offset);
+        const std::size_t n = tab->sh_size / sizeof(Elf64_Sym);
+        for (std::size_t i = 0; i < n; ++i) {
+            const unsigned type = ELF64_ST_TYPE(s[i].st_info);
+            if ((type != STT_FUNC && type != STT_GNU_IFUNC) || s[i].st_shndx == SHN_UNDEF ||
+                s[i].st_value == 0 || s[i].st_name >= str->sh_size) {
+                continue;
+            }
+            syms_.push_back(Sym{s[i].st_value, s[i].st_size, names + s[i].st_name});
+        }
+        std::stable_sort(syms_.begin(), syms_.end(), [](const Sym& a, const Sym& b) { return a.addr < b.addr; });
+    }
+
+    std::uint32_t internFile(const std::string& dir, const char* name) {
+        std::string path = name;
+        if (!path.empty() && path[0] != '/' && !dir.empty()) path = dir + "/" + path;
+        auto it = file_ids_.find(path);
+        if (it != file_ids_.end()) return it->second;
+        const std::uint32_t id = static_cast<std::uint32_t>(files_.size());
+        files_.push_back(path);
+        file_ids_.emplace(path, id);
+        return id;
+    }
+
+    // Valor de un atributo de la cabecera v5: string si es un path, numero si no
+    bool readForm(Reader& r, std::uint64_t form, bool dwarf64, const Bytes& str, const Bytes& lineStr,
+                  const char*& text, std::uint64_t& num) {
+        text = nullptr;
+        num = 0;
+        auto fromTable = [&](const Bytes& t, std::uint64_t off) {
+            text = (off < t.size) ? reinterpret_cast<const char*>(t.data + off) : "?";
+        };
+        switch (form) {
+            case kFormString:   text = r.cstr(); return r.ok;
+            case kFormLineStrp: fromTable(lineStr, dwarf64 ? r.u64() : r.u32()); return r.ok;
+            case kFormStrp:     fromTable(str, dwarf64 ? r.u64() : r.u32()); return r.ok;
+            case kFormUdata:    num = r.uleb(); return r.ok;
+            case kFormData1:    num = r.u8(); return r.ok;
+            case kFormData2:    num = r.u16(); return r.ok;
+            case kFormData4:    num = r.u32(); return r.ok;
+            case kFormData8:    num = r.u64(); return r.ok;
+            case kFormData16:   r.skip(16); return r.ok;
+            case kFormBlock:    r.skip(r.uleb()); return r.ok;
+            // Indices a .debug_str_offsets: requieren la unidad de .debug_info
+            case kFormStrx:     r.uleb(); text = "?"; return r.ok;
+            case kFormStrx1:    r.skip(1); text = "?"; return r.ok;
+            case kFormStrx2:    r.skip(2); text = "?"; return r.ok;
+            case kFormStrx3:    r.skip(3); text = "?"; return r.ok;
+            case kFormStrx4:    r.skip(4); text = "?"; return r.ok;
+            default:            return false;
+        }
+    }
+
+    // Lista de entradas v5 (directorios o archivos)
+    bool readEntries(Reader& r, bool dwarf64, const Bytes& str, const Bytes& lineStr,
+                     const std::vector<std::string>& dirs, std::vector<std::string>* dirsOut,
+                     std::vector<std::uint32_t>* filesOut) {
+        const std::uint8_t formatCount = r.u8();
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> format;
+        for (std::uint8_t i = 0; i < formatCount; ++i) {
+            const std::uint64_t type = r.uleb();
+            format.emplace_back(type, r.uleb());
+        }
+        const std::uint64_t count = r.uleb();
+        for (std::uint64_t e = 0; e < count && r.ok; ++e) {
+            const char* path = "?";
+            std::uint64_t dir = 0;
+            for (const auto& f : format) {
+                const char* text;
+                std::uint64_t num;
+                if (!readForm(r, f.second, dwarf64, str, lineStr, text, num)) return false;
+                if (f.first == 1 /* DW_LNCT_path */ && text) path = text;
+                if (f.first == 2 /* DW_LNCT_directory_index */) dir = num;
+            }
+            if (dirsOut) dirsOut->push_back(path);
+            if (filesOut) filesOut->push_back(internFile(dir < dirs.size() ? dirs[dir] : "", path));
+        }
+        return r.ok;
+    }
+
+    void loadLines(const ElfImage& img) {
+        Bytes line, str, lineStr;
+        if (!img.section(".debug_line", line)) return;
+        img.section(".debug_str", str);
+        img.section(".debug_line_str", lineStr);
+
+        Reader unit(line.data, line.data + line.size);
+        while (unit.ok && unit.p < unit.end) {
+            std::uint64_t length = unit.u32();
+            const bool dwarf64 = length == 0xffffffffu;
+            if (dwarf64) length = unit.u64();
+            if (!unit.has(length)) break;
+            const unsigned char* unitEnd = unit.p + length;
+            Reader r(unit.p, unitEnd);
+            unit.p = unitEnd;
+            parseUnit(r, dwarf64, str, lineStr);
+        }
+        std::sort(ranges_.begin(), ranges_.end(),
+                  [](const LineRange& a, const LineRange& b) { return a.start < b.start; });
+    }
+
+    void parseUnit(Reader& r, bool dwarf64, const Bytes& str, const Bytes& lineStr) {
+        const std::uint16_t version = r.u16();
+        if (version < 2 || version > 5) return;
+        std::uint8_t addrSize = 8;
+        if (version >= 5) {
+            addrSize = r.u8();
+            r.u8(); // segment_selector_size
+        }
+        const std::uint64_t headerLength = dwarf64 ? r.u64() : r.u32();
+        if (!r.has(headerLength)) return;
+        const unsigned char* program = r.p + headerLength;
+        const std::uint8_t minInst = r.u8();
+        if (version >= 4) r.u8(); // maximum_operations_per_instruction (sin VLIW)
+        const bool defaultIsStmt = r.u8() != 0;
+        (void)defaultIsStmt;
+        const std::int8_t lineBase = static_cast<std::int8_t>(r.u8());
+        const std::uint8_t lineRange = r.u8();
+        const std::uint8_t opcodeBase = r.u8();
+        if (!r.ok || lineRange == 0 || opcodeBase == 0) return;
+        std::vector<std::uint8_t> opLengths(opcodeBase, 0);
+        for (std::uint8_t i = 1; i < opcodeBase; ++i) opLengths[i] = r.u8();
+
+        std::vector<std::string> dirs;
+        std::vector<std::uint32_t> files;
+        if (version >= 5) {
+            if (!readEntries(r, dwarf64, str, lineStr, dirs, &dirs, nullptr)) return;
+            if (!readEntries(r, dwarf64, str, lineStr, dirs, nullptr, &files)) return;
+        } else {
+            dirs.push_back(""); // 0 = directorio de compilacion, que no esta aqui
+            for (const char* d = r.cstr(); r.ok && *d; d = r.cstr()) dirs.push_back(d);
+            files.push_back(internFile("", "?")); // los archivos empiezan en 1
+            for (const char* f = r.cstr(); r.ok && *f; f = r.cstr()) {
+                const std::uint64_t dir = r.uleb();
+                r.uleb(); // mtime
+                r.uleb(); // largo
+                files.push_back(internFile(dir < dirs.size() ? dirs[dir] : "", f));
+            }
+        }
+        if (!r.ok) return;
+        r.p = program;
+
+        // Maquina de estados del programa de lineas
+        std::uint64_t address = 0;
+        std::uint64_t file = 1;
+        std::int64_t  lineNo = 1;
+        bool havePrev = false, skipSeq = false;
+        std::uint64_t prevAddr = 0;
+        std::uint32_t prevFile = 0;
+        int prevLine = 0;
+
+        auto fileId = [&](std::uint64_t f) {
+            return f < files.size() ? files[f] : internFile("", "?");
+        };
+        auto emit = [&](bool endSeq) {
+            if (!havePrev && (address == 0 || address == ~std::uint64_t(0))) skipSeq = true; // descartada por el linker
+            if (havePrev && !skipSeq && address > prevAddr) {
+                ranges_.push_back(LineRange{prevAddr, address, prevFile, prevLine});
+            }
+            if (endSeq) {
+                havePrev = false;
+                skipSeq = false;
+                address = 0;
+                file = 1;
+                lineNo = 1;
+                return;
+            }
+            havePrev = true;
+            prevAddr = address;
+            prevFile = fileId(file);
+            prevLine = static_cast<int>(lineNo);
+        };
+
+        while (r.ok && r.p < r.end) {
+            const std::uint8_t op = r.u8();
+            if (op >= opcodeBase) {
+                const std::uint8_t adj = static_cast<std::uint8_t>(op - opcodeBase);
+                address += static_cast<std::uint64_t>(adj / lineRange) * minInst;
+                lineNo += lineBase + (adj % lineRange);
+                emit(false);
+                continue;
+            }
+            switch (op) {
+                case 0: { // extendido
+                    const std::uint64_t len = r.uleb();
+                    if (!r.has(len) || len == 0) return;
+                    const unsigned char* next = r.p + len;
+                    const std::uint8_t sub = r.u8();
+                    if (sub == 1) emit(true);                                // DW_LNE_end_sequence
+                    else if (sub == 2) address = r.fixed(len - 1 <= 8 ? len - 1 : addrSize); // DW_LNE_set_address
+                    r.p = next;
+                    break;
+                }
+                case 1: emit(false); break;                                  // DW_LNS_copy
+                case 2: address += r.uleb() * minInst; break;                // DW_LNS_advance_pc
+                case 3: lineNo += r.sleb(); break;                           // DW_LNS_advance_line
+                case 4: file = r.uleb(); break;                              // DW_LNS_set_file
+                case 8: address += static_cast<std::uint64_t>((255 - opcodeBase) / lineRange) * minInst; break;
+                case 9: address += r.u16(); break;                           // DW_LNS_fixed_advance_pc
+                default:
+                    // set_column, negate_stmt, prologue_end...: solo se saltean sus operandos
+                    for (std::uint8_t i = 0; i < opLengths[op]; ++i) r.uleb();
+                    break;
+            }
+        }
+    }
+
+    ElfImage main_;
+    std::unique_ptr<ElfImage> debug_;
+    std::string build_id_;
+    std::vector<Sym> syms_;
+    std::vector<LineRange> ranges_;
+    std::vector<std::string> files_;
+    std::map<std::string, std::uint32_t> file_ids_;
+};
+
+// Un modulo en cache; lo carga el primer hilo que lo pide
+struct Symbolizer::Entry {
+    std::once_flag once;
+    std::unique_ptr<ElfModule> mod;
+};
+
+Symbolizer::Symbolizer(std::vector<std::string> debugDirs) : debug_dirs_(std::move(debugDirs)) {}
+
+Symbolizer::~Symbolizer() = default;
+
+void Symbolizer::warn(const std::string& w) {
+    std::lock_guard<std::mutex> lock(mu_);
+    warnings_.push_back(w);
+}
+
+std::vector<std::string> Symbolizer::warnings() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return warnings_;
+}
+
+std::size_t Symbolizer::modulesLoaded() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    std::size_t n = 0;
+    for (const auto& kv : cache_) n += kv.second->mod ? 1 : 0;
+    return n;
+}
+
+const ElfModule* Symbolizer::module(const ModuleMap& m) {
+    std::shared_ptr<Entry> e;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto& slot = cache_[m.build_id.empty() ? m.path : m.build_id];
+        if (!slot) slot = std::make_shared<Entry>();
+        e = slot;
+    }
+    std::call_once(e->once, [&] {
+        std::unique_ptr<ElfModule> mod(new ElfModule());
+        std::string err;
+        if (!mod->open(m.path, err)) {
+            warn(err);
+            return;
+        }
+        if (!m.build_id.empty() && !mod->buildId().empty() && mod->buildId() != m.build_id) {
+            warn(m.path + ": build id " + mod->buildId() + " differs from the profiled process (" +
+                 m.build_id + "); results may be wrong");
+        }
+        if (!mod->hasLines()) {
+            const std::string& id = m.build_id.empty() ? mod->buildId() : m.build_id;
+            for (const std::string& dir : debug_dirs_) {
+                if (id.size() > 2 && mod->addDebugFile(dir + "/.build-id/" + id.substr(0, 2) + "/" + id.substr(2) + ".debug")) break;
+                if (mod->addDebugFile(dir + m.path + ".debug")) break;
+            }
+        }
+        e->mod = std::move(mod);
+    });
+    return e->mod.get();
+}
+
+SymbolInfo Symbolizer::resolveOne(std::uint64_t pc, const std::vector<ModuleMap>& maps) {
+    SymbolInfo s;
+    s.pc = pc;
+    auto it = std::upper_bound(maps.begin(), maps.end(), pc,
+                               [](std::uint64_t x, const ModuleMap& m) { return x < m.start; });
+    if (it == maps.begin() || pc >= (it - 1)->end) return s;
+    const ModuleMap& m = *(it - 1);
+    s.module = basename_of(m.path);
+
+    const ElfModule* mod = module(m);
+    std::uint64_t vaddr = 0;
+    // Direccion de retorno: pc - 1 cae dentro de la instruccion call
+    if (!mod || !mod->toVaddr(pc - 1 - m.start + m.offset, vaddr)) return s;
+
+    if (const ElfModule::Sym* sym = mod->symbolAt(vaddr)) {
+        int status = 0;
+        char* dem = abi::__cxa_demangle(sym->name, nullptr, nullptr, &status);
+        s.function = (status == 0 && dem) ? dem : sym->name;
+        std::free(dem);
+        s.fn_offset = vaddr + 1 - sym->addr;
+    }
+    mod->lineAt(vaddr, s.file, s.line);
+    return s;
+}
+
+std::vector<SymbolInfo> Symbolizer::resolve(const std::vector<std::uint64_t>& pcs,
+                                            const std::vector<ModuleMap>& maps, unsigned jobs) {
+    std::vector<ModuleMap> sorted(maps);
+    std::sort(sorted.begin(), sorted.end(), [](const ModuleMap& a, const ModuleMap& b) { return a.start < b.start; });
+
+    std::vector<SymbolInfo> out(pcs.size());
+    std::atomic<std::size_t> next{0};
+    auto work = [&] {
+        for (std::size_t i; (i = next.fetch_add(1)) < pcs.size();) out[i] = resolveOne(pcs[i], sorted);
+    };
+    if (jobs == 0) jobs = 1;
+    jobs = static_cast<unsigned>(std::min<std::size_t>(jobs, pcs.size() ? pcs.size() : 1));
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < jobs; ++t) threads.emplace_back(work);
+    work();
+    for (auto& t : threads) t.join();
+    return out;
+}
+
+} // namespace tools
+} // namespace mp
@@ -0,0 +1,24 @@
+#include "ToolStats.hpp"
+#include <cstdio>
+
+namespace mp {
+namespace tools {
+
+std::string format_summary(const SampleSummary& s, const char* unit) {
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+                  "n=%zu mean=%.3f%s p50=%.3f%s p90=%.3f%s p99=%.3f%s max=%.3f%s",
+                  s.count, s.mean, unit, s.p50, unit, s.p90, unit, s.p99, unit, s.max, unit);
+    return buf;
+}
+
+std::string summary_json(const SampleSummary& s) {
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+                  "{\"count\":%zu,\"mean\":%.4f,\"p50\":%.4f,\"p90\":%.4f,\"p99\":%.4f,\"max\":%.4f}",
+                  s.count, s.mean, s.p50, s.p90, s.p99, s.max);
+    return buf;
+}
+
+} // namespace tools
+} // namespace mp
@@ -0,0 +1,159 @@
+#include "ViewerSocket.hpp"
+#include "JsonLite.hpp"
+
+#include <chrono>
+#include <cstring>
+
+// POSIX
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <errno.h>
+
+namespace mp {
+namespace tools {
+
+std::uint64_t now_ns() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+ViewerSocket::~ViewerSocket() {
+    closeConnection();
+    if (listen_fd_ >= 0) ::close(listen_fd_);
+}
+
+bool ViewerSocket::listen(const std::string& host, std::uint16_t port) {
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) return false;
+
+    int one = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(port);
+    if (::inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) return false;
+
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) return false;
+    return ::listen(listen_fd_, 1) == 0;
+}
+
+bool ViewerSocket::accept(int timeout_ms) {
+    closeConnection();
+    pollfd pfd{ listen_fd_, POLLIN, 0 };
+    if (::poll(&pfd, 1, timeout_ms) != 1) return false;
+    conn_ = ::accept(listen_fd_, nullptr, nullptr);
+    rx_.clear();
+    rx_pos_ = 0;
+    return conn_ >= 0;
+}
+
+void ViewerSocket::closeConnection() {
+    if (conn_ >= 0) {
+        ::close(conn_);
+        conn_ = -1;
+    }
+}
+
+bool ViewerSocket::sendLine(const std::string& line) {
+    if (conn_ < 0) return false;
+    std::string data = line + "\n";
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(conn_, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            closeConnection();
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool ViewerSocket::extractFrame(ReceivedFrame& out, bool& bad) {
+    bad = false;
+    const size_t nl = rx_.find('\n', rx_pos_);
+    if (nl == std::string::npos) return false;
+
+    // Cabecera de frame comprimido: la linea va seguida de "size" bytes binarios
+    if (rx_.compare(rx_pos_, 21, "{\"type\":\"COMPRESSED\",") == 0) {
+        JsonValue hdr;
+        if (!json_parse(rx_.substr(rx_pos_, nl - rx_pos_), hdr)) { bad = true; return false; }
+        const JsonValue* p = hdr.get("payload");
+        Codec codec = Codec::None;
+        if (!p || !codec_from_name(p->str("codec"), codec)) { bad = true; return false; }
+        const size_t size = static_cast<size_t>(p->u64("size"));
+        const size_t raw  = static_cast<size_t>(p->u64("raw"));
+        const size_t body = nl + 1;
+        if (rx_.size() - body < size) return false; // falta el bloque
+
+        std::string plain;
+        const std::uint64_t t0 = now_ns();
+        if (!decompress_frame(codec, rx_.data() + body, size, raw, plain)) { bad = true; return false; }
+        out.decode_ns  = now_ns() - t0;
+        out.compressed = true;
+        out.wire_bytes = (body - rx_pos_) + size;
+        if (!plain.empty() && plain.back() == '\n') plain.pop_back();
+        out.json = std::move(plain);
+        rx_pos_ = body + size;
+    } else {
+        out.json.assign(rx_, rx_pos_, nl - rx_pos_);
+        out.wire_bytes = nl + 1 - rx_pos_;
+        out.compressed = false;
+        out.decode_ns  = 0;
+        rx_pos_ = nl + 1;
+    }
+
+    // Compactar de vez en cuando para no mover memoria en cada frame
+    if (rx_pos_ > (1u << 20) || rx_pos_ == rx_.size()) {
+        rx_.erase(0, rx_pos_);
+        rx_pos_ = 0;
+    }
+    out.recv_ns = now_ns();
+    return true;
+}
+
+int ViewerSocket::readFrame(ReceivedFrame& out, int timeout_ms) {
+    const std::uint64_t deadline = now_ns() + static_cast<std::uint64_t>(timeout_ms < 0 ? 0 : timeout_ms) * 1000000ull;
+    char buf[64 * 1024];
+
+    for (;;) {
+        bool bad = false;
+        if (extractFrame(out, bad)) return 1;
+        if (bad) { closeConnection(); return -1; }
+        if (conn_ < 0) return -1;
+
+        int wait = 0;
+        if (timeout_ms < 0) {
+            wait = -1;
+        } else {
+            const std::uint64_t now = now_ns();
+            if (now >= deadline) return 0;
+            wait = static_cast<int>((deadline - now) / 1000000ull);
+        }
+
+        pollfd pfd{ conn_, POLLIN, 0 };
+        int prc = ::poll(&pfd, 1, wait);
+        if (prc == 0) return 0;
+        if (prc < 0) {
+            if (errno == EINTR) continue;
+            closeConnection();
+            return -1;
+        }
+
+        ssize_t n = ::recv(conn_, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            closeConnection();
+            return -1;
+        }
+        rx_.append(buf, static_cast<size_t>(n));
+        wire_total_ += static_cast<std::uint64_t>(n);
+    }
+}
+
+} // namespace tools
+} // namespace mp
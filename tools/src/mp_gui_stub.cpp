@@ -0,0 +1,415 @@
+// mp_gui_stub: sustituto local de la GUI para pruebas de carga del protocolo.
+//
+// Escucha en el puerto al que se conecta mp::SocketClient, envia comandos
+// programados (SNAPSHOT, COMPRESS, RESUME...) a la frecuencia indicada,
+// parsea cada frame y al final reporta frames/s, bytes/s, tiempo de parseo,
+// latencia pedido->respuesta y huecos en la cadencia de metricas.
+
+#include "JsonLite.hpp"
+#include "ToolStats.hpp"
+#include "ViewerSocket.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace mp::tools;
+
+namespace {
+
+/**
+ * Comando programado: se envia al conectar y luego cada period_ms (0 = una vez)
+ */
+struct ScriptedCommand {
+    std::string   text;
+    std::uint64_t period_ms = 0;
+    std::uint64_t next_ns   = 0;
+};
+
+struct Options {
+    std::string   host = "127.0.0.1";
+    std::uint16_t port = 7777;
+    std::uint32_t seconds = 10;
+    std::uint32_t metrics_ms = 200;       // cadencia esperada del SUMMARY
+    std::uint32_t accept_timeout_ms = 30000;
+    std::uint32_t response_timeout_ms = 5000; // pedido sin respuesta -> vencido
+    std::vector<ScriptedCommand> commands;
+    std::string   dump_dir;               // "" = no guardar LIVE_ALLOCS
+    bool json = false;
+    bool quiet = false;
+};
+
+void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]\n";
+    std::cout << "\nOptions:\n";
+    std::cout << "  --host <IP>               Address to listen on (default: 127.0.0.1)\n";
+    std::cout << "  --port <P>                Port SocketClient dials (default: 7777)\n";
+    std::cout << "  --seconds <S>             Test duration after the first connection (default: 10)\n";
+    std::cout << "  --cmd <TEXT[:MS]>         Send TEXT every MS milliseconds (0 or omitted: once per\n";
+    std::cout << "                            connection). Repeatable. Default: SNAPSHOT:1000\n";
+    std::cout << "  --compress <CODEC[:MIN]>  Shorthand for --cmd \"COMPRESS CODEC MIN\"\n";
+    std::cout << "  --metrics-ms <M>          Expected SUMMARY cadence for gap detection (default: 200)\n";
+    std::cout << "  --accept-timeout-ms <M>   How long to wait for the profiler (default: 30000)\n";
+    std::cout << "  --response-timeout-ms <M> Drop a command still unanswered after M ms and count\n";
+    std::cout << "                            it as expired (default: 5000)\n";
+    std::cout << "  --dump-dir <DIR>          Save every LIVE_ALLOCS frame as DIR/live_allocs_<n>.json\n";
+    std::cout << "                            (input for mp_symbolize)\n";
+    std::cout << "  --json                    Print the report as one JSON object\n";
+    std::cout << "  --quiet                   Do not log individual events\n";
+    std::cout << "  --help                    Show this help message\n";
+}
+
+// "TEXT:MS" -> comando; el ultimo ':' separa el periodo si es numerico
+ScriptedCommand parseCommand(const std::string& spec) {
+    ScriptedCommand c;
+    c.text = spec;
+    size_t colon = spec.rfind(':');
+    if (colon != std::string::npos && colon + 1 < spec.size() &&
+        spec.find_first_not_of("0123456789", colon + 1) == std::string::npos) {
+        c.text = spec.substr(0, colon);
+        c.period_ms = std::strtoull(spec.c_str() + colon + 1, nullptr, 10);
+    }
+    return c;
+}
+
+bool parseArgs(int argc, char* argv[], Options& o) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&](std::string& v) {
+            if (i + 1 >= argc) return false;
+            v = argv[++i];
+            return true;
+        };
+        std::string v;
+        if (a == "--help")                    { return false; }
+        else if (a == "--json")               { o.json = true; }
+        else if (a == "--quiet")              { o.quiet = true; }
+        else if (a == "--host" && next(v))    { o.host = v; }
+        else if (a == "--port" && next(v))    { o.port = static_cast<std::uint16_t>(std::atoi(v.c_str())); }
+        else if (a == "--seconds" && next(v)) { o.seconds = static_cast<std::uint32_t>(std::atoi(v.c_str())); }
+        else if (a == "--cmd" && next(v))     { o.commands.push_back(parseCommand(v)); }
+        else if (a == "--dump-dir" && next(v)) { o.dump_dir = v; }
+        else if (a == "--metrics-ms" && next(v)) { o.metrics_ms = static_cast<std::uint32_t>(std::atoi(v.c_str())); }
+        else if (a == "--accept-timeout-ms" && next(v)) { o.accept_timeout_ms = static_cast<std::uint32_t>(std::atoi(v.c_str())); }
+        else if (a == "--response-timeout-ms" && next(v)) { o.response_timeout_ms = static_cast<std::uint32_t>(std::atoi(v.c_str())); }
+        else if (a == "--compress" && next(v)) {
+            size_t colon = v.find(':');
+            std::string cmd = "COMPRESS " + v.substr(0, colon);
+            if (colon != std::string::npos) cmd += " " + v.substr(colon + 1);
+            o.commands.insert(o.commands.begin(), ScriptedCommand{cmd, 0, 0});
+        } else {
+            std::cerr << "Error: unknown or incomplete option " << a << "\n";
+            return false;
+        }
+    }
+    if (o.seconds == 0 || o.metrics_ms == 0 || o.response_timeout_ms == 0) {
+        std::cerr << "Error: seconds, metrics-ms and response-timeout-ms must be > 0\n";
+        return false;
+    }
+    if (!o.dump_dir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(o.dump_dir, ec); // como mkdir -p
+        if (ec) {
+            std::cerr << "Error: cannot create dump dir " << o.dump_dir << ": " << ec.message() << "\n";
+            return false;
+        }
+    }
+    if (o.commands.empty()) o.commands.push_back(parseCommand("SNAPSHOT:1000"));
+    return true;
+}
+
+// Tipos de frame que responden a un comando
+bool answers(const std::string& command, const std::string& frameType) {
+    if (frameType == "ERROR") return true;
+    std::string kw = command.substr(0, command.find(' '));
+    if (kw == "SNAPSHOT") return frameType == "LIVE_ALLOCS";
+    if (kw == "RESUME")   return frameType == "RESUMED" || frameType == "RESYNC";
+    return frameType == kw;
+}
+
+struct TypeStats {
+    std::uint64_t frames = 0;
+    std::uint64_t wire_bytes = 0;
+    std::uint64_t raw_bytes = 0;
+    std::uint64_t compressed = 0;
+};
+
+/**
+ * Acumula todo lo que se mide durante la prueba
+ */
+struct Report {
+    std::map<std::string, TypeStats>           by_type;
+    std::vector<double>                        parse_us;
+    std::vector<double>                        decode_us;
+    std::map<std::string, std::vector<double>> latency_ms;   // por palabra clave
+    std::vector<double>                        cadence_ms;   // entre SUMMARY consecutivos
+    std::uint64_t frames = 0, wire_bytes = 0, raw_bytes = 0, parse_ns = 0;
+    std::uint64_t invalid = 0, connections = 0, cadence_gaps = 0;
+    std::uint64_t seq_gaps = 0, seq_missing = 0, seq_dups = 0;
+    std::uint64_t commands_sent = 0, unanswered = 0, expired = 0;
+    double elapsed_s = 0.0;
+};
+
+void printReport(const Options& o, const Report& r) {
+    const double secs = r.elapsed_s > 0 ? r.elapsed_s : 1.0;
+    const SampleSummary parse = summarize(r.parse_us);
+    const SampleSummary decode = summarize(r.decode_us);
+    const SampleSummary cadence = summarize(r.cadence_ms);
+
+    if (o.json) {
+        std::string j = "{\"elapsed_s\":" + std::to_string(r.elapsed_s) +
+                        ",\"connections\":" + std::to_string(r.connections) +
+                        ",\"frames\":" + std::to_string(r.frames) +
+                        ",\"frames_per_s\":" + std::to_string(r.frames / secs) +
+                        ",\"wire_bytes_per_s\":" + std::to_string(r.wire_bytes / secs) +
+                        ",\"raw_bytes_per_s\":" + std::to_string(r.raw_bytes / secs) +
+                        ",\"invalid_frames\":" + std::to_string(r.invalid) +
+                        ",\"parse_us\":" + summary_json(parse) +
+                        ",\"parse_mb_per_s\":" + std::to_string(r.parse_ns ? r.raw_bytes * 1e3 / r.parse_ns : 0.0) +
+                        ",\"decode_us\":" + summary_json(decode) +
+                        ",\"cadence_ms\":" + summary_json(cadence) +
+                        ",\"cadence_gaps\":" + std::to_string(r.cadence_gaps) +
+                        ",\"seq\":{\"gaps\":" + std::to_string(r.seq_gaps) +
+                        ",\"missing\":" + std::to_string(r.seq_missing) +
+                        ",\"duplicates\":" + std::to_string(r.seq_dups) + "}" +
+                        ",\"commands_sent\":" + std::to_string(r.commands_sent) +
+                        ",\"unanswered\":" + std::to_string(r.unanswered) +
+                        ",\"expired\":" + std::to_string(r.expired) +
+                        ",\"latency_ms\":{";
+        bool first = true;
+        for (const auto& kv : r.latency_ms) {
+            if (!first) j += ",";
+            first = false;
+            j += "\"" + kv.first + "\":" + summary_json(summarize(kv.second));
+        }
+        j += "},\"types\":{";
+        first = true;
+        for (const auto& kv : r.by_type) {
+            if (!first) j += ",";
+            first = false;
+            j += "\"" + kv.first + "\":{\"frames\":" + std::to_string(kv.second.frames) +
+                 ",\"wire_bytes\":" + std::to_string(kv.second.wire_bytes) +
+                 ",\"raw_bytes\":" + std::to_string(kv.second.raw_bytes) +
+                 ",\"compressed\":" + std::to_string(kv.second.compressed) + "}";
+        }
+        j += "}}";
+        std::cout << j << std::endl;
+        return;
+    }
+
+    char line[256];
+    std::cout << "\n=== GUI STUB REPORT ===\n";
+    std::snprintf(line, sizeof(line), "Duration: %.2fs, connections: %llu\n", r.elapsed_s,
+                  static_cast<unsigned long long>(r.connections));
+    std::cout << line;
+    std::snprintf(line, sizeof(line), "Frames: %llu (%.1f frames/s), invalid: %llu\n",
+                  static_cast<unsigned long long>(r.frames), r.frames / secs,
+                  static_cast<unsigned long long>(r.invalid));
+    std::cout << line;
+    std::snprintf(line, sizeof(line), "Throughput: %.1f KB/s on the wire, %.1f KB/s decoded\n",
+                  r.wire_bytes / secs / 1024.0, r.raw_bytes / secs / 1024.0);
+    std::cout << line;
+    std::cout << "Parse time per frame: " << format_summary(parse, "us") << "\n";
+    std::snprintf(line, sizeof(line), "Parse rate: %.1f MB/s\n",
+                  r.parse_ns ? r.raw_bytes * 1e3 / r.parse_ns : 0.0);
+    std::cout << line;
+    if (decode.count) std::cout << "Decompression per frame: " << format_summary(decode, "us") << "\n";
+    std::cout << "SUMMARY cadence: " << format_summary(cadence, "ms") << "\n";
+    std::cout << "  Gaps > 1.5x " << o.metrics_ms << "ms: " << r.cadence_gaps << "\n";
+    std::cout << "Sequence: " << r.seq_gaps << " gaps, " << r.seq_missing << " missing, "
+              << r.seq_dups << " duplicates\n";
+    std::cout << "Commands sent: " << r.commands_sent << ", unanswered: " << r.unanswered
+              << ", expired after " << o.response_timeout_ms << "ms: " << r.expired << "\n";
+    for (const auto& kv : r.latency_ms) {
+        std::cout << "  " << kv.first << " latency: " << format_summary(summarize(kv.second), "ms") << "\n";
+    }
+    std::cout << "\nFrames by type:\n";
+    for (const auto& kv : r.by_type) {
+        std::snprintf(line, sizeof(line), "  %-14s %8llu frames, %10.1f KB wire, %10.1f KB raw, %llu compressed\n",
+                      kv.first.c_str(), static_cast<unsigned long long>(kv.second.frames),
+                      kv.second.wire_bytes / 1024.0, kv.second.raw_bytes / 1024.0,
+                      static_cast<unsigned long long>(kv.second.compressed));
+        std::cout << line;
+    }
+    std::cout << "=======================\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    ViewerSocket sock;
+    if (!sock.listen(opt.host, opt.port)) {
+        std::cerr << "Error: cannot listen on " << opt.host << ":" << opt.port << "\n";
+        return 1;
+    }
+    if (!opt.quiet) std::cerr << "Listening on " << opt.host << ":" << opt.port << "...\n";
+
+    if (!sock.accept(static_cast<int>(opt.accept_timeout_ms))) {
+        std::cerr << "Error: no profiler connected within " << opt.accept_timeout_ms << "ms\n";
+        return 2;
+    }
+
+    Report rep;
+    rep.connections = 1;
+    const std::uint64_t start_ns = now_ns();
+    const std::uint64_t end_ns = start_ns + static_cast<std::uint64_t>(opt.seconds) * 1000000000ull;
+
+    // Pedidos en vuelo, del mas viejo al mas nuevo
+    struct Pending { std::string command; std::uint64_t sent_ns; };
+    std::deque<Pending> pending;
+    const std::uint64_t response_timeout_ns = static_cast<std::uint64_t>(opt.response_timeout_ms) * 1000000ull;
+    // Descarta los pedidos que a la hora t ya no van a tener respuesta
+    auto expirePending = [&](std::uint64_t t) {
+        while (!pending.empty() && t - pending.front().sent_ns >= response_timeout_ns) {
+            ++rep.expired;
+            pending.pop_front();
+        }
+    };
+    std::uint64_t last_summary_ns = 0;
+    std::string   session;
+    std::uint64_t last_seq = 0;
+    std::uint64_t dumps = 0;
+
+    auto armCommands = [&](std::uint64_t now) {
+        for (auto& c : opt.commands) c.next_ns = now;
+        rep.unanswered += pending.size(); // la conexion anterior ya no respondera
+        pending.clear();
+        last_summary_ns = 0;
+    };
+    armCommands(now_ns());
+
+    ReceivedFrame frame;
+    for (;;) {
+        std::uint64_t now = now_ns();
+        if (now >= end_ns) break;
+
+        if (!sock.connected()) {
+            if (!opt.quiet) std::cerr << "Connection lost, waiting for reconnect...\n";
+            int wait = static_cast<int>((end_ns - now) / 1000000ull);
+            if (!sock.accept(wait)) break;
+            ++rep.connections;
+            armCommands(now_ns());
+            continue;
+        }
+
+        expirePending(now);
+
+        // Comandos programados vencidos
+        std::uint64_t next_due = end_ns;
+        for (auto& c : opt.commands) {
+            if (c.next_ns == 0) continue; // de una sola vez, ya enviado
+            if (c.next_ns <= now) {
+                if (!sock.sendLine(c.text)) break;
+                ++rep.commands_sent;
+                pending.push_back(Pending{c.text, now});
+                c.next_ns = c.period_ms ? now + c.period_ms * 1000000ull : 0;
+            }
+            if (c.next_ns) next_due = std::min(next_due, c.next_ns);
+        }
+
+        int wait_ms = static_cast<int>((next_due > now ? next_due - now : 0) / 1000000ull);
+        int rc = sock.readFrame(frame, std::min(wait_ms, 50));
+        if (rc <= 0) continue;
+
+        // Parseo completo del frame (es lo que haria la GUI)
+        JsonValue doc;
+        const std::uint64_t t0 = now_ns();
+        const bool ok = json_parse(frame.json, doc);
+        const std::uint64_t parse = now_ns() - t0;
+
+        ++rep.frames;
+        rep.wire_bytes += frame.wire_bytes;
+        rep.raw_bytes  += frame.json.size() + 1;
+        rep.parse_ns   += parse;
+        rep.parse_us.push_back(parse / 1000.0);
+        if (frame.compressed) rep.decode_us.push_back(frame.decode_ns / 1000.0);
+        if (!ok || !doc.isObject()) {
+            ++rep.invalid;
+            continue;
+        }
+
+        const std::string type = doc.str("type", "?");
+        TypeStats& ts = rep.by_type[type];
+        ++ts.frames;
+        ts.wire_bytes += frame.wire_bytes;
+        ts.raw_bytes  += frame.json.size() + 1;
+        if (frame.compressed) ++ts.compressed;
+
+        // Huecos en la numeracion (solo dentro de la misma sesion)
+        if (doc.get("seq")) {
+            const std::string sess = doc.str("session");
+            const std::uint64_t seq = doc.u64("seq");
+            if (sess != session) {
+                session = sess;   // primera sesion o proceso reiniciado
+                last_seq = seq;
+            } else if (seq > last_seq + 1) {
+                ++rep.seq_gaps;
+                rep.seq_missing += seq - last_seq - 1;
+                last_seq = seq;
+            } else if (seq <= last_seq) {
+                ++rep.seq_dups;   // reenviado por RESUME
+            } else {
+                last_seq = seq;
+            }
+        }
+
+        // Volcado para simbolizar fuera de linea
+        if (type == "LIVE_ALLOCS" && !opt.dump_dir.empty()) {
+            const std::string path = opt.dump_dir + "/live_allocs_" + std::to_string(++dumps) + ".json";
+            std::FILE* f = std::fopen(path.c_str(), "wb");
+            if (f) {
+                std::fwrite(frame.json.data(), 1, frame.json.size(), f);
+                std::fputc('\n', f);
+                std::fclose(f);
+            } else if (!opt.quiet) {
+                std::cerr << "Warning: cannot write " << path << "\n";
+            }
+        }
+
+        // Cadencia de metricas
+        if (type == "SUMMARY") {
+            if (last_summary_ns) {
+                const double dt = (frame.recv_ns - last_summary_ns) / 1e6;
+                rep.cadence_ms.push_back(dt);
+                if (dt > opt.metrics_ms * 1.5) ++rep.cadence_gaps;
+            }
+            last_summary_ns = frame.recv_ns;
+        }
+
+        // Latencia pedido -> respuesta: el frame responde al pedido mas viejo
+        // de un comando que lo genera (un pedido sin respuesta no bloquea a
+        // los siguientes; vence por tiempo)
+        expirePending(frame.recv_ns);
+        for (auto it = pending.begin(); it != pending.end(); ++it) {
+            if (!answers(it->command, type)) continue;
+            const std::string kw = it->command.substr(0, it->command.find(' '));
+            rep.latency_ms[kw].push_back((frame.recv_ns - it->sent_ns) / 1e6);
+            pending.erase(it);
+            break;
+        }
+
+        if (!opt.quiet && type != "SUMMARY") {
+            std::cerr << "[" << (frame.recv_ns - start_ns) / 1000000ull << "ms] " << type
+                      << " (" << frame.wire_bytes << " bytes" << (frame.compressed ? ", compressed" : "")
+                      << ")\n";
+        }
+    }
+
+    rep.unanswered += pending.size();
+    rep.elapsed_s = (now_ns() - start_ns) / 1e9;
+    printReport(opt, rep);
+    return rep.invalid ? 3 : 0;
+}
@@ -0,0 +1,294 @@
+// mp_symbolize: simboliza fuera de linea un volcado LIVE_ALLOCS.
+//
+// El profiler manda PCs crudos (pc de cada bloque y frames de "stacks")
+// junto con sus mapeos ejecutables y build ids ("modules"). Esta
+// herramienta los traduce a funcion y archivo:linea leyendo los ELF del
+// disco, con los modulos en cache y varios hilos, e imprime las pilas y
+// los llamadores con mas bytes vivos.
+
+#include "JsonLite.hpp"
+#include "Symbolizer.hpp"
+#include "ViewerSocket.hpp" // now_ns
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace mp::tools;
+
+namespace {
+
+struct Options {
+    std::string input;
+    std::vector<std::string> debug_dirs{"/usr/lib/debug"};
+    unsigned jobs = 0;          // 0 = hardware_concurrency
+    std::size_t top = 10;
+    bool json = false;
+};
+
+void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options] <dump.json>\n";
+    std::cout << "\nSymbolizes the raw PCs of a LIVE_ALLOCS dump (one frame, or an NDJSON\n";
+    std::cout << "recording whose last LIVE_ALLOCS frame is used) from ELF symbol tables\n";
+    std::cout << "and DWARF line info.\n";
+    std::cout << "\nOptions:\n";
+    std::cout << "  --jobs <N>          Symbolization threads (default: hardware concurrency)\n";
+    std::cout << "  --debug-dir <DIR>   Root for separate debug files, by build id or path.\n";
+    std::cout << "                      Repeatable (default: /usr/lib/debug)\n";
+    std::cout << "  --top <N>           Stacks and callers to print (default: 10)\n";
+    std::cout << "  --json              Print symbols, stacks and callers as one JSON object\n";
+    std::cout << "  --help              Show this help message\n";
+}
+
+bool parseArgs(int argc, char* argv[], Options& o) {
+    bool defaultDirs = true;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto val = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (a == "--help") return false;
+        else if (a == "--json")      o.json = true;
+        else if (a == "--jobs")      o.jobs = static_cast<unsigned>(std::atoi(val().c_str()));
+        else if (a == "--top")       o.top = static_cast<std::size_t>(std::atoi(val().c_str()));
+        else if (a == "--debug-dir") {
+            if (defaultDirs) o.debug_dirs.clear();
+            defaultDirs = false;
+            o.debug_dirs.push_back(val());
+        } else if (!a.empty() && a[0] == '-') {
+            std::cerr << "Error: unknown option " << a << "\n";
+            return false;
+        } else {
+            o.input = a;
+        }
+    }
+    if (o.input.empty()) {
+        std::cerr << "Error: missing dump file\n";
+        return false;
+    }
+    if (o.jobs == 0) o.jobs = std::max(1u, std::thread::hardware_concurrency());
+    return true;
+}
+
+std::uint64_t parseHex(const std::string& s) { return std::strtoull(s.c_str(), nullptr, 16); }
+
+std::string hex(std::uint64_t v) {
+    char buf[24];
+    std::snprintf(buf, sizeof(buf), "0x%llx", static_cast<unsigned long long>(v));
+    return buf;
+}
+
+// Payload de LIVE_ALLOCS: el documento entero o el ultimo frame de un NDJSON
+bool loadDump(const std::string& path, JsonValue& payload, std::string& err) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) { err = "cannot open " + path; return false; }
+    std::stringstream ss;
+    ss << in.rdbuf();
+    const std::string text = ss.str();
+
+    auto pick = [&](const JsonValue& doc) {
+        if (doc.get("blocks")) { payload = doc; return true; }
+        const JsonValue* p = doc.get("payload");
+        if (doc.str("type") == "LIVE_ALLOCS" && p && p->get("blocks")) { payload = *p; return true; }
+        return false;
+    };
+
+    JsonValue doc;
+    if (json_parse(text, doc) && pick(doc)) return true;
+
+    bool found = false;
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.find("\"LIVE_ALLOCS\"") == std::string::npos) continue;
+        if (json_parse(line, doc) && pick(doc)) found = true;
+    }
+    if (!found) err = path + " has no LIVE_ALLOCS payload";
+    return found;
+}
+
+std::string describe(const SymbolInfo& s) {
+    std::string out = hex(s.pc);
+    if (!s.function.empty()) out += " " + s.function + "+" + hex(s.fn_offset);
+    if (!s.file.empty()) out += " at " + s.file + ":" + std::to_string(s.line);
+    out += " (" + (s.module.empty() ? std::string("?") : s.module) + ")";
+    return out;
+}
+
+// "12.3 MiB" con 4 cifras significativas aprox.
+std::string humanBytes(double b) {
+    static const char* units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+    int u = 0;
+    while (b >= 1024.0 && u < 4) { b /= 1024.0; ++u; }
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), u == 0 ? "%.0f %s" : "%.1f %s", b, units[u]);
+    return buf;
+}
+
+std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '\\' || c == '"') { out += '\\'; out += c; }
+        else if (c == '\n') out += "\\n";
+        else out += c;
+    }
+    return out;
+}
+
+// Bytes y bloques vivos atribuidos a una pila o a un llamador
+struct Usage {
+    std::uint64_t key = 0;      // stack id o pc
+    std::uint64_t bytes = 0;
+    std::uint64_t blocks = 0;
+};
+
+std::vector<Usage> topUsage(const std::unordered_map<std::uint64_t, Usage>& m, std::size_t n) {
+    std::vector<Usage> v;
+    for (const auto& kv : m) v.push_back(kv.second);
+    std::sort(v.begin(), v.end(), [](const Usage& a, const Usage& b) { return a.bytes > b.bytes; });
+    if (v.size() > n) v.resize(n);
+    return v;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    JsonValue payload;
+    std::string err;
+    if (!loadDump(opt.input, payload, err)) {
+        std::cerr << "Error: " << err << "\n";
+        return 1;
+    }
+
+    std::vector<ModuleMap> maps;
+    if (const JsonValue* mods = payload.get("modules")) {
+        for (const JsonValue& m : mods->items) {
+            ModuleMap mm;
+            mm.start    = parseHex(m.str("start"));
+            mm.end      = parseHex(m.str("end"));
+            mm.offset   = parseHex(m.str("offset"));
+            mm.path     = m.str("path");
+            mm.build_id = m.str("build_id");
+            maps.push_back(mm);
+        }
+    }
+    if (maps.empty()) {
+        std::cerr << "Error: the dump has no \"modules\"; it predates offline symbolization\n";
+        return 1;
+    }
+
+    // Pilas y llamadores con sus bytes vivos
+    std::unordered_map<std::uint64_t, std::vector<std::uint64_t>> stacks;
+    if (const JsonValue* st = payload.get("stacks")) {
+        for (const JsonValue& s : st->items) {
+            std::vector<std::uint64_t>& frames = stacks[s.u64("id")];
+            if (const JsonValue* f = s.get("frames")) {
+                for (const JsonValue& pc : f->items) frames.push_back(parseHex(pc.text));
+            }
+        }
+    }
+    std::unordered_map<std::uint64_t, Usage> byStack, byCaller;
+    if (const JsonValue* blocks = payload.get("blocks")) {
+        for (const JsonValue& b : blocks->items) {
+            const std::uint64_t size = b.u64("size");
+            const std::uint64_t sid = b.u64("stack_id");
+            const std::uint64_t pc = parseHex(b.str("pc", "0"));
+            Usage* u = nullptr;
+            if (sid && stacks.count(sid)) { u = &byStack[sid]; u->key = sid; }
+            else if (pc) { u = &byCaller[pc]; u->key = pc; }
+            if (!u) continue;
+            u->bytes += size;
+            ++u->blocks;
+        }
+    }
+
+    // PCs distintos, simbolizados una sola vez
+    std::vector<std::uint64_t> pcs;
+    for (const auto& kv : stacks) pcs.insert(pcs.end(), kv.second.begin(), kv.second.end());
+    for (const auto& kv : byCaller) pcs.push_back(kv.first);
+    std::sort(pcs.begin(), pcs.end());
+    pcs.erase(std::unique(pcs.begin(), pcs.end()), pcs.end());
+
+    Symbolizer sym(opt.debug_dirs);
+    const std::uint64_t t0 = now_ns();
+    const std::vector<SymbolInfo> resolved = sym.resolve(pcs, maps, opt.jobs);
+    const double ms = (now_ns() - t0) / 1e6;
+    std::unordered_map<std::uint64_t, const SymbolInfo*> byPc;
+    for (const SymbolInfo& s : resolved) byPc[s.pc] = &s;
+
+    for (const std::string& w : sym.warnings()) std::cerr << "Warning: " << w << "\n";
+
+    const std::vector<Usage> topStacks = topUsage(byStack, opt.top);
+    const std::vector<Usage> topCallers = topUsage(byCaller, opt.top);
+
+    if (opt.json) {
+        std::string j = "{\"pcs\":" + std::to_string(pcs.size()) +
+                        ",\"modules\":" + std::to_string(sym.modulesLoaded()) +
+                        ",\"jobs\":" + std::to_string(opt.jobs) +
+                        ",\"ms\":" + std::to_string(ms) + ",\"symbols\":[";
+        for (std::size_t i = 0; i < resolved.size(); ++i) {
+            const SymbolInfo& s = resolved[i];
+            if (i) j += ",";
+            j += "{\"pc\":\"" + hex(s.pc) + "\",\"module\":\"" + jsonEscape(s.module) +
+                 "\",\"function\":\"" + jsonEscape(s.function) + "\",\"offset\":" + std::to_string(s.fn_offset) +
+                 ",\"file\":\"" + jsonEscape(s.file) + "\",\"line\":" + std::to_string(s.line) + "}";
+        }
+        j += "],\"stacks\":[";
+        for (std::size_t i = 0; i < topStacks.size(); ++i) {
+            if (i) j += ",";
+            j += "{\"id\":" + std::to_string(topStacks[i].key) + ",\"live_bytes\":" + std::to_string(topStacks[i].bytes) +
+                 ",\"live_count\":" + std::to_string(topStacks[i].blocks) + ",\"frames\":[";
+            const auto& frames = stacks[topStacks[i].key];
+            for (std::size_t f = 0; f < frames.size(); ++f) {
+                if (f) j += ",";
+                j += "\"" + jsonEscape(describe(*byPc[frames[f]])) + "\"";
+            }
+            j += "]}";
+        }
+        j += "],\"callers\":[";
+        for (std::size_t i = 0; i < topCallers.size(); ++i) {
+            if (i) j += ",";
+            j += "{\"caller\":\"" + jsonEscape(describe(*byPc[topCallers[i].key])) +
+                 "\",\"live_bytes\":" + std::to_string(topCallers[i].bytes) +
+                 ",\"live_count\":" + std::to_string(topCallers[i].blocks) + "}";
+        }
+        j += "]}";
+        std::cout << j << std::endl;
+        return 0;
+    }
+
+    std::printf("Symbolized %zu PCs from %zu modules in %.1f ms (%u jobs)\n",
+                pcs.size(), sym.modulesLoaded(), ms, opt.jobs);
+    if (!topStacks.empty()) {
+        std::printf("\nTop stacks by live bytes:\n");
+        for (const Usage& u : topStacks) {
+            std::printf("stack %llu: %s in %llu blocks\n", static_cast<unsigned long long>(u.key),
+                        humanBytes(static_cast<double>(u.bytes)).c_str(), static_cast<unsigned long long>(u.blocks));
+            const auto& frames = stacks[u.key];
+            for (std::size_t f = 0; f < frames.size(); ++f) {
+                std::printf("    #%-2zu %s\n", f, describe(*byPc[frames[f]]).c_str());
+            }
+        }
+    }
+    if (!topCallers.empty()) {
+        std::printf("\nTop callers by live bytes (blocks without a stack):\n");
+        for (const Usage& u : topCallers) {
+            std::printf("  %10s %8llu blocks  %s\n", humanBytes(static_cast<double>(u.bytes)).c_str(),
+                        static_cast<unsigned long long>(u.blocks), describe(*byPc[u.key]).c_str());
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,315 @@
+// mp_top: visor de terminal estilo top para el protocolo del profiler.
+//
+// Escucha en el puerto al que se conecta mp::SocketClient (igual que la GUI),
+// pide "STATS <top>" en cada refresco y dibuja bytes en uso, pico, tasa de
+// asignacion, top de callsites, uso por hilo e histograma de tamaños.
+// Nunca pide SNAPSHOT: STATS no copia los bloques vivos, asi que puede
+// quedar conectado a un proceso en produccion.
+
+#include "JsonLite.hpp"
+#include "ViewerSocket.hpp"
+
+#include <algorithm>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace mp::tools;
+
+namespace {
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void onSignal(int) { g_stop = 1; }
+
+struct Options {
+    std::string   host = "127.0.0.1";
+    std::uint16_t port = 7777;
+    std::uint32_t interval_ms = 1000;
+    std::uint32_t top = 10;
+    std::uint32_t iterations = 0;   // 0 = hasta Ctrl-C
+    bool          color = true;
+};
+
+void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]\n";
+    std::cout << "\nOptions:\n";
+    std::cout << "  --host <IP>          Address to listen on (default: 127.0.0.1)\n";
+    std::cout << "  --port <P>           Port SocketClient dials (default: 7777)\n";
+    std::cout << "  --interval-ms <M>    Refresh interval (default: 1000)\n";
+    std::cout << "  --top <N>            Callsites to show (default: 10)\n";
+    std::cout << "  --iterations <N>     Exit after N refreshes (default: 0, run until Ctrl-C)\n";
+    std::cout << "  --no-color           Plain output without ANSI escapes\n";
+    std::cout << "  --help               Show this help message\n";
+}
+
+bool parseArgs(int argc, char* argv[], Options& o) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&](std::string& v) {
+            if (i + 1 >= argc) return false;
+            v = argv[++i];
+            return true;
+        };
+        std::string v;
+        if (a == "--help")                        { return false; }
+        else if (a == "--no-color")               { o.color = false; }
+        else if (a == "--host" && next(v))        { o.host = v; }
+        else if (a == "--port" && next(v))        { o.port = static_cast<std::uint16_t>(std::atoi(v.c_str())); }
+        else if (a == "--interval-ms" && next(v)) { o.interval_ms = static_cast<std::uint32_t>(std::atoi(v.c_str())); }
+        else if (a == "--top" && next(v))         { o.top = static_cast<std::uint32_t>(std::atoi(v.c_str())); }
+        else if (a == "--iterations" && next(v))  { o.iterations = static_cast<std::uint32_t>(std::atoi(v.c_str())); }
+        else {
+            std::cerr << "Error: unknown or incomplete option " << a << "\n";
+            return false;
+        }
+    }
+    if (o.interval_ms == 0) {
+        std::cerr << "Error: interval-ms must be > 0\n";
+        return false;
+    }
+    return true;
+}
+
+// "12.3 MiB" con 4 cifras significativas aprox.
+std::string humanBytes(double b) {
+    static const char* units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+    int u = 0;
+    while (b >= 1024.0 && u < 4) { b /= 1024.0; ++u; }
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), u == 0 ? "%.0f %s" : "%.1f %s", b, units[u]);
+    return buf;
+}
+
+std::string bar(double fraction, int width) {
+    if (fraction < 0.0) fraction = 0.0;
+    if (fraction > 1.0) fraction = 1.0;
+    const int n = static_cast<int>(fraction * width + 0.5);
+    return std::string(static_cast<size_t>(n), '#') + std::string(static_cast<size_t>(width - n), ' ');
+}
+
+// Recorta por la izquierda (lo util de una ruta es el final)
+std::string tail(const std::string& s, size_t width) {
+    if (s.size() <= width) return s;
+    return "..." + s.substr(s.size() - (width - 3));
+}
+
+/**
+ * Estado de la pantalla: ultimo STATS y el anterior para calcular tasas
+ */
+struct View {
+    JsonValue     stats;
+    bool          have_stats = false;
+    std::uint64_t prev_t_ns = 0, prev_allocs = 0, prev_frees = 0, prev_bytes = 0;
+    double        allocs_per_s = 0.0, frees_per_s = 0.0, bytes_per_s = 0.0;
+    std::string   session;
+    std::uint64_t seq = 0;
+    std::uint64_t wire_bytes = 0;
+    bool          connected = false;
+
+    void update(JsonValue&& payload) {
+        const std::uint64_t t = payload.u64("t_ns");
+        const std::uint64_t a = payload.u64("total_allocs");
+        const std::uint64_t f = payload.u64("total_frees");
+        const std::uint64_t b = payload.u64("total_bytes");
+        if (have_stats && t > prev_t_ns && a >= prev_allocs) {
+            const double dt = double(t - prev_t_ns) / 1e9;
+            allocs_per_s = double(a - prev_allocs) / dt;
+            frees_per_s  = f >= prev_frees ? double(f - prev_frees) / dt : 0.0;
+            bytes_per_s  = b >= prev_bytes ? double(b - prev_bytes) / dt : 0.0;
+        }
+        prev_t_ns = t; prev_allocs = a; prev_frees = f; prev_bytes = b;
+        stats = std::move(payload);
+        have_stats = true;
+    }
+};
+
+void render(const View& v, const Options& o) {
+    const char* bold  = o.color ? "\x1b[1m"  : "";
+    const char* dim   = o.color ? "\x1b[2m"  : "";
+    const char* inv   = o.color ? "\x1b[7m"  : "";
+    const char* green = o.color ? "\x1b[32m" : "";
+    const char* red   = o.color ? "\x1b[31m" : "";
+    const char* reset = o.color ? "\x1b[0m"  : "";
+
+    std::string out;
+    out.reserve(8192);
+    if (o.color) out += "\x1b[H\x1b[2J"; // cursor arriba + limpiar
+    char line[512];
+
+    std::snprintf(line, sizeof(line), "%smp_top%s  %s:%u  every %ums  %s%s%s",
+                  bold, reset, o.host.c_str(), unsigned(o.port), unsigned(o.interval_ms),
+                  v.connected ? green : red, v.connected ? "connected" : "waiting for profiler", reset);
+    out += line;
+    if (!v.session.empty()) {
+        std::snprintf(line, sizeof(line), "  %ssession %s seq %llu  rx %s%s",
+                      dim, v.session.c_str(), (unsigned long long)v.seq,
+                      humanBytes(double(v.wire_bytes)).c_str(), reset);
+        out += line;
+    }
+    out += "\n\n";
+
+    if (!v.have_stats) {
+        out += "  (no STATS received yet)\n";
+        std::fwrite(out.data(), 1, out.size(), stdout);
+        std::fflush(stdout);
+        return;
+    }
+    const JsonValue& s = v.stats;
+    const double inUse = s.num("bytes_in_use");
+    const double peak  = s.num("peak");
+
+    std::snprintf(line, sizeof(line),
+                  "  In use %s%-11s%s Peak %-11s Live blocks %-10llu Callsites %llu\n",
+                  bold, humanBytes(inUse).c_str(), reset, humanBytes(peak).c_str(),
+                  (unsigned long long)s.u64("live_count"), (unsigned long long)s.u64("callsite_count"));
+    out += line;
+    // Frees resueltos en el buffer de recientes del tracker
+    char shortLived[32] = "";
+    if (const JsonValue* sl = s.get("short_lived")) {
+        std::snprintf(shortLived, sizeof(shortLived), "Short-lived %5.1f%%   ", sl->num("hit_ratio") * 100.0);
+    }
+    std::snprintf(line, sizeof(line),
+                  "  Allocs/s %-10.0f Frees/s %-10.0f Alloc rate %s/s   %s[%s]\n\n",
+                  v.allocs_per_s, v.frees_per_s, humanBytes(v.bytes_per_s).c_str(), shortLived,
+                  bar(peak > 0 ? inUse / peak : 0.0, 20).c_str());
+    out += line;
+
+    // Top de callsites
+    std::snprintf(line, sizeof(line), "%s  %12s %10s %12s  %-48s%s\n",
+                  inv, "LIVE BYTES", "BLOCKS", "ALLOCS", "CALLSITE", reset);
+    out += line;
+    if (const JsonValue* cs = s.get("top_callsites")) {
+        for (const auto& c : cs->items) {
+            std::snprintf(line, sizeof(line), "  %12s %10llu %12llu  %s\n",
+                          humanBytes(c.num("live_bytes")).c_str(),
+                          (unsigned long long)c.u64("live_count"),
+                          (unsigned long long)c.u64("total_allocs"),
+                          tail(c.str("callsite"), 48).c_str());
+            out += line;
+        }
+    }
+    out += "\n";
+
+    // Uso por hilo
+    std::snprintf(line, sizeof(line), "%s  %4s %-16s %12s %10s %12s  %-20s%s\n",
+                  inv, "ID", "THREAD", "LIVE BYTES", "BLOCKS", "ALLOCS", "SHARE", reset);
+    out += line;
+    if (const JsonValue* th = s.get("threads")) {
+        size_t shown = 0;
+        for (const auto& t : th->items) {
+            if (++shown > 16) break;
+            std::snprintf(line, sizeof(line), "  %4llu %-16s %12s %10llu %12llu  %s\n",
+                          (unsigned long long)t.u64("thread_id"),
+                          tail(t.str("name", "?"), 16).c_str(),
+                          humanBytes(t.num("live_bytes")).c_str(),
+                          (unsigned long long)t.u64("live_count"),
+                          (unsigned long long)t.u64("total_allocs"),
+                          bar(inUse > 0 ? t.num("live_bytes") / inUse : 0.0, 20).c_str());
+            out += line;
+        }
+        if (th->items.size() > 16) {
+            std::snprintf(line, sizeof(line), "  %s... %zu more threads%s\n", dim, th->items.size() - 16, reset);
+            out += line;
+        }
+    }
+    out += "\n";
+
+    // Histograma de tamaños (bloques vivos)
+    std::snprintf(line, sizeof(line), "%s  %12s %10s %12s  %-20s%s\n",
+                  inv, "SIZE >=", "BLOCKS", "BYTES", "BLOCKS", reset);
+    out += line;
+    if (const JsonValue* h = s.get("size_histogram")) {
+        double maxCount = 0.0;
+        for (const auto& b : h->items) maxCount = std::max(maxCount, b.num("count"));
+        for (const auto& b : h->items) {
+            std::snprintf(line, sizeof(line), "  %12s %10llu %12s  %s\n",
+                          humanBytes(b.num("min")).c_str(),
+                          (unsigned long long)b.u64("count"),
+                          humanBytes(b.num("bytes")).c_str(),
+                          bar(maxCount > 0 ? b.num("count") / maxCount : 0.0, 20).c_str());
+            out += line;
+        }
+    }
+    if (!o.color) out += "\n";
+
+    std::fwrite(out.data(), 1, out.size(), stdout);
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (!::isatty(STDOUT_FILENO)) opt.color = false;
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    ViewerSocket sock;
+    if (!sock.listen(opt.host, opt.port)) {
+        std::cerr << "Error: cannot listen on " << opt.host << ":" << opt.port << "\n";
+        return 2;
+    }
+    if (opt.color) std::fputs("\x1b[?25l", stdout); // ocultar cursor
+
+    View view;
+    const std::string statsCmd = "STATS " + std::to_string(opt.top);
+    const std::uint64_t period = std::uint64_t(opt.interval_ms) * 1000000ull;
+    std::uint32_t refreshes = 0;
+    std::uint64_t next_ns = now_ns();
+
+    while (!g_stop && (opt.iterations == 0 || refreshes < opt.iterations)) {
+        if (!sock.connected()) {
+            view.connected = false;
+            render(view, opt);
+            if (!sock.accept(static_cast<int>(opt.interval_ms))) {
+                ++refreshes;
+                continue;
+            }
+            view.connected = true;
+            next_ns = now_ns();
+        }
+
+        const std::uint64_t now = now_ns();
+        if (now >= next_ns) {
+            next_ns = now + period;
+            if (!sock.sendLine(statsCmd)) continue;
+        }
+
+        ReceivedFrame frame;
+        const int wait = static_cast<int>((next_ns - std::min(next_ns, now_ns())) / 1000000ull);
+        const int rc = sock.readFrame(frame, wait);
+        if (rc < 0) continue;      // se desconecto: volver a esperar
+        if (rc == 0) continue;     // toca pedir el siguiente STATS
+
+        JsonValue msg;
+        if (!json_parse(frame.json, msg)) continue;
+        const std::string type = msg.str("type");
+        if (msg.get("seq")) view.seq = msg.u64("seq");
+        view.wire_bytes = sock.totalWireBytes();
+
+        if (type == "HELLO") {
+            if (const JsonValue* p = msg.get("payload")) view.session = p->str("session");
+        } else if (type == "STATS") {
+            if (const JsonValue* p = msg.get("payload")) {
+                view.update(JsonValue(*p));
+                render(view, opt);
+                ++refreshes;
+            }
+        }
+    }
+
+    if (opt.color) std::fputs("\x1b[?25h\n", stdout); // restaurar cursor
+    return 0;
+}